@@ -0,0 +1,257 @@
+#include "BackendRouter.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "Backends.h"
+#include "CircuitBreaker.h"
+#include "StyleCatalog.h"
+
+namespace {
+    double quantile(std::vector<double> values, double q) {
+        if (values.empty()) return 0;
+        std::sort(values.begin(), values.end());
+        size_t index = static_cast<size_t>(q * (values.size() - 1) + 0.5);
+        return values[std::min(index, values.size() - 1)];
+    }
+}
+
+BackendRouter::BackendRouter(NowFunction nowFunction) :
+    now(std::move(nowFunction)) {
+    for (size_t c = 0; c < CATEGORY_COUNT; c++) {
+        categories[c].category = static_cast<APIModel>(c);
+        categories[c].lastChoice = Backends::forCategory(categories[c].category);
+    }
+}
+
+void BackendRouter::setOptions(const Options& routerOptions) {
+    std::lock_guard<std::mutex> lock(mutex);
+    options = routerOptions;
+}
+
+BackendRouter::Options BackendRouter::getOptions() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return options;
+}
+
+void BackendRouter::pin(APIModel category, BackendId backend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index = static_cast<size_t>(category);
+    if (index < CATEGORY_COUNT) {
+        categories[index].pinned = true;
+        pins[index] = backend;
+    }
+}
+
+void BackendRouter::unpin(APIModel category) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index = static_cast<size_t>(category);
+    if (index < CATEGORY_COUNT) {
+        categories[index].pinned = false;
+    }
+}
+
+void BackendRouter::applyPins(const std::string& spec) {
+    std::stringstream ss(spec);
+    std::string pair;
+    while (std::getline(ss, pair, ',')) {
+        size_t eq = pair.find('=');
+        APIModel category;
+        BackendId backend;
+        if (eq == std::string::npos || !StyleCatalog::categoryFromKey(pair.substr(0, eq), category) ||
+            !Backends::fromName(pair.substr(eq + 1), backend)) {
+            std::cout << "Ignoring route pin entry: " << pair << std::endl;
+            continue;
+        }
+        pin(category, backend);
+        std::cout << "Routing " << StyleCatalog::categoryKey(category) << " to " << Backends::get(backend).name << " (pinned)" << std::endl;
+    }
+}
+
+BackendId BackendRouter::choose(APIModel category, const CircuitBreaker& breaker) {
+    const CategoryRoute& route = Backends::routeFor(category);
+    std::lock_guard<std::mutex> lock(mutex);
+    CategoryStats& stats = categories[std::min(static_cast<size_t>(category), CATEGORY_COUNT - 1)];
+    Clock::time_point current = now();
+
+    BackendId choice = route.choices[0];
+    if (stats.pinned) {
+        choice = pins[static_cast<size_t>(stats.category)];
+    }
+    else if (route.count > 1) {
+        // The default holds unless a candidate beats it by the margin; an open
+        // default counts as never making it
+        double bestProbability = -1;
+        double defaultProbability = -1;
+        for (size_t i = 0; i < route.count; i++) {
+            BackendId candidate = route.choices[i];
+            if (breaker.getState(candidate) == CircuitBreaker::State::OPEN) {
+                continue;
+            }
+
+            Window& window = windows[static_cast<size_t>(candidate)];
+            expire(window, current);
+            double probability = statsFor(candidate, window, current).meetProbability;
+            if (i == 0) {
+                defaultProbability = probability;
+                bestProbability = probability;
+            }
+            else if (probability > defaultProbability + options.switchMargin && probability > bestProbability) {
+                choice = candidate;
+                bestProbability = probability;
+            }
+        }
+
+        if (choice != route.choices[0]) {
+            stats.diverted++;
+        }
+    }
+
+    stats.decisions++;
+    stats.routed[std::min(static_cast<size_t>(choice), BACKEND_COUNT - 1)]++;
+    if (choice != stats.lastChoice) {
+        std::cout << "Routing " << StyleCatalog::categoryKey(category) << " to " << Backends::get(choice).name
+            << " (was " << Backends::get(stats.lastChoice).name << ")" << std::endl;
+        stats.lastChoice = choice;
+    }
+    return choice;
+}
+
+void BackendRouter::recordSuccess(BackendId backend, double latencyMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    record(backend, latencyMs, true);
+}
+
+void BackendRouter::recordFailure(BackendId backend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    record(backend, 0, false);
+}
+
+void BackendRouter::record(BackendId backend, double latencyMs, bool success) {
+    Window& window = windows[std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1)];
+    Clock::time_point current = now();
+    window.samples.push_back(Sample{ current, latencyMs, success });
+    if (success) window.successes++;
+    else window.failures++;
+
+    expire(window, current);
+    while (window.samples.size() > MAX_SAMPLES) {
+        window.samples.pop_front();
+    }
+}
+
+void BackendRouter::expire(Window& window, Clock::time_point current) {
+    Clock::time_point cutoff = current - std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(options.windowMs));
+    while (!window.samples.empty() && window.samples.front().at < cutoff) {
+        window.samples.pop_front();
+    }
+}
+
+BackendRouter::BackendStats BackendRouter::statsFor(BackendId backend, const Window& window, Clock::time_point current) const {
+    Clock::time_point cutoff = current - std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(options.windowMs));
+
+    BackendStats stats;
+    stats.backend = backend;
+    stats.successes = window.successes;
+    stats.failures = window.failures;
+
+    std::vector<double> latencies;
+    size_t failed = 0;
+    size_t onTime = 0;
+    for (const Sample& sample : window.samples) {
+        if (sample.at < cutoff) {
+            continue;
+        }
+        stats.samples++;
+        if (!sample.success) {
+            failed++;
+            continue;
+        }
+
+        latencies.push_back(sample.latencyMs);
+        if (sample.latencyMs <= options.targetMs) {
+            onTime++;
+        }
+        size_t bucket = std::lower_bound(BUCKET_BOUNDS.begin(), BUCKET_BOUNDS.end(), sample.latencyMs) - BUCKET_BOUNDS.begin();
+        stats.histogram[bucket]++;
+    }
+
+    stats.errorRate = stats.samples > 0 ? static_cast<double>(failed) / stats.samples : 0;
+    stats.p50Ms = quantile(latencies, 0.5);
+    stats.p90Ms = quantile(latencies, 0.9);
+
+    // Failures count as misses. Until there are enough samples, the backend's
+    // typical time stands in for the missing ones, so one early result can't
+    // swing routing on its own.
+    double onTimeCount = static_cast<double>(onTime);
+    double total = static_cast<double>(stats.samples);
+    if (stats.samples < options.minSamples) {
+        double prior = Backends::get(backend).typicalMs <= options.targetMs ? 0.9 : 0.1;
+        double missing = static_cast<double>(options.minSamples - stats.samples);
+        onTimeCount += prior * missing;
+        total += missing;
+    }
+    stats.meetProbability = total > 0 ? onTimeCount / total : 0;
+    return stats;
+}
+
+std::vector<BackendRouter::BackendStats> BackendRouter::getBackendStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point current = now();
+
+    std::vector<BackendStats> result;
+    for (size_t b = 0; b < BACKEND_COUNT; b++) {
+        BackendId backend = static_cast<BackendId>(b);
+        if (Backends::get(backend).isRemote()) {
+            result.push_back(statsFor(backend, windows[b], current));
+        }
+    }
+    return result;
+}
+
+std::vector<BackendRouter::CategoryStats> BackendRouter::getCategoryStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<CategoryStats>(categories.begin(), categories.end());
+}
+
+void BackendRouter::printStats() const {
+    Options current = getOptions();
+    std::vector<BackendStats> backends = getBackendStats();
+    std::vector<CategoryStats> routes = getCategoryStats();
+
+    bool any = false;
+    for (const CategoryStats& route : routes) {
+        any = any || route.decisions > 0;
+    }
+    if (!any) {
+        return;
+    }
+
+    std::cout << "Routing (target " << static_cast<int>(current.targetMs) << " ms):" << std::endl;
+    for (const BackendStats& stats : backends) {
+        if (stats.successes + stats.failures == 0) {
+            continue;
+        }
+        std::cout << "  " << Backends::get(stats.backend).name << ": " << stats.samples << " recent, p50 "
+            << static_cast<int>(stats.p50Ms) << " ms, p90 " << static_cast<int>(stats.p90Ms) << " ms, "
+            << static_cast<int>(stats.errorRate * 100 + 0.5) << "% errors, "
+            << static_cast<int>(stats.meetProbability * 100 + 0.5) << "% on target" << std::endl;
+    }
+    for (const CategoryStats& route : routes) {
+        if (route.decisions == 0) {
+            continue;
+        }
+        std::cout << "  " << StyleCatalog::categoryKey(route.category) << ":";
+        for (size_t b = 0; b < BACKEND_COUNT; b++) {
+            if (route.routed[b] > 0) {
+                std::cout << " " << Backends::get(static_cast<BackendId>(b)).name << " " << route.routed[b];
+            }
+        }
+        std::cout << (route.pinned ? " (pinned)" : "");
+        if (route.diverted > 0) {
+            std::cout << ", " << route.diverted << " away from the default";
+        }
+        std::cout << std::endl;
+    }
+}
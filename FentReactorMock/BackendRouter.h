@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "GenerationTypes.h"
+
+class CircuitBreaker;
+
+// Picks the backend for a UI category from how its candidates (Backends::routeFor)
+// have actually been performing. Each backend keeps a rolling window of recent
+// outcomes - latency from submission to downloaded image, or failure - and the
+// router sends a category to the candidate most likely to finish within the
+// latency target. The category's default keeps the traffic unless another
+// candidate is clearly better, so noise doesn't flip routing back and forth;
+// samples age out of the window, so a backend that was abandoned during a bad
+// spell gets traffic again once the spell has passed. A pin overrides all of it.
+//
+// Thread-safe. Time comes from an injectable clock, like CircuitBreaker.
+class BackendRouter {
+public:
+    using Clock = std::chrono::steady_clock;
+    using NowFunction = std::function<Clock::time_point()>;
+
+    struct Options {
+        double targetMs = 20000.0;      // Submission to downloaded image
+        double windowMs = 300000.0;     // Samples older than this are dropped
+        size_t minSamples = 5;          // Below this, the backend's typical time fills in the estimate
+        double switchMargin = 0.1;      // How much likelier to meet the target another backend must be
+                                        // before a category leaves its default
+    };
+
+    // Upper bounds (ms) of the latency histogram buckets; the last bucket is everything slower
+    static constexpr std::array<double, 7> BUCKET_BOUNDS = { 1000, 2000, 5000, 10000, 20000, 30000, 60000 };
+    static constexpr size_t BUCKET_COUNT = BUCKET_BOUNDS.size() + 1;
+
+    struct BackendStats {
+        BackendId backend = BackendId::FLUX_SCHNELL;
+        size_t samples = 0;             // In the window
+        double errorRate = 0;           // Share of the window that failed
+        double p50Ms = 0;               // Of the successes in the window
+        double p90Ms = 0;
+        double meetProbability = 0;     // Estimated chance a new job makes the target
+        std::array<uint64_t, BUCKET_COUNT> histogram{};     // Successes in the window by latency
+        uint64_t successes = 0;         // Lifetime
+        uint64_t failures = 0;
+    };
+
+    struct CategoryStats {
+        APIModel category = APIModel::REALISM;
+        bool pinned = false;
+        BackendId lastChoice = BackendId::FLUX_SCHNELL;
+        uint64_t decisions = 0;
+        uint64_t diverted = 0;          // Sent somewhere other than the category's default (pins excluded)
+        std::array<uint64_t, static_cast<size_t>(BackendId::COUNT)> routed{};   // Decisions by backend
+    };
+
+    explicit BackendRouter(NowFunction now = Clock::now);
+
+    void setOptions(const Options& options);
+    Options getOptions() const;
+
+    // Always route category to backend, whatever the measurements say
+    void pin(APIModel category, BackendId backend);
+    void unpin(APIModel category);
+
+    // "gaming_tech=flux-schnell,landscapes=flux-lora" (category keys as in manifests)
+    void applyPins(const std::string& spec);
+
+    // Backend for a new job in category. Candidates whose circuit is open are
+    // skipped (without using up a half-open trial); if none is left, the default.
+    BackendId choose(APIModel category, const CircuitBreaker& breaker);
+
+    void recordSuccess(BackendId backend, double latencyMs);
+    void recordFailure(BackendId backend);
+
+    std::vector<BackendStats> getBackendStats() const;     // Remote backends
+    std::vector<CategoryStats> getCategoryStats() const;   // Every category
+    void printStats() const;
+
+private:
+    struct Sample {
+        Clock::time_point at;
+        double latencyMs = 0;
+        bool success = false;
+    };
+
+    struct Window {
+        std::deque<Sample> samples;
+        uint64_t successes = 0;
+        uint64_t failures = 0;
+    };
+
+    static constexpr size_t BACKEND_COUNT = static_cast<size_t>(BackendId::COUNT);
+    static constexpr size_t CATEGORY_COUNT = static_cast<size_t>(APIModel::LANDSCAPES) + 1;
+    static constexpr size_t MAX_SAMPLES = 256;     // Per backend, however short the window
+
+    NowFunction now;
+    Options options;
+    mutable std::mutex mutex;
+    std::array<Window, BACKEND_COUNT> windows;
+    std::array<CategoryStats, CATEGORY_COUNT> categories;
+    std::array<BackendId, CATEGORY_COUNT> pins{};     // Where categories[i].pinned sends it
+
+    // Caller holds the mutex
+    void record(BackendId backend, double latencyMs, bool success);
+    void expire(Window& window, Clock::time_point current);
+    BackendStats statsFor(BackendId backend, const Window& window, Clock::time_point current) const;
+};
@@ -0,0 +1,215 @@
+#include "Backends.h"
+#include <cstdint>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+    // fal queue request for a backend type B: the fields every model shares, plus
+    // whatever B's constexpr parameters switch on. Each backend gets its own
+    // instantiation, so there is no per-request branching on the model.
+    template <typename B>
+    std::string falPayload(const std::string& prompt, int width, int height, int numImages) {
+        json payload = {
+            {"prompt", prompt},
+            {"image_size", {{"width", width}, {"height", height}}},
+            {"num_inference_steps", B::steps},
+            {"guidance_scale", B::guidance},
+            {"num_images", numImages},
+            {B::formatKey, "jpeg"}
+        };
+        if constexpr (B::safetyChecker) {
+            payload["enable_safety_checker"] = true;
+        }
+        return payload.dump();
+    }
+
+    // Backend types. Adding a backend = a BackendId value, one type here and
+    // one line in the registry below.
+
+    struct FluxSchnell {
+        static constexpr BackendId id = BackendId::FLUX_SCHNELL;
+        static constexpr const char* name = "flux-1/schnell";
+        static constexpr const char* submitPath = "fal-ai/flux-1/schnell";
+        static constexpr const char* requestsPath = "fal-ai/flux-1";
+        static constexpr double typicalMs = 1500.0;     // 4 steps
+        static constexpr int steps = 4;
+        static constexpr double guidance = 3.5;
+        static constexpr bool safetyChecker = true;
+        static constexpr const char* formatKey = "output_format";
+        static constexpr auto buildPayload = &falPayload<FluxSchnell>;
+        static constexpr auto generateLocal = nullptr;
+    };
+
+    struct PlaygroundV25 {
+        static constexpr BackendId id = BackendId::PLAYGROUND_V25;
+        static constexpr const char* name = "playground-v25";
+        static constexpr const char* submitPath = "fal-ai/playground-v25";
+        static constexpr const char* requestsPath = "fal-ai/playground-v25";
+        static constexpr double typicalMs = 12000.0;    // 50 steps
+        static constexpr int steps = 50;
+        static constexpr int guidance = 7;              // Sent as an integer, as the API examples do
+        static constexpr bool safetyChecker = false;
+        static constexpr const char* formatKey = "format";
+        static constexpr auto buildPayload = &falPayload<PlaygroundV25>;
+        static constexpr auto generateLocal = nullptr;
+    };
+
+    struct FluxLora {
+        static constexpr BackendId id = BackendId::FLUX_LORA;
+        static constexpr const char* name = "flux-lora";
+        static constexpr const char* submitPath = "fal-ai/flux-lora";
+        static constexpr const char* requestsPath = "fal-ai/flux-lora";
+        static constexpr double typicalMs = 8000.0;     // 28 steps
+        static constexpr int steps = 28;
+        static constexpr double guidance = 3.5;
+        static constexpr bool safetyChecker = true;
+        static constexpr const char* formatKey = "output_format";
+        static constexpr auto buildPayload = &falPayload<FluxLora>;
+        static constexpr auto generateLocal = nullptr;
+    };
+
+    // Deterministic gradient/stripe pattern derived from the prompt, encoded as
+    // a 24-bit BMP (decodable by sf::Texture/sf::Image, no encoder needed)
+    bool generateProceduralImage(const std::string& prompt, int width, int height, ByteBuffer& image) {
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+
+        uint32_t seed = 2166136261u;
+        for (unsigned char c : prompt) {
+            seed = (seed ^ c) * 16777619u;
+        }
+        const uint8_t baseR = seed & 0xFF;
+        const uint8_t baseG = (seed >> 8) & 0xFF;
+        const uint8_t baseB = (seed >> 16) & 0xFF;
+        const int stripe = 16 + static_cast<int>((seed >> 24) % 48);
+
+        const size_t rowBytes = (static_cast<size_t>(width) * 3 + 3) & ~static_cast<size_t>(3);
+        const size_t pixelBytes = rowBytes * height;
+        const size_t fileBytes = 54 + pixelBytes;
+
+        image.assign(fileBytes, 0);
+        auto put16 = [&image](size_t at, uint16_t v) { image[at] = v & 0xFF; image[at + 1] = v >> 8; };
+        auto put32 = [&image](size_t at, uint32_t v) {
+            for (int i = 0; i < 4; i++) image[at + i] = (v >> (8 * i)) & 0xFF;
+        };
+
+        image[0] = 'B'; image[1] = 'M';
+        put32(2, static_cast<uint32_t>(fileBytes));
+        put32(10, 54);                  // Pixel data offset
+        put32(14, 40);                  // BITMAPINFOHEADER
+        put32(18, static_cast<uint32_t>(width));
+        put32(22, static_cast<uint32_t>(height));  // Positive = bottom-up rows
+        put16(26, 1);                   // Planes
+        put16(28, 24);                  // Bits per pixel
+        put32(34, static_cast<uint32_t>(pixelBytes));
+
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = &image[54 + rowBytes * y];
+            for (int x = 0; x < width; x++) {
+                bool band = ((x + y) / stripe) % 2 == 0;
+                uint8_t* pixel = row + x * 3;   // BGR
+                pixel[0] = static_cast<uint8_t>(baseB + (band ? 64 : 0) + y * 128 / height);
+                pixel[1] = static_cast<uint8_t>(baseG + x * 128 / width);
+                pixel[2] = static_cast<uint8_t>(baseR + (band ? 0 : 64));
+            }
+        }
+        return true;
+    }
+
+    struct Offline {
+        static constexpr BackendId id = BackendId::OFFLINE;
+        static constexpr const char* name = "offline";
+        static constexpr const char* submitPath = "";
+        static constexpr const char* requestsPath = "";
+        static constexpr double typicalMs = 0.0;
+        static constexpr int steps = 0;
+        static constexpr double guidance = 0.0;
+        static constexpr bool safetyChecker = false;
+        static constexpr const char* formatKey = "format";
+        static constexpr auto buildPayload = &falPayload<Offline>;     // Only used as the cache key
+        static constexpr auto generateLocal = &generateProceduralImage;
+    };
+
+    template <typename B>
+    constexpr BackendOps makeOps() {
+        return BackendOps{
+            B::id, B::name, B::submitPath, B::requestsPath, B::typicalMs,
+            BackendSchema{ B::steps, static_cast<double>(B::guidance), B::safetyChecker, B::formatKey },
+            B::buildPayload, B::generateLocal
+        };
+    }
+
+    // Indexed by BackendId
+    constexpr BackendOps registry[] = {
+        makeOps<FluxSchnell>(),
+        makeOps<PlaygroundV25>(),
+        makeOps<FluxLora>(),
+        makeOps<Offline>(),
+    };
+
+    constexpr bool registryInIdOrder() {
+        for (size_t i = 0; i < Backends::count(); i++) {
+            if (static_cast<size_t>(registry[i].id) != i) return false;
+        }
+        return true;
+    }
+
+    static_assert(sizeof(registry) / sizeof(registry[0]) == Backends::count(), "Every BackendId needs a registry entry");
+    static_assert(registryInIdOrder(), "Registry entries must be in BackendId order");
+
+    // Indexed by APIModel (UI category). Where a second backend renders the
+    // category acceptably, it is listed as an alternative for the router.
+    constexpr CategoryRoute categoryRoutes[] = {
+        { { BackendId::FLUX_SCHNELL }, 1 },                         // REALISM: photorealistic, fast
+        { { BackendId::PLAYGROUND_V25 }, 1 },                       // AESTHETIC
+        { { BackendId::FLUX_LORA }, 1 },                            // ARTISTIC
+        { { BackendId::FLUX_LORA, BackendId::FLUX_SCHNELL }, 2 },   // GAMING_TECH: best for stylized content
+        { { BackendId::FLUX_LORA, BackendId::FLUX_SCHNELL }, 2 },   // ENTERTAINMENT: good at dramatic compositions
+        { { BackendId::FLUX_SCHNELL, BackendId::FLUX_LORA }, 2 },   // PROFESSIONAL: fast, clean, corporate
+        { { BackendId::FLUX_LORA, BackendId::FLUX_SCHNELL }, 2 },   // SPECIALTY_ROOMS: handles themed content well
+        { { BackendId::FLUX_SCHNELL, BackendId::FLUX_LORA }, 2 },   // LANDSCAPES: fast photorealistic nature
+    };
+
+    static_assert(sizeof(categoryRoutes) / sizeof(categoryRoutes[0]) == static_cast<size_t>(APIModel::LANDSCAPES) + 1,
+        "Every APIModel category needs a backend");
+}
+
+const BackendOps& Backends::get(BackendId id) {
+    size_t index = static_cast<size_t>(id);
+    return registry[index < count() ? index : 0];
+}
+
+BackendId Backends::forCategory(APIModel category) {
+    return routeFor(category).choices[0];
+}
+
+const CategoryRoute& Backends::routeFor(APIModel category) {
+    size_t index = static_cast<size_t>(category);
+    return categoryRoutes[index < sizeof(categoryRoutes) / sizeof(categoryRoutes[0]) ? index : 0];
+}
+
+bool Backends::fromName(const std::string& name, BackendId& id) {
+    for (const BackendOps& ops : registry) {
+        if (name == ops.name) {
+            id = ops.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Backends::pinFromEnvironment(std::string& name, bool& pinned, BackendId& id) {
+    pinned = false;
+    if (name.empty()) {
+        const char* envBackend = std::getenv("FAL_BACKEND");
+        name = envBackend ? envBackend : "";
+    }
+    if (name.empty()) {
+        return true;
+    }
+    pinned = fromName(name, id);
+    return pinned;
+}
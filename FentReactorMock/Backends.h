@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "GenerationTypes.h"
+#include "HttpClient.h"
+
+// Generation parameters a backend sends with every request
+struct BackendSchema {
+    int steps = 0;              // num_inference_steps
+    double guidance = 0;        // guidance_scale
+    bool safetyChecker = false;
+    const char* formatKey = ""; // Name of the jpeg format field ("output_format" or "format")
+};
+
+// Operations table for one backend, generated at compile time from a backend
+// type (see Backends.cpp). The engine only talks to backends through this.
+struct BackendOps {
+    BackendId id;
+    const char* name;           // Short name for logs, poll stats and cache keys
+    const char* submitPath;     // Queue path under the fal base URL
+    const char* requestsPath;   // Prefix for requests/{id}
+    double typicalMs;           // Prior completion time for the poll scheduler
+    BackendSchema schema;
+
+    // Full JSON body for prompt (style modifier already appended) at width x height,
+    // asking for numImages candidates
+    std::string (*buildPayload)(const std::string& prompt, int width, int height, int numImages);
+
+    // In-process backends produce the encoded image directly instead of going
+    // through the queue; null for remote backends
+    bool (*generateLocal)(const std::string& prompt, int width, int height, ByteBuffer& image);
+
+    bool isRemote() const { return generateLocal == nullptr; }
+};
+
+// Backends a UI category may be sent to, its default first. Categories with
+// more than one are routed by measured latency (see BackendRouter.h).
+struct CategoryRoute {
+    static constexpr size_t MAX_CHOICES = 2;
+    BackendId choices[MAX_CHOICES];
+    size_t count;
+};
+
+namespace Backends {
+    const BackendOps& get(BackendId id);
+
+    // Default backend for a UI category
+    BackendId forCategory(APIModel category);
+
+    // Every backend the category may use
+    const CategoryRoute& routeFor(APIModel category);
+
+    // Looks a backend up by BackendOps::name; false if unknown
+    bool fromName(const std::string& name, BackendId& id);
+
+    // The backend every job is pinned to: name if set (a --backend flag), else
+    // FAL_BACKEND. pinned stays false when neither names one. False if the name
+    // is unknown; name is left holding it for the error message.
+    bool pinFromEnvironment(std::string& name, bool& pinned, BackendId& id);
+
+    constexpr size_t count() { return static_cast<size_t>(BackendId::COUNT); }
+}
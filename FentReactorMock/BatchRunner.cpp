@@ -0,0 +1,379 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include "Backends.h"
+#include "GenerationEngine.h"
+#include "HttpClient.h"
+#include "StyleCatalog.h"
+
+using json = nlohmann::json;
+
+namespace {
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        size_t start = text.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(start, end - start + 1);
+    }
+
+    // One CSV record; fields may be quoted, with "" for a literal quote
+    std::vector<std::string> splitCsv(const std::string& line) {
+        std::vector<std::string> fields;
+        std::string field;
+        bool quoted = false;
+
+        for (size_t i = 0; i < line.size(); i++) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                    field += '"';
+                    i++;
+                }
+                else if (c == '"') {
+                    quoted = false;
+                }
+                else {
+                    field += c;
+                }
+            }
+            else if (c == '"') {
+                quoted = true;
+            }
+            else if (c == ',') {
+                fields.push_back(trim(field));
+                field.clear();
+            }
+            else {
+                field += c;
+            }
+        }
+        fields.push_back(trim(field));
+        return fields;
+    }
+
+    // Fills row from column values; empty values keep the defaults
+    void applyFields(BatchRunner::Row& row, const std::string& prompt, const std::string& category,
+        const std::string& style, const std::string& orientation, const std::string& output) {
+        row.prompt = prompt;
+        row.output = output;
+
+        if (row.prompt.empty()) {
+            row.error = "Missing prompt";
+            return;
+        }
+
+        if (!StyleCatalog::styleFromKey(style, row.style)) {
+            row.error = "Unknown style '" + style + "'";
+            return;
+        }
+
+        row.category = StyleCatalog::defaultCategory(row.style);
+        if (!category.empty() && !StyleCatalog::categoryFromKey(category, row.category)) {
+            row.error = "Unknown category '" + category + "'";
+            return;
+        }
+
+        std::string mode = toLower(orientation);
+        if (mode == "landscape") {
+            row.orientation = OrientationMode::LANDSCAPE;
+        }
+        else if (!mode.empty() && mode != "portrait") {
+            row.error = "Unknown orientation '" + orientation + "'";
+        }
+    }
+
+    // Optional scheduling fields; empty values keep what the caller set
+    void applySchedulingFields(BatchRunner::Row& row, const std::string& client, const std::string& priority) {
+        if (!client.empty()) {
+            row.client = client;
+        }
+
+        std::string level = toLower(priority);
+        if (level == "interactive") {
+            row.priority = JobPriority::INTERACTIVE;
+        }
+        else if (level == "batch") {
+            row.priority = JobPriority::BATCH;
+        }
+        else if (!level.empty() && row.error.empty()) {
+            row.error = "Unknown priority '" + priority + "'";
+        }
+    }
+
+    void applyDeadline(BatchRunner::Row& row, double deadlineMs) {
+        if (deadlineMs < 0 && row.error.empty()) {
+            row.error = "deadline_ms must not be negative";
+            return;
+        }
+        row.deadlineMs = deadlineMs;
+    }
+
+    // "A cat, on a mat!" -> "a-cat-on-a-mat"
+    std::string slug(const std::string& text) {
+        std::string out;
+        for (unsigned char c : text) {
+            if (out.size() >= 40) break;
+            if (std::isalnum(c)) {
+                out += static_cast<char>(std::tolower(c));
+            }
+            else if (!out.empty() && out.back() != '-') {
+                out += '-';
+            }
+        }
+        while (!out.empty() && out.back() == '-') {
+            out.pop_back();
+        }
+        return out.empty() ? "image" : out;
+    }
+
+    std::string outputFileFor(const BatchRunner::Row& row, size_t index) {
+        if (!row.output.empty()) {
+            return row.output;
+        }
+
+        std::stringstream name;
+        name << std::setw(4) << std::setfill('0') << index + 1 << "_" << slug(row.prompt)
+            << (row.orientation == OrientationMode::LANDSCAPE ? "_landscape" : "_portrait") << ".jpg";
+        return name.str();
+    }
+
+    json rowRecord(const BatchRunner::Row& row, size_t index, BackendId backend) {
+        return {
+            {"row", index + 1},
+            {"line", row.line},
+            {"prompt", row.prompt},
+            {"category", StyleCatalog::categoryKey(row.category)},
+            {"style", StyleCatalog::styleKey(row.style)},
+            {"orientation", row.orientation == OrientationMode::LANDSCAPE ? "landscape" : "portrait"},
+            {"backend", Backends::get(backend).name}
+        };
+    }
+}
+
+bool BatchRunner::loadManifest(const std::string& path, std::vector<Row>& rows, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    bool csvHeaderRead = false;
+    std::vector<std::string> columns = { "prompt", "category", "style", "orientation", "output" };
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::string text = trim(line);
+        if (text.empty() || text[0] == '#') {
+            continue;
+        }
+
+        Row row;
+        row.line = lineNumber;
+
+        if (text[0] == '{') {
+            parseJsonRow(text, row);
+            rows.push_back(row);
+            continue;
+        }
+
+        std::vector<std::string> fields = splitCsv(text);
+        if (!csvHeaderRead) {
+            csvHeaderRead = true;
+
+            // A header names the columns; without one they are in the default order
+            std::vector<std::string> header;
+            for (const std::string& field : fields) {
+                header.push_back(toLower(field));
+            }
+            if (std::find(header.begin(), header.end(), "prompt") != header.end()) {
+                columns = header;
+                continue;
+            }
+        }
+
+        auto column = [&](const std::string& name) {
+            auto it = std::find(columns.begin(), columns.end(), name);
+            size_t index = static_cast<size_t>(it - columns.begin());
+            return index < fields.size() ? fields[index] : std::string();
+        };
+        applyFields(row, column("prompt"), column("category"), column("style"), column("orientation"), column("output"));
+        applySchedulingFields(row, column("client"), column("priority"));
+        if (!column("deadline_ms").empty()) {
+            applyDeadline(row, std::atof(column("deadline_ms").c_str()));
+        }
+        rows.push_back(row);
+    }
+
+    return true;
+}
+
+void BatchRunner::parseJsonRow(const std::string& text, Row& row) {
+    try {
+        json record = json::parse(text);
+        applyFields(row, record.value("prompt", ""), record.value("category", ""),
+            record.value("style", ""), record.value("orientation", ""), record.value("output", ""));
+        applySchedulingFields(row, record.value("client", ""), record.value("priority", ""));
+        applyDeadline(row, record.value("deadline_ms", row.deadlineMs));
+    }
+    catch (const json::exception& e) {
+        row.error = std::string("Invalid JSON: ") + e.what();
+    }
+}
+
+int BatchRunner::run(const Options& options) {
+    std::vector<Row> rows;
+    std::string error;
+    if (!loadManifest(options.manifestPath, rows, error)) {
+        std::cout << "Batch: " << error << std::endl;
+        return 1;
+    }
+
+    // Route every row to one backend if asked to (flag first, then FAL_BACKEND)
+    bool hasPinnedBackend = false;
+    BackendId pinnedBackend = BackendId::FLUX_SCHNELL;
+    std::string backendName = options.backend;
+    if (!Backends::pinFromEnvironment(backendName, hasPinnedBackend, pinnedBackend)) {
+        std::cout << "Batch: unknown backend " << backendName << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    std::string resultsPath = options.resultsPath.empty()
+        ? (std::filesystem::path(options.outputDir) / "results.jsonl").string() : options.resultsPath;
+
+    // Appended line by line so a run that dies overnight keeps what it finished
+    std::ofstream results(resultsPath, std::ios::app);
+    if (!results) {
+        std::cout << "Batch: could not open " << resultsPath << std::endl;
+        return 1;
+    }
+
+    size_t concurrency = static_cast<size_t>(std::max(1, options.concurrency));
+    std::cout << "Batch: " << rows.size() << " rows from " << options.manifestPath << ", concurrency " << concurrency
+        << ", writing to " << options.outputDir << std::endl;
+
+    HttpClient http;
+    GenerationEngine engine(http, concurrency);
+    engine.getPollScheduler().setStatsFile("poll_stats.json");
+
+    engine.getResultCache().openFromEnvironment();
+
+    // Guards the results file, the counters and the in-flight window
+    std::mutex mutex;
+    std::condition_variable slotFreed;
+    size_t inFlight = 0;
+    size_t finished = 0;
+    size_t failures = 0;
+
+    auto writeResult = [&](const json& record, bool success) {
+        std::lock_guard<std::mutex> lock(mutex);
+        results << record.dump() << "\n";
+        results.flush();
+        finished++;
+        if (!success) failures++;
+
+        std::cout << "[" << finished << "/" << rows.size() << "] " << (success ? "ok " : "FAILED ")
+            << (success ? record.value("file", "") : record.value("error", "")) << std::endl;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Row& row = rows[i];
+        BackendId backend = hasPinnedBackend ? pinnedBackend : engine.routeCategory(row.category);
+        json record = rowRecord(row, i, backend);
+
+        if (!row.error.empty()) {
+            record["success"] = false;
+            record["error"] = row.error;
+            writeResult(record, false);
+            continue;
+        }
+
+        // Keep only `concurrency` jobs in the engine, so each job's timings cover
+        // its own generation rather than time spent behind the rest of the manifest
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFreed.wait(lock, [&]() { return inFlight < concurrency; });
+            inFlight++;
+        }
+
+        GenerationRequest request;
+        request.prompt = row.prompt;
+        request.styleModifier = StyleCatalog::promptModifier(row.style);
+        request.backend = backend;
+        request.orientation = row.orientation;
+        request.client = row.client.empty() ? "batch" : row.client;
+        request.priority = row.priority;
+        request.deadlineMs = row.deadlineMs;
+
+        std::string outputFile = (std::filesystem::path(options.outputDir) / outputFileFor(row, i)).string();
+
+        engine.submit(request, outputFile, [&, record](const GenerationResult& result) mutable {
+            record["success"] = result.success;
+            record["file"] = result.filename;
+            record["error"] = result.error;
+            record["request_id"] = result.requestId;
+            record["image_url"] = result.imageUrl;
+            record["polls"] = result.pollCount;
+            record["submitted_ms"] = result.submittedMs;
+            record["completed_ms"] = result.completedMs;
+            record["total_ms"] = result.totalMs;
+            writeResult(record, result.success);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                inFlight--;
+            }
+            slotFreed.notify_one();
+        });
+    }
+
+    engine.waitUntilIdle();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(2)
+        << "Batch finished: " << rows.size() - failures << "/" << rows.size() << " images in " << wallSeconds << " s ("
+        << (wallSeconds > 0 ? (rows.size() - failures) / wallSeconds * 60.0 : 0.0) << " per minute), "
+        << failures << " failed. Results in " << resultsPath << std::endl;
+    engine.getPollScheduler().printStats();
+    engine.getResultCache().printStats();
+    engine.printSchedulerStats();
+    FalApi::credentials().printStats();
+    engine.getCircuitBreaker().printStats();
+    engine.getRouter().printStats();
+
+    return failures == 0 ? 0 : 1;
+}
+
+void BatchRunner::printStyles() {
+    std::cout << "Categories:" << std::endl;
+    for (const StyleCatalog::CategoryInfo& info : StyleCatalog::categories()) {
+        std::cout << "  " << std::left << std::setw(26) << info.key << info.name << std::endl;
+    }
+
+    std::cout << "Styles (category):" << std::endl;
+    std::cout << "  " << std::left << std::setw(26) << "none" << "-" << std::endl;
+    for (const StyleCatalog::StyleInfo& info : StyleCatalog::styles()) {
+        std::cout << "  " << std::left << std::setw(26) << info.key << StyleCatalog::categoryKey(info.category) << std::endl;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "GenerationTypes.h"
+
+// Headless batch generation from a prompt manifest, selected with --batch in
+// main.cpp. Never constructs ImageGenerator, so no window is opened.
+namespace BatchRunner {
+    struct Row {
+        int line = 0;               // 1-based line in the manifest, for messages
+        std::string prompt;
+        APIModel category = APIModel::REALISM;
+        StyleMode style = StyleMode::NONE;
+        OrientationMode orientation = OrientationMode::PORTRAIT;
+        std::string output;         // File name under the output directory; generated if empty
+        std::string client;         // Scheduler fair-share key; callers fill in their own default
+        JobPriority priority = JobPriority::BATCH;     // Optional "interactive" / "batch" field
+        double deadlineMs = 0;      // Optional "deadline_ms": give up on the image after this long; 0 = engine default
+        std::string error;          // Set if the row could not be parsed; it is reported, not run
+    };
+
+    struct Options {
+        std::string manifestPath;
+        std::string outputDir = "batch";
+        std::string resultsPath;    // Defaults to <outputDir>/results.jsonl
+        int concurrency = 4;
+        std::string backend;        // Overrides every row's category routing (like FAL_BACKEND)
+    };
+
+    // Reads a JSONL manifest (one {"prompt", "category", "style", "orientation", "output"}
+    // object per line) or a CSV one with a header naming the same columns. Only
+    // prompt is required; category defaults to the style's category. Rows with
+    // bad values come back with Row::error set. False if the file can't be read.
+    bool loadManifest(const std::string& path, std::vector<Row>& rows, std::string& error);
+
+    // Fills row from one JSON object in the manifest format; sets Row::error on bad values
+    void parseJsonRow(const std::string& text, Row& row);
+
+    // Runs every row through the generation engine with at most `concurrency`
+    // jobs in flight and appends one JSON line per row to the results file as
+    // it finishes. Returns 0 if every row produced an image.
+    int run(const Options& options);
+
+    // Prints the category and style keys accepted in manifests and on the command line
+    void printStyles();
+}
@@ -0,0 +1,843 @@
+#include "Benchmark.h"
+#include "FalApi.h"
+#include "GenerationEngine.h"
+#include "GenerationService.h"
+#include "HttpClient.h"
+#include "JobScheduler.h"
+#include "PayloadTemplate.h"
+#include "WebhookListener.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct LatencySummary {
+        double mean = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double max = 0;
+        int failures = 0;
+    };
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    LatencySummary summarize(std::vector<double> samples, int failures) {
+        LatencySummary summary;
+        summary.failures = failures;
+        if (samples.empty()) return summary;
+
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (double s : samples) total += s;
+
+        summary.mean = total / samples.size();
+        summary.p50 = percentile(samples, 0.50);
+        summary.p95 = percentile(samples, 0.95);
+        summary.p99 = percentile(samples, 0.99);
+        summary.max = samples.back();
+        return summary;
+    }
+
+    void printSummary(const std::string& label, const LatencySummary& s) {
+        std::cout << std::fixed << std::setprecision(2)
+            << std::left << std::setw(10) << label
+            << " mean " << std::setw(8) << s.mean
+            << " p50 " << std::setw(8) << s.p50
+            << " p95 " << std::setw(8) << s.p95
+            << " p99 " << std::setw(8) << s.p99
+            << " max " << std::setw(8) << s.max
+            << " ms  (" << s.failures << " failed)" << std::endl;
+    }
+
+    LatencySummary timeRequests(HttpClient& client, const std::string& url, int requests) {
+        std::vector<double> samples;
+        samples.reserve(requests);
+        int failures = 0;
+
+        for (int i = 0; i < requests; i++) {
+            auto start = std::chrono::steady_clock::now();
+            HttpResponse response = client.get(url);
+            auto end = std::chrono::steady_clock::now();
+
+            if (response.result != CURLE_OK) {
+                failures++;
+                continue;
+            }
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        return summarize(samples, failures);
+    }
+
+    double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The pre-engine request sequence: submit, poll on a fixed interval, download
+    bool runBlockingJob(HttpClient& http, const std::string& prompt, int pollIntervalMs) {
+        const BackendId backend = BackendId::FLUX_SCHNELL;
+        std::vector<std::string> headers;
+        if (!FalApi::authHeaders(headers, true)) {
+            return false;
+        }
+
+        HttpResponse submitted = http.post(FalApi::submitUrl(backend),
+            FalApi::buildPayload(prompt, "", backend, OrientationMode::PORTRAIT), headers);
+        std::string requestId = submitted.result == CURLE_OK ? FalApi::parseRequestId(submitted.body) : "";
+        if (requestId.empty()) {
+            return false;
+        }
+
+        headers.clear();
+        FalApi::authHeaders(headers, false);
+
+        auto start = std::chrono::steady_clock::now();
+        while (msSince(start) < 120000.0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(pollIntervalMs));
+
+            HttpResponse polled = http.get(FalApi::resultUrl(backend, requestId), headers);
+            if (polled.result != CURLE_OK) {
+                continue;
+            }
+
+            FalApi::QueueStatus status = FalApi::parseStatus(polled.body);
+            if (!status.imageUrl.empty()) {
+                ByteBuffer image;
+                return http.downloadToMemory(status.imageUrl, image);
+            }
+            if (status.status == "FAILED" || status.notFound) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // One job through the local generation service: POST /jobs (backing off while
+    // the queue is full), long-poll until it finishes, then fetch the image
+    bool runServiceJob(HttpClient& http, const std::string& baseUrl, const std::string& prompt) {
+        const std::vector<std::string> headers = { "Content-Type: application/json" };
+        std::string body = nlohmann::json({ {"prompt", prompt} }).dump();
+
+        std::string id;
+        auto start = std::chrono::steady_clock::now();
+        while (id.empty() && msSince(start) < 120000.0) {
+            HttpResponse created = http.post(baseUrl + "/jobs", body, headers);
+            if (created.status == 202) {
+                id = nlohmann::json::parse(created.body, nullptr, false).value("id", "");
+            }
+            else if (created.status == 429) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            else {
+                return false;
+            }
+        }
+
+        while (!id.empty() && msSince(start) < 120000.0) {
+            HttpResponse polled = http.get(baseUrl + "/jobs/" + id + "?wait=10000");
+            if (!polled.ok()) {
+                return false;
+            }
+
+            std::string status = nlohmann::json::parse(polled.body, nullptr, false).value("status", "");
+            if (status == "completed") {
+                HttpResponse image = http.get(baseUrl + "/jobs/" + id + "/image");
+                return image.ok() && !image.body.empty();
+            }
+            if (status == "failed" || status == "cancelled") {
+                return false;
+            }
+        }
+        return false;
+    }
+}
+
+namespace {
+    struct StatusSample {
+        std::string name;
+        std::string body;
+    };
+
+    // Bodies shaped like what fal's requests/{id} endpoint returns at each stage.
+    // Log lines are repeated to the volume a verbose model produces.
+    std::vector<StatusSample> statusSamples() {
+        const std::string id = "764cabcf-b745-4b3e-ae38-1200304cf45b";
+        const std::string base = "https://queue.fal.run/fal-ai/flux-1/requests/" + id;
+
+        std::string logs;
+        for (int i = 0; i < 40; i++) {
+            if (i > 0) logs += ",";
+            logs += "{\"message\":\"Step " + std::to_string(i) + "/40 \\u2014 denoising latents (cfg 3.5)\","
+                "\"level\":\"INFO\",\"source\":\"stdout\",\"timestamp\":\"2025-01-14T09:21:0" + std::to_string(i % 10) + ".512Z\"}";
+        }
+
+        return {
+            { "in_queue", "{\"status\":\"IN_QUEUE\",\"request_id\":\"" + id + "\",\"response_url\":\"" + base +
+                "\",\"status_url\":\"" + base + "/status\",\"cancel_url\":\"" + base + "/cancel\","
+                "\"logs\":null,\"metrics\":{},\"queue_position\":3}" },
+            { "in_progress", "{\"status\":\"IN_PROGRESS\",\"request_id\":\"" + id + "\",\"response_url\":\"" + base +
+                "\",\"logs\":[" + logs + "],\"metrics\":{}}" },
+            { "completed", "{\"images\":[{\"url\":\"https:\\/\\/v3.fal.media\\/files\\/lion\\/Xq2bP_7fk1R0aWbLvWcDn.jpeg\","
+                "\"width\":1296,\"height\":2304,\"content_type\":\"image/jpeg\"}],\"timings\":{\"inference\":1.8273},"
+                "\"seed\":2841095517,\"has_nsfw_concepts\":[false],\"prompt\":\"a lighthouse on a cliff at dusk, "
+                "in the style of Studio Ghibli\"}" },
+            { "failed", "{\"status\":\"FAILED\",\"error\":\"CUDA out of memory\",\"logs\":[" + logs + "]}" },
+        };
+    }
+
+    // The previous decoder: full DOM, then probe for the fields we need
+    FalApi::QueueStatus parseStatusDom(const std::string& response) {
+        FalApi::QueueStatus result;
+        try {
+            nlohmann::json statusJson = nlohmann::json::parse(response);
+            result.parsed = true;
+            if (statusJson.contains("images") && statusJson["images"].is_array() && !statusJson["images"].empty()) {
+                result.imageUrl = statusJson["images"][0]["url"];
+                result.status = "COMPLETED";
+                return result;
+            }
+            if (statusJson.contains("status") && statusJson["status"].is_string()) {
+                result.status = statusJson["status"];
+            }
+            else if (statusJson.contains("status") && statusJson["status"].is_null()) {
+                result.status = "QUEUED";
+            }
+            else {
+                result.status = "PROCESSING";
+            }
+        }
+        catch (const std::exception&) {
+        }
+        return result;
+    }
+
+    template <typename Parser>
+    double nsPerParse(const std::string& body, int iterations, Parser parse) {
+        volatile size_t sink = 0;   // Keeps the loop from being optimized away
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            FalApi::QueueStatus status = parse(body);
+            sink = sink + status.status.size() + status.imageUrl.size();
+        }
+        return msSince(start) * 1e6 / iterations;
+    }
+}
+
+int Benchmark::runStatusParseBenchmark(int iterations) {
+    std::cout << "Status decode benchmark: " << iterations << " parses per sample" << std::endl;
+
+    for (const StatusSample& sample : statusSamples()) {
+        FalApi::QueueStatus dom = parseStatusDom(sample.body);
+        FalApi::QueueStatus scanned = FalApi::parseStatus(sample.body);
+        if (dom.status != scanned.status || dom.imageUrl != scanned.imageUrl) {
+            std::cout << sample.name << ": decoders disagree (" << dom.status << " vs " << scanned.status << ")" << std::endl;
+            return 1;
+        }
+
+        double domNs = nsPerParse(sample.body, iterations, parseStatusDom);
+        double scanNs = nsPerParse(sample.body, iterations, FalApi::parseStatus);
+
+        std::cout << std::fixed << std::setprecision(0)
+            << std::left << std::setw(12) << sample.name
+            << std::right << std::setw(7) << sample.body.size() << " bytes"
+            << "  dom " << std::setw(8) << domNs << " ns"
+            << "  scanner " << std::setw(7) << scanNs << " ns"
+            << std::setprecision(1) << "  (" << domNs / scanNs << "x)" << std::endl;
+    }
+
+    return 0;
+}
+
+int Benchmark::runPayloadBenchmark(int prompts) {
+    std::cout << "Payload build benchmark: " << prompts << " prompts per backend and orientation" << std::endl;
+
+    // Mostly plain prompts, with the odd quote, newline and non-ASCII character users paste in
+    const char* subjects[] = {
+        "a lighthouse on a cliff at dusk",
+        "portrait of an old fisherman, \"weathered\" hands",
+        "neon city street in the rain\nwide angle",
+        "caf\xC3\xA9 terrace at night, Van Gogh colours",
+        "tabby cat asleep on a stack of books\t(cosy)",
+    };
+    const std::string styleModifier = ", in the style of Studio Ghibli";
+
+    std::vector<std::string> batch;
+    batch.reserve(prompts);
+    for (int i = 0; i < prompts; i++) {
+        batch.push_back(std::string(subjects[i % 5]) + " #" + std::to_string(i));
+    }
+
+    for (size_t b = 0; b < Backends::count(); b++) {
+        BackendId backend = static_cast<BackendId>(b);
+        const BackendOps& ops = Backends::get(backend);
+        if (!ops.isRemote()) {
+            continue;
+        }
+
+        for (OrientationMode orientation : { OrientationMode::PORTRAIT, OrientationMode::LANDSCAPE }) {
+            int width, height;
+            FalApi::imageDimensions(orientation, width, height);
+            const PayloadTemplate& payloadTemplate = PayloadTemplates::get(backend, orientation);
+
+            size_t bytes = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const std::string& prompt : batch) {
+                bytes += ops.buildPayload(prompt + styleModifier, width, height, 1).size();
+            }
+            double treeMs = msSince(start);
+
+            start = std::chrono::steady_clock::now();
+            for (const std::string& prompt : batch) {
+                bytes += payloadTemplate.render(prompt, styleModifier).size();
+            }
+            double templateMs = msSince(start);
+
+            // A batch submitter keeps one buffer for the whole run
+            std::string buffer;
+            start = std::chrono::steady_clock::now();
+            for (const std::string& prompt : batch) {
+                payloadTemplate.renderInto(prompt, styleModifier, buffer);
+                bytes += buffer.size();
+            }
+            double reusedMs = msSince(start);
+
+            for (const std::string& prompt : batch) {
+                for (int numImages = 1; numImages <= FalApi::MAX_IMAGES; numImages++) {
+                    if (ops.buildPayload(prompt + styleModifier, width, height, numImages) !=
+                        payloadTemplate.render(prompt, styleModifier, numImages)) {
+                        std::cout << ops.name << ": template output differs for \"" << prompt << "\" (" << numImages
+                            << " images)" << std::endl;
+                        return 1;
+                    }
+                }
+            }
+
+            std::string label = std::string(ops.name) + (orientation == OrientationMode::PORTRAIT ? " 9:16" : " 16:9");
+            std::cout << std::fixed << std::setprecision(0) << std::left << std::setw(22) << label << std::right
+                << " json tree " << std::setw(9) << prompts / (treeMs / 1000.0) << "/s"
+                << "  template " << std::setw(9) << prompts / (templateMs / 1000.0) << "/s"
+                << "  reused buffer " << std::setw(9) << prompts / (reusedMs / 1000.0) << "/s"
+                << std::setprecision(1) << "  (" << treeMs / reusedMs << "x)" << std::endl;
+            if (bytes == 0) return 1;
+        }
+    }
+
+    return 0;
+}
+
+namespace {
+    struct SimulatedJob {
+        std::string client;
+        JobPriority priority;
+        BackendId backend;
+        double arrivalSeconds;
+        double serviceSeconds;
+        double startSeconds = -1;
+        double finishSeconds = -1;
+    };
+
+    struct SimulationResult {
+        double interactiveMeanWait = 0;
+        double interactiveMaxWait = 0;
+        double makespan = 0;
+        std::map<std::string, double> lastFinish;        // Per client
+        std::map<std::string, size_t> startedInWindow;    // Per client, during the first minutes
+    };
+
+    // The workload: one big manifest and one small one queued at t=0, and an
+    // interactive job every few seconds. Playground jobs take longer than schnell.
+    std::vector<SimulatedJob> simulatedWorkload(int batchJobs) {
+        std::vector<SimulatedJob> jobs;
+        uint32_t seed = 12345;
+        auto jitter = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return 0.75 + (seed >> 8) % 1000 / 2000.0;     // 0.75 - 1.25
+        };
+        auto serviceTime = [&](BackendId backend) {
+            return (backend == BackendId::PLAYGROUND_V25 ? 6.0 : 2.5) * jitter();
+        };
+
+        for (int i = 0; i < batchJobs; i++) {
+            BackendId backend = i % 3 == 0 ? BackendId::PLAYGROUND_V25 : BackendId::FLUX_SCHNELL;
+            jobs.push_back({ "manifest", JobPriority::BATCH, backend, 0.0, serviceTime(backend) });
+        }
+        for (int i = 0; i < 200; i++) {
+            BackendId backend = i % 2 == 0 ? BackendId::PLAYGROUND_V25 : BackendId::FLUX_SCHNELL;
+            jobs.push_back({ "nightly", JobPriority::BATCH, backend, 0.5, serviceTime(backend) });
+        }
+        for (int i = 0; i < 300; i++) {
+            BackendId backend = i % 4 == 0 ? BackendId::PLAYGROUND_V25 : BackendId::FLUX_SCHNELL;
+            jobs.push_back({ "ui", JobPriority::INTERACTIVE, backend, 1.0 + i * 4.0, serviceTime(backend) });
+        }
+
+        std::stable_sort(jobs.begin(), jobs.end(),
+            [](const SimulatedJob& a, const SimulatedJob& b) { return a.arrivalSeconds < b.arrivalSeconds; });
+        return jobs;
+    }
+
+    // Discrete-event run: the scheduler reads the simulated clock, so its wait
+    // stats come out in simulated time too. With fair = false every job goes in
+    // as one client and one class, which is the engine's old FIFO deque.
+    SimulationResult simulateScheduler(std::vector<SimulatedJob> jobs, bool fair, double windowSeconds) {
+        double simSeconds = 0;
+        auto simNow = [&simSeconds]() {
+            return JobScheduler::Clock::time_point() +
+                std::chrono::duration_cast<JobScheduler::Clock::duration>(std::chrono::duration<double>(simSeconds));
+        };
+
+        JobScheduler scheduler(simNow);
+        scheduler.setGlobalLimit(8);
+        scheduler.setBackendLimit(BackendId::PLAYGROUND_V25, 3);
+
+        using Completion = std::pair<double, uint64_t>;
+        std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion>> completions;
+        size_t nextArrival = 0;
+        size_t finished = 0;
+
+        while (finished < jobs.size()) {
+            double nextEvent = nextArrival < jobs.size() ? jobs[nextArrival].arrivalSeconds : 1e300;
+            if (!completions.empty()) {
+                nextEvent = std::min(nextEvent, completions.top().first);
+            }
+            simSeconds = nextEvent;
+
+            while (!completions.empty() && completions.top().first <= simSeconds) {
+                SimulatedJob& job = jobs[completions.top().second];
+                completions.pop();
+                job.finishSeconds = simSeconds;
+                scheduler.release(job.backend);
+                finished++;
+            }
+            while (nextArrival < jobs.size() && jobs[nextArrival].arrivalSeconds <= simSeconds) {
+                const SimulatedJob& job = jobs[nextArrival];
+                scheduler.enqueue(nextArrival, fair ? job.client : "", fair ? job.priority : JobPriority::INTERACTIVE, job.backend);
+                nextArrival++;
+            }
+
+            uint64_t id = 0;
+            while (scheduler.next(id)) {
+                SimulatedJob& job = jobs[id];
+                job.startSeconds = simSeconds;
+                completions.push({ simSeconds + job.serviceSeconds, id });
+            }
+        }
+
+        SimulationResult result;
+        size_t interactive = 0;
+        for (const SimulatedJob& job : jobs) {
+            double wait = job.startSeconds - job.arrivalSeconds;
+            if (job.priority == JobPriority::INTERACTIVE) {
+                interactive++;
+                result.interactiveMeanWait += wait;
+                result.interactiveMaxWait = std::max(result.interactiveMaxWait, wait);
+            }
+            result.makespan = std::max(result.makespan, job.finishSeconds);
+            result.lastFinish[job.client] = std::max(result.lastFinish[job.client], job.finishSeconds);
+            if (job.startSeconds < windowSeconds) {
+                result.startedInWindow[job.client]++;
+            }
+        }
+        result.interactiveMeanWait /= interactive > 0 ? interactive : 1;
+        return result;
+    }
+}
+
+int Benchmark::runSchedulerSimulation(int batchJobs) {
+    const double windowSeconds = 600;
+    std::vector<SimulatedJob> jobs = simulatedWorkload(batchJobs);
+    std::cout << "Scheduler simulation: " << jobs.size() << " jobs (" << batchJobs << " manifest, 200 nightly, 300 interactive), "
+        << "8 slots, playground-v25 capped at 3" << std::endl;
+
+    SimulationResult fifo = simulateScheduler(jobs, false, windowSeconds);
+    SimulationResult fair = simulateScheduler(jobs, true, windowSeconds);
+
+    for (const auto& run : { std::make_pair("fifo", &fifo), std::make_pair("fair", &fair) }) {
+        const SimulationResult& result = *run.second;
+        std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(6) << run.first << std::right
+            << "interactive wait mean " << std::setw(7) << result.interactiveMeanWait << " s, max " << std::setw(7)
+            << result.interactiveMaxWait << " s; all done at " << result.makespan << " s" << std::endl;
+
+        std::cout << "      started in first " << static_cast<int>(windowSeconds) << " s:";
+        for (const auto& entry : result.startedInWindow) {
+            std::cout << " " << entry.first << " " << entry.second;
+        }
+        std::cout << "; last finish:";
+        for (const auto& entry : result.lastFinish) {
+            std::cout << " " << entry.first << " " << entry.second << " s";
+        }
+        std::cout << std::endl;
+    }
+
+    // Priorities must keep interactive jobs ahead of the backlog
+    return fair.interactiveMaxWait < fifo.interactiveMaxWait ? 0 : 1;
+}
+
+int Benchmark::runHttpBenchmark(const std::string& url, int requests, bool insecure) {
+    std::cout << "HTTP client benchmark: " << requests << " sequential GETs to " << url << std::endl;
+
+    HttpClient unpooled(false);
+    HttpClient pooled(true);
+    unpooled.setVerifyPeer(!insecure);
+    pooled.setVerifyPeer(!insecure);
+
+    LatencySummary before = timeRequests(unpooled, url, requests);
+    LatencySummary after = timeRequests(pooled, url, requests);
+
+    printSummary("unpooled", before);
+    printSummary("pooled", after);
+
+    if (before.mean > 0 && after.mean > 0) {
+        std::cout << "Pooled client speedup: " << std::setprecision(2) << (before.mean / after.mean) << "x" << std::endl;
+    }
+
+    return (before.failures == requests || after.failures == requests) ? 1 : 0;
+}
+
+int Benchmark::runLoadTest(const LoadTestOptions& options) {
+    // Point the client at a local mock unless an existing queue was given
+    std::unique_ptr<MockFalServer> mock;
+    if (options.queueUrl.empty()) {
+        mock = std::make_unique<MockFalServer>(options.mock);
+        if (!mock->start(0)) {
+            return 1;
+        }
+        FalApi::setEndpoint(mock->getBaseUrl(), options.keys.empty() ? "mock-key" : options.keys);
+    }
+    else {
+        const char* key = std::getenv("FAL_KEY");
+        FalApi::setEndpoint(options.queueUrl, key ? key : "mock-key");
+    }
+
+    std::string client = options.blockingClient ? "blocking client (poll every " + std::to_string(options.pollIntervalMs) + " ms)"
+        : options.service ? "HTTP service, " + std::to_string(options.serviceClients) + " clients"
+        : options.webhooks ? "engine + webhooks" : "engine";
+    std::cout << "Load test: " << options.jobs << " jobs, concurrency " << options.concurrency << ", " << client << std::endl;
+
+    HttpClient http;
+    std::mutex resultsMutex;
+    std::vector<double> latencies;
+    int failures = 0;
+    double failureMs = 0;   // Total time to a failure answer; small when failing backends fail fast
+
+    auto record = [&](bool ok, double ms) {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        if (ok) {
+            latencies.push_back(ms);
+        }
+        else {
+            failures++;
+            failureMs += ms;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t polls = 0;
+
+    if (options.blockingClient) {
+        std::atomic<int> nextJob(0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < options.concurrency; t++) {
+            workers.emplace_back([&]() {
+                for (int i = nextJob++; i < options.jobs; i = nextJob++) {
+                    bool ok = runBlockingJob(http, "load test job " + std::to_string(i), options.pollIntervalMs);
+                    record(ok, msSince(start));
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+    else if (options.service) {
+        // Same engine, reached over HTTP by independent clients that each keep one job going
+        HttpClient serviceHttp;
+        GenerationEngine engine(serviceHttp, static_cast<size_t>(std::max(1, options.concurrency)));
+        GenerationService service(engine, GenerationService::Options());
+        if (!service.start(0)) {
+            return 1;
+        }
+
+        std::atomic<int> nextJob(0);
+        std::vector<std::thread> clients;
+        for (int t = 0; t < std::max(1, options.serviceClients); t++) {
+            clients.emplace_back([&]() {
+                for (int i = nextJob++; i < options.jobs; i = nextJob++) {
+                    auto jobStart = std::chrono::steady_clock::now();
+                    bool ok = runServiceJob(http, service.getBaseUrl(), "load test job " + std::to_string(i));
+                    record(ok, msSince(jobStart));
+                }
+            });
+        }
+        for (std::thread& worker : clients) {
+            worker.join();
+        }
+
+        polls = engine.getPollScheduler().getTotalPolls();
+        engine.shutdown();
+        service.printStats();
+        engine.getCircuitBreaker().printStats();
+        engine.getRouter().printStats();
+    }
+    else {
+        GenerationEngine engine(http, static_cast<size_t>(std::max(1, options.concurrency)));
+        std::unique_ptr<WebhookListener> listener;
+        if (options.webhooks) {
+            listener = std::make_unique<WebhookListener>(engine);
+            listener->start(0, "");
+        }
+
+        for (int i = 0; i < options.jobs; i++) {
+            GenerationRequest request;
+            request.prompt = "load test job " + std::to_string(i);   // Distinct, so nothing coalesces
+            request.backend = BackendId::FLUX_SCHNELL;
+            request.deadlineMs = options.deadlineMs;
+            engine.submit(request, "", [&](const GenerationResult& result) {
+                record(result.success, result.totalMs);
+            });
+        }
+
+        engine.waitUntilIdle();
+        polls = engine.getPollScheduler().getTotalPolls();
+        engine.getCircuitBreaker().printStats();
+    }
+
+    double wallMs = msSince(start);
+    if (!options.blockingClient) {
+        FalApi::credentials().printStats();
+    }
+    FalApi::setEndpoint("", "");
+
+    // All jobs are "submitted" at the start, so the blocking and engine latencies include waiting
+    // for a slot; service latencies run from each client's POST
+    LatencySummary summary = summarize(latencies, failures);
+    std::cout << std::fixed << std::setprecision(2)
+        << "Completed " << latencies.size() << "/" << options.jobs << " in " << wallMs / 1000.0 << " s, "
+        << "throughput " << (latencies.size() * 1000.0 / std::max(1.0, wallMs)) << " jobs/s" << std::endl;
+    printSummary("end-to-end", summary);
+    if (failures > 0) {
+        std::cout << std::setprecision(1) << "Failures answered after " << failureMs / failures << " ms on average" << std::endl;
+    }
+    if (!options.blockingClient) {
+        std::cout << "Status polls: " << polls << " (" << std::setprecision(2)
+            << (options.jobs ? static_cast<double>(polls) / options.jobs : 0.0) << " per job)" << std::endl;
+    }
+    if (mock) {
+        mock->printStats();
+    }
+
+    return failures == options.jobs ? 1 : 0;
+}
+
+int Benchmark::runDraftBenchmark(const DraftBenchOptions& options) {
+    MockFalServer::Options mockOptions = options.mock;
+    if (mockOptions.msPerMegapixelStep <= 0) {
+        mockOptions.msPerMegapixelStep = 95.0;
+    }
+    MockFalServer mock(mockOptions);
+    if (!mock.start(0)) {
+        return 1;
+    }
+    FalApi::setEndpoint(mock.getBaseUrl(), "mock-key");
+
+    std::cout << "Draft benchmark: " << options.jobs << " jobs on " << Backends::get(options.backend).name
+        << ", concurrency " << options.concurrency << ", " << static_cast<int>(options.rejectRate * 100) << "% of drafts rejected" << std::endl;
+
+    struct Timing {
+        uint64_t finalId = 0;
+        bool rejectWhenKnown = false;   // Draft landed before submitWithDraft returned
+        double firstPixelMs = -1;
+        double finalMs = -1;
+    };
+
+    const char* labels[] = { "final only", "alongside", "ahead" };
+    int failures = 0;
+    for (int pass = 0; pass < 3; pass++) {
+        HttpClient http;
+        GenerationEngine engine(http, static_cast<size_t>(std::max(1, options.concurrency)));
+
+        std::mutex timingsMutex;
+        std::vector<Timing> timings(options.jobs);
+        uint64_t submitsBefore = mock.getStats().submits;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < options.jobs; i++) {
+            GenerationRequest request;
+            request.prompt = std::string(labels[pass]) + " draft benchmark " + std::to_string(i);
+            request.backend = options.backend;
+
+            // Spread rejections evenly over the run
+            bool reject = static_cast<int>(i * options.rejectRate) != static_cast<int>((i + 1) * options.rejectRate);
+
+            auto onFinal = [&, i](const GenerationResult& result) {
+                std::lock_guard<std::mutex> lock(timingsMutex);
+                if (result.success) {
+                    double ms = msSince(start);
+                    timings[i].finalMs = ms;
+                    if (timings[i].firstPixelMs < 0) timings[i].firstPixelMs = ms;
+                }
+            };
+
+            if (pass == 0) {
+                engine.submit(request, "", onFinal);
+                continue;
+            }
+
+            auto onDraft = [&, i, reject](const GenerationResult& result) {
+                std::lock_guard<std::mutex> lock(timingsMutex);
+                if (result.success && timings[i].firstPixelMs < 0) {
+                    timings[i].firstPixelMs = msSince(start);
+                }
+                if (reject) {
+                    if (timings[i].finalId) engine.cancel(timings[i].finalId);
+                    else timings[i].rejectWhenKnown = true;
+                }
+            };
+
+            DraftedJob ids = engine.submitWithDraft(request, "", onDraft, onFinal,
+                pass == 1 ? DraftMode::ALONGSIDE : DraftMode::AHEAD);
+            std::lock_guard<std::mutex> lock(timingsMutex);
+            timings[i].finalId = ids.finalId;
+            if (timings[i].rejectWhenKnown) {
+                engine.cancel(ids.finalId);
+            }
+        }
+
+        engine.waitUntilIdle();
+        engine.shutdown();
+
+        std::vector<double> firstPixel;
+        std::vector<double> finals;
+        int kept = 0;
+        for (int i = 0; i < options.jobs; i++) {
+            bool rejected = pass > 0 && static_cast<int>(i * options.rejectRate) != static_cast<int>((i + 1) * options.rejectRate);
+            if (timings[i].firstPixelMs >= 0) firstPixel.push_back(timings[i].firstPixelMs);
+            if (!rejected) {
+                kept++;
+                if (timings[i].finalMs >= 0) finals.push_back(timings[i].finalMs);
+            }
+        }
+        int firstPixelFailures = options.jobs - static_cast<int>(firstPixel.size());
+        failures += firstPixelFailures;
+
+        uint64_t submits = mock.getStats().submits - submitsBefore;
+        uint64_t fullRenders = pass == 0 ? submits : submits - static_cast<uint64_t>(options.jobs);
+        std::cout << "--- " << labels[pass] << ": " << fullRenders << " full renders submitted for " << kept << " kept images" << std::endl;
+        printSummary("first px", summarize(firstPixel, firstPixelFailures));
+        printSummary("final", summarize(finals, kept - static_cast<int>(finals.size())));
+    }
+
+    mock.printStats();
+    FalApi::setEndpoint("", "");
+    return failures == options.jobs * 3 ? 1 : 0;
+}
+
+int Benchmark::runCandidateBenchmark(const CandidateBenchOptions& options) {
+    MockFalServer mock(options.mock);
+    if (!mock.start(0)) {
+        return 1;
+    }
+    FalApi::setEndpoint(mock.getBaseUrl(), "mock-key");
+
+    int candidates = std::max(1, std::min(options.candidates, FalApi::MAX_IMAGES));
+    std::cout << "Candidate benchmark: " << options.prompts << " prompts x " << candidates << " candidates on "
+        << Backends::get(options.backend).name << ", concurrency " << options.concurrency << std::endl;
+
+    const char* labels[] = { "separate", "num_images" };
+    int failures = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        HttpClient http;
+        GenerationEngine engine(http, static_cast<size_t>(std::max(1, options.concurrency)));
+
+        std::mutex resultsMutex;
+        std::vector<int> imagesIn(options.prompts, 0);
+        std::vector<double> allInMs(options.prompts, -1);
+        MockFalServer::Stats before = mock.getStats();
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < options.prompts; i++) {
+            auto onComplete = [&, i](const GenerationResult& result) {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                if (result.success) {
+                    imagesIn[i] += static_cast<int>(result.images.size());
+                    if (imagesIn[i] >= candidates && allInMs[i] < 0) {
+                        allInMs[i] = msSince(start);
+                    }
+                }
+            };
+
+            GenerationRequest request;
+            request.prompt = std::string(labels[pass]) + " candidate benchmark " + std::to_string(i);
+            request.backend = options.backend;
+
+            if (pass == 1) {
+                request.numImages = candidates;
+                engine.submit(request, "", onComplete);
+                continue;
+            }
+
+            // Identical bodies would be one job; the suffix stands in for a different seed
+            for (int c = 0; c < candidates; c++) {
+                GenerationRequest single = request;
+                single.prompt += " #" + std::to_string(c + 1);
+                engine.submit(single, "", onComplete);
+            }
+        }
+
+        engine.waitUntilIdle();
+        double wallMs = msSince(start);
+        engine.shutdown();
+
+        std::vector<double> allIn;
+        int images = 0;
+        for (int i = 0; i < options.prompts; i++) {
+            images += imagesIn[i];
+            if (allInMs[i] >= 0) allIn.push_back(allInMs[i]);
+        }
+        int incomplete = options.prompts - static_cast<int>(allIn.size());
+        failures += incomplete;
+
+        MockFalServer::Stats after = mock.getStats();
+        uint64_t submits = after.submits - before.submits;
+        uint64_t polls = (after.resultRequests - before.resultRequests) + (after.statusRequests - before.statusRequests);
+        uint64_t downloads = after.downloads - before.downloads;
+        double perImage = images > 0 ? 1.0 / images : 0;
+
+        std::cout << "--- " << labels[pass] << ": " << images << " images in " << std::fixed << std::setprecision(1)
+            << wallMs / 1000.0 << " s from " << submits << " submissions, " << polls << " polls, " << downloads << " downloads"
+            << std::setprecision(2) << " (" << submits * perImage << " submissions, " << polls * perImage << " polls per image)"
+            << std::endl;
+        printSummary("all in", summarize(allIn, incomplete));
+    }
+
+    mock.printStats();
+    FalApi::setEndpoint("", "");
+    return failures == options.prompts * 2 ? 1 : 0;
+}
+
+int Benchmark::runMockServer(unsigned short port, const MockFalServer::Options& options) {
+    MockFalServer mock(options);
+    if (!mock.start(port)) {
+        return 1;
+    }
+
+    std::cout << "Point the client at it with FAL_QUEUE_URL=" << mock.getBaseUrl()
+        << " (any FAL_KEY). Press Enter to stop." << std::endl;
+    std::cin.get();
+
+    mock.printStats();
+    return 0;
+}
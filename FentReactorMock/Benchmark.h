@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include "GenerationTypes.h"
+#include "MockFalServer.h"
+
+// Headless benchmark modes, selected from the command line in main.cpp.
+// They never construct ImageGenerator, so no window is opened.
+namespace Benchmark {
+    // Times `requests` sequential GETs against `url`, once with a fresh handle per request
+    // (the old behaviour) and once through the pooled HttpClient, and prints per-request latency.
+    int runHttpBenchmark(const std::string& url, int requests, bool insecure);
+
+    // Decodes recorded-shape queue status bodies `iterations` times each, with a full
+    // nlohmann DOM (the old parser) and with FalApi::parseStatus, and prints ns per parse
+    int runStatusParseBenchmark(int iterations);
+
+    // Builds `prompts` submission bodies per backend and orientation with the json-tree
+    // builder and with the pre-serialized templates, checks they match byte for byte,
+    // and prints payloads per second for each
+    int runPayloadBenchmark(int prompts);
+
+    struct LoadTestOptions {
+        int jobs = 100;
+        int concurrency = 8;
+        bool blockingClient = false;    // One thread per slot doing submit/poll/download, like the old pipeline
+        int pollIntervalMs = 2000;      // Fixed poll interval for the blocking client
+        bool webhooks = false;          // Engine only: complete via a local webhook listener
+        bool service = false;           // Go through a local GenerationService over HTTP (POST + long-poll)
+        int serviceClients = 16;        // Service only: concurrent HTTP clients, each with one job at a time
+        std::string queueUrl;           // Existing queue to hit; empty starts an in-process mock
+        std::string keys;               // Mock only: keys in FAL_KEYS form ("a@4,b@4"); default one unlimited key
+        double deadlineMs = 0;          // Engine only: per-job deadline; 0 = engine default
+        MockFalServer::Options mock;
+    };
+
+    // Drives `jobs` generations through the client at the given concurrency and reports
+    // throughput and end-to-end latency percentiles
+    int runLoadTest(const LoadTestOptions& options);
+
+    // Replays a mixed workload through JobScheduler on a simulated clock - a 5,000-job
+    // batch manifest, a smaller batch client and a steady trickle of interactive jobs,
+    // with a global cap and a playground cap - once as the old single FIFO and once with
+    // fair queueing and priorities, and prints interactive wait times and per-client share
+    int runSchedulerSimulation(int batchJobs);
+
+    struct DraftBenchOptions {
+        int jobs = 20;
+        int concurrency = 8;
+        BackendId backend = BackendId::FLUX_LORA;   // Final renders; drafts always use schnell
+        double rejectRate = 0.3;        // Share of drafts the simulated user rejects (cancelling the final)
+        MockFalServer::Options mock;    // msPerMegapixelStep defaults to 95 here, so work scales with size and steps
+    };
+
+    // Runs the same prompts three ways against the mock queue - final only, draft
+    // alongside the final and draft ahead of it - and reports time to first pixel
+    // (first image of any quality), time to the final image, and how many full
+    // renders were paid for when some drafts are rejected
+    int runDraftBenchmark(const DraftBenchOptions& options);
+
+    struct CandidateBenchOptions {
+        int prompts = 10;
+        int candidates = 4;             // Images wanted per prompt (num_images for the batched run)
+        int concurrency = 8;
+        BackendId backend = BackendId::FLUX_LORA;
+        MockFalServer::Options mock;
+    };
+
+    // Gets `candidates` images for each prompt from the mock queue, once as that many
+    // single-image submissions and once as one num_images request per prompt, and
+    // reports the time until a prompt's last candidate is in plus the submissions,
+    // polls and downloads each image cost
+    int runCandidateBenchmark(const CandidateBenchOptions& options);
+
+    // Serves the mock queue until Enter is pressed
+    int runMockServer(unsigned short port, const MockFalServer::Options& options);
+}
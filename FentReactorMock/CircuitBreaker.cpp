@@ -0,0 +1,131 @@
+#include "CircuitBreaker.h"
+#include <algorithm>
+#include <iostream>
+#include "Backends.h"
+
+CircuitBreaker::CircuitBreaker(NowFunction nowFunction) :
+    now(std::move(nowFunction)) {
+}
+
+void CircuitBreaker::setOptions(const Options& breakerOptions) {
+    std::lock_guard<std::mutex> lock(mutex);
+    options = breakerOptions;
+}
+
+bool CircuitBreaker::allow(BackendId backend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Circuit& circuit = circuits[std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1)];
+    Clock::time_point current = now();
+
+    if (circuit.state == State::OPEN && current >= circuit.openUntil) {
+        circuit.state = State::HALF_OPEN;
+        circuit.trialInFlight = false;
+        std::cout << "Circuit for " << Backends::get(backend).name << " half-open, sending a trial request" << std::endl;
+    }
+
+    // A trial that never reported (cancelled, served from cache) shouldn't block the next one
+    if (circuit.state == State::HALF_OPEN && circuit.trialInFlight &&
+        std::chrono::duration<double, std::milli>(current - circuit.trialStartedAt).count() >= options.trialTimeoutMs) {
+        circuit.trialInFlight = false;
+    }
+
+    switch (circuit.state) {
+    case State::CLOSED:
+        return true;
+    case State::HALF_OPEN:
+        if (!circuit.trialInFlight) {
+            circuit.trialInFlight = true;
+            circuit.trialStartedAt = current;
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+
+    circuit.rejected++;
+    return false;
+}
+
+void CircuitBreaker::recordSuccess(BackendId backend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Circuit& circuit = circuits[std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1)];
+    if (circuit.state != State::CLOSED) {
+        std::cout << "Circuit for " << Backends::get(backend).name << " closed" << std::endl;
+    }
+    circuit.state = State::CLOSED;
+    circuit.consecutiveFailures = 0;
+    circuit.openMs = 0;
+    circuit.trialInFlight = false;
+}
+
+void CircuitBreaker::recordFailure(BackendId backend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Circuit& circuit = circuits[std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1)];
+    Clock::time_point current = now();
+    circuit.failures++;
+    circuit.consecutiveFailures++;
+
+    if (circuit.state == State::HALF_OPEN) {
+        // Trial failed: stay away for longer
+        open(circuit, std::min(options.maxOpenMs, circuit.openMs * 2.0), current);
+        std::cout << "Circuit for " << Backends::get(backend).name << " trial failed, open for "
+            << static_cast<int>(circuit.openMs) << " ms" << std::endl;
+    }
+    else if (circuit.state == State::CLOSED && circuit.consecutiveFailures >= options.failureThreshold) {
+        open(circuit, options.openMs, current);
+        std::cout << "Circuit for " << Backends::get(backend).name << " opened after " << circuit.consecutiveFailures
+            << " consecutive failures (" << static_cast<int>(circuit.openMs) << " ms)" << std::endl;
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::getState(BackendId backend) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return circuits[std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1)].state;
+}
+
+CircuitBreaker::Stats CircuitBreaker::getStats(BackendId backend) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Circuit& circuit = circuits[std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1)];
+
+    Stats stats;
+    stats.state = circuit.state;
+    stats.consecutiveFailures = circuit.consecutiveFailures;
+    stats.failures = circuit.failures;
+    stats.opens = circuit.opens;
+    stats.rejected = circuit.rejected;
+    if (circuit.state == State::OPEN) {
+        stats.openRemainingMs = std::max(0.0, std::chrono::duration<double, std::milli>(circuit.openUntil - now()).count());
+    }
+    return stats;
+}
+
+void CircuitBreaker::printStats() const {
+    for (size_t b = 0; b < BACKEND_COUNT; b++) {
+        BackendId backend = static_cast<BackendId>(b);
+        Stats stats = getStats(backend);
+        if (stats.failures == 0 && stats.rejected == 0) {
+            continue;
+        }
+        std::cout << "Circuit " << Backends::get(backend).name << ": " << stateName(stats.state) << ", "
+            << stats.failures << " failures, opened " << stats.opens << " times, "
+            << stats.rejected << " jobs failed fast or rerouted" << std::endl;
+    }
+}
+
+const char* CircuitBreaker::stateName(State state) {
+    switch (state) {
+    case State::OPEN: return "open";
+    case State::HALF_OPEN: return "half-open";
+    default: return "closed";
+    }
+}
+
+void CircuitBreaker::open(Circuit& circuit, double openMs, Clock::time_point current) {
+    circuit.state = State::OPEN;
+    circuit.openMs = std::max(openMs, options.openMs);
+    circuit.openUntil = current + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(circuit.openMs));
+    circuit.trialInFlight = false;
+    circuit.opens++;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "GenerationTypes.h"
+
+// Per-backend circuit breaker for the fal queue. After enough consecutive
+// transport failures (connect errors, timeouts, 5xx) a backend's circuit opens
+// and new jobs for it fail at once instead of each waiting out its own timeouts.
+// Once the open period has passed, one trial request is let through (half-open):
+// success closes the circuit, failure opens it again for twice as long.
+//
+// Thread-safe. Time comes from an injectable clock, like JobScheduler.
+class CircuitBreaker {
+public:
+    using Clock = std::chrono::steady_clock;
+    using NowFunction = std::function<Clock::time_point()>;
+
+    enum class State { CLOSED, OPEN, HALF_OPEN };
+
+    struct Options {
+        int failureThreshold = 5;       // Consecutive failures that open the circuit
+        double openMs = 5000.0;         // First open period; doubles on each failed trial
+        double maxOpenMs = 60000.0;
+        double trialTimeoutMs = 30000.0;    // A trial with no verdict by then frees its slot
+    };
+
+    struct Stats {
+        State state = State::CLOSED;
+        int consecutiveFailures = 0;
+        uint64_t failures = 0;
+        uint64_t opens = 0;
+        uint64_t rejected = 0;          // Jobs failed fast or rerouted while open
+        double openRemainingMs = 0;
+    };
+
+    explicit CircuitBreaker(NowFunction now = Clock::now);
+
+    void setOptions(const Options& options);
+
+    // Whether a new request may go to the backend now. In half-open, true for
+    // the one trial; false otherwise (counted as rejected).
+    bool allow(BackendId backend);
+
+    void recordSuccess(BackendId backend);
+    void recordFailure(BackendId backend);
+
+    State getState(BackendId backend) const;
+    Stats getStats(BackendId backend) const;
+    void printStats() const;
+
+    static const char* stateName(State state);
+
+private:
+    struct Circuit {
+        State state = State::CLOSED;
+        int consecutiveFailures = 0;
+        double openMs = 0;
+        Clock::time_point openUntil;
+        bool trialInFlight = false;
+        Clock::time_point trialStartedAt;
+
+        uint64_t failures = 0;
+        uint64_t opens = 0;
+        uint64_t rejected = 0;
+    };
+
+    static constexpr size_t BACKEND_COUNT = static_cast<size_t>(BackendId::COUNT);
+
+    NowFunction now;
+    Options options;
+    mutable std::mutex mutex;
+    std::array<Circuit, BACKEND_COUNT> circuits;
+
+    void open(Circuit& circuit, double openMs, Clock::time_point current);
+};
@@ -0,0 +1,340 @@
+#include "CredentialPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    std::string trim(const std::string& text) {
+        size_t start = text.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(start, end - start + 1);
+    }
+
+    double msUntil(CredentialPool::Clock::time_point when, CredentialPool::Clock::time_point now) {
+        return std::max(0.0, std::chrono::duration<double, std::milli>(when - now).count());
+    }
+}
+
+CredentialPool::CredentialPool() {
+}
+
+bool CredentialPool::load(const std::string& spec) {
+    std::vector<Key> loaded;
+    Clock::time_point now = Clock::now();
+
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        entry = trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        // key[@concurrency[/perMinute]] - fal keys never contain '@'
+        Key key;
+        size_t at = entry.find('@');
+        key.apiKey = trim(entry.substr(0, at));
+        if (at != std::string::npos) {
+            std::string limits = entry.substr(at + 1);
+            size_t slash = limits.find('/');
+            key.limit = static_cast<size_t>(std::strtoul(limits.substr(0, slash).c_str(), nullptr, 10));
+            if (slash != std::string::npos) {
+                key.submitsPerMinute = std::max(0.0, std::atof(limits.substr(slash + 1).c_str()));
+            }
+        }
+        if (key.apiKey.empty()) {
+            std::cout << "Ignoring empty key in credential list" << std::endl;
+            continue;
+        }
+
+        key.fingerprint = fingerprintOf(key.apiKey);
+        key.tokens = 1.0;
+        key.refilledAt = now;
+        key.loadedAt = now;
+        key.changedAt = now;
+        loaded.push_back(key);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    keys = std::move(loaded);
+    return !keys.empty();
+}
+
+bool CredentialPool::loadFromEnvironment() {
+    if (const char* list = std::getenv("FAL_KEYS")) {
+        if (load(list)) {
+            std::cout << "Loaded " << size() << " API keys from FAL_KEYS" << std::endl;
+            return true;
+        }
+    }
+
+    const char* single = std::getenv("FAL_KEY");
+    return load(single ? single : "");
+}
+
+bool CredentialPool::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return keys.empty();
+}
+
+size_t CredentialPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return keys.size();
+}
+
+bool CredentialPool::acquire(Lease& lease, Clock::duration& retryAfter) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    retryAfter = std::chrono::milliseconds(250);
+
+    int best = -1;
+    double bestLoad = 0;
+    double soonestMs = -1;
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        Key& key = keys[i];
+        refill(key, now);
+        relaxInferredLimit(key, now);
+
+        // Note when a blocked key frees up, for the retry hint
+        double waitMs = 0;
+        if (key.backoffUntil > now) {
+            waitMs = msUntil(key.backoffUntil, now);
+        }
+        else if (key.submitsPerMinute > 0 && key.tokens < 1.0) {
+            waitMs = (1.0 - key.tokens) * 60000.0 / key.submitsPerMinute;
+        }
+        if (waitMs > 0) {
+            soonestMs = soonestMs < 0 ? waitMs : std::min(soonestMs, waitMs);
+            continue;
+        }
+        if (key.limit > 0 && key.inFlight >= key.limit) {
+            continue;
+        }
+
+        // Share of the key's limit in use; unlimited keys compare by raw count
+        double load = key.limit > 0 ? static_cast<double>(key.inFlight) / key.limit : 0.0;
+        if (best < 0 || load < bestLoad || (load == bestLoad && key.inFlight < keys[best].inFlight)) {
+            best = static_cast<int>(i);
+            bestLoad = load;
+        }
+    }
+
+    if (best < 0) {
+        if (soonestMs >= 0) {
+            retryAfter = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(std::max(10.0, soonestMs)));
+        }
+        return false;
+    }
+
+    Key& key = keys[best];
+    if (key.submitsPerMinute > 0) {
+        key.tokens -= 1.0;
+    }
+    key.submits++;
+    lease = leaseLocked(static_cast<size_t>(best), now);
+    return true;
+}
+
+bool CredentialPool::attach(const std::string& fingerprint, Lease& lease) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (keys.empty()) {
+        return false;
+    }
+
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (keys[i].fingerprint == fingerprint) {
+            lease = leaseLocked(i, now);
+            return true;
+        }
+    }
+
+    // Key was removed since; the request may not be visible to the others
+    auto least = std::min_element(keys.begin(), keys.end(),
+        [](const Key& a, const Key& b) { return a.inFlight < b.inFlight; });
+    std::cout << "Key " << (fingerprint.empty() ? "(none)" : fingerprint) << " is no longer configured, using "
+        << least->fingerprint << std::endl;
+    lease = leaseLocked(static_cast<size_t>(least - keys.begin()), now);
+    return true;
+}
+
+bool CredentialPool::anyAuthorization(std::string& authorization) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (keys.empty()) {
+        return false;
+    }
+    authorization = "Authorization: Key " + keys.front().apiKey;
+    return true;
+}
+
+void CredentialPool::release(Lease& lease) {
+    if (!lease.valid()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t index = static_cast<size_t>(lease.index);
+        if (index < keys.size() && keys[index].fingerprint == lease.fingerprint && keys[index].inFlight > 0) {
+            accumulate(keys[index], Clock::now());
+            keys[index].inFlight--;
+        }
+    }
+    lease = Lease();
+}
+
+void CredentialPool::reportThrottled(const Lease& lease) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index = static_cast<size_t>(lease.index);
+    if (!lease.valid() || index >= keys.size()) {
+        return;
+    }
+
+    Key& key = keys[index];
+    Clock::time_point now = Clock::now();
+    key.throttled++;
+    key.lastRefusedAt = now;
+
+    // No limit was configured, but the account has one: cap at what it just refused
+    // (this request is still counted in inFlight)
+    if (key.limit == 0) {
+        key.limit = std::max<size_t>(1, key.inFlight - 1);
+        key.limitInferred = true;
+        std::cout << "Key " << key.fingerprint << " has no configured limit, capping it at " << key.limit << std::endl;
+    }
+
+    backOff(key, now);
+}
+
+void CredentialPool::reportPollThrottled(const Lease& lease) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index = static_cast<size_t>(lease.index);
+    if (!lease.valid() || index >= keys.size()) {
+        return;
+    }
+
+    Key& key = keys[index];
+    key.throttled++;
+    backOff(key, Clock::now());
+}
+
+void CredentialPool::reportAccepted(const Lease& lease) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t index = static_cast<size_t>(lease.index);
+    if (lease.valid() && index < keys.size()) {
+        keys[index].strikes = 0;
+    }
+}
+
+std::vector<CredentialPool::KeyStats> CredentialPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+
+    std::vector<KeyStats> stats;
+    for (const Key& key : keys) {
+        Key current = key;
+        accumulate(current, now);
+        double lifetime = std::chrono::duration<double>(now - current.loadedAt).count();
+
+        KeyStats entry;
+        entry.fingerprint = key.fingerprint;
+        entry.limit = key.limit;
+        entry.submitsPerMinute = key.submitsPerMinute;
+        entry.inFlight = key.inFlight;
+        entry.peakInFlight = key.peakInFlight;
+        entry.submits = key.submits;
+        entry.throttled = key.throttled;
+        entry.meanInFlight = lifetime > 0 ? current.inFlightSeconds / lifetime : 0;
+        entry.utilization = key.limit > 0 ? entry.meanInFlight / key.limit : 0;
+        entry.backoffMs = msUntil(key.backoffUntil, now);
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+void CredentialPool::printStats() const {
+    for (const KeyStats& key : getStats()) {
+        std::cout << std::fixed << std::setprecision(1) << "Key " << key.fingerprint << ": " << key.submits << " submits, "
+            << key.throttled << " throttled, " << key.inFlight << " in flight (peak " << key.peakInFlight;
+        if (key.limit > 0) {
+            std::cout << " of " << key.limit << "), utilization " << key.utilization * 100.0 << "%";
+        }
+        else {
+            std::cout << ", no limit), mean in flight " << key.meanInFlight;
+        }
+        std::cout << std::endl;
+    }
+}
+
+std::string CredentialPool::fingerprintOf(const std::string& apiKey) {
+    // Key ids are "<uuid>:<secret>"; show the start of the id, never the secret
+    std::string id = apiKey.substr(0, apiKey.find(':'));
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : apiKey) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+
+    std::ostringstream fingerprint;
+    fingerprint << id.substr(0, std::min<size_t>(8, id.size() / 2)) << "~" << std::hex << std::setw(8) << std::setfill('0') << hash;
+    return fingerprint.str();
+}
+
+void CredentialPool::accumulate(Key& key, Clock::time_point now) {
+    key.inFlightSeconds += key.inFlight * std::chrono::duration<double>(now - key.changedAt).count();
+    key.changedAt = now;
+}
+
+void CredentialPool::refill(Key& key, Clock::time_point now) {
+    if (key.submitsPerMinute <= 0) {
+        return;
+    }
+
+    // Holds at most one second's worth (and at least one) so an idle key can't burst past its rate
+    double seconds = std::chrono::duration<double>(now - key.refilledAt).count();
+    double capacity = std::max(1.0, key.submitsPerMinute / 60.0);
+    key.tokens = std::min(capacity, key.tokens + seconds * key.submitsPerMinute / 60.0);
+    key.refilledAt = now;
+}
+
+CredentialPool::Lease CredentialPool::leaseLocked(size_t index, Clock::time_point now) {
+    Key& key = keys[index];
+    accumulate(key, now);
+    key.inFlight++;
+    key.peakInFlight = std::max(key.peakInFlight, key.inFlight);
+
+    Lease lease;
+    lease.index = static_cast<int>(index);
+    lease.authorization = "Authorization: Key " + key.apiKey;
+    lease.fingerprint = key.fingerprint;
+    return lease;
+}
+
+void CredentialPool::backOff(Key& key, Clock::time_point now) {
+    // Other requests sent before the backoff started come back 429 too; one strike per burst
+    if (key.backoffUntil > now) {
+        return;
+    }
+    key.strikes = std::min(key.strikes + 1, 16);
+    double backoffMs = std::min(BACKOFF_MAX_MS, BACKOFF_BASE_MS * static_cast<double>(1 << (key.strikes - 1)));
+    key.backoffUntil = now + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(backoffMs));
+    std::cout << "Key " << key.fingerprint << " throttled (429), backing off " << static_cast<int>(backoffMs) << " ms" << std::endl;
+}
+
+void CredentialPool::relaxInferredLimit(Key& key, Clock::time_point now) {
+    // The cap was a guess from one burst; if the key hasn't refused a submit
+    // since, let it run unlimited again (the next 429 infers a fresh one)
+    if (!key.limitInferred || msUntil(now, key.lastRefusedAt) < INFERRED_LIMIT_QUIET_MS) {
+        return;
+    }
+    std::cout << "Key " << key.fingerprint << " has not been throttled for a while, lifting its inferred limit of "
+        << key.limit << std::endl;
+    key.limit = 0;
+    key.limitInferred = false;
+}
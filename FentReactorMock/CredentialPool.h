@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The fal API keys requests are sent with. Each key has its own concurrency
+// limit and submit rate budget, so throughput scales past one account's limits
+// by adding keys:
+//
+//   FAL_KEYS="key1@10,key2@10/120"     (key[@concurrency[/submits per minute]], 0 = unlimited)
+//   FAL_KEY="key"                      (single key, no limits - the old behaviour)
+//
+// A key without a configured limit is capped at its in-flight count the first
+// time it refuses a submit with 429. The inferred cap is lifted again once the
+// key has gone a while without refusing one, so a single burst can't shrink it
+// for the rest of the run.
+//
+// A job leases the least-loaded key when it is submitted and keeps it for its
+// polls and cancel; the lease is returned once the queue has the result. A key
+// answering 429 is backed off for a while and the job tries again later.
+// Thread-safe.
+class CredentialPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Lease {
+        int index = -1;
+        std::string authorization;  // "Authorization: Key ..." header line
+        std::string fingerprint;    // Stable id of the key, safe to log and journal
+
+        bool valid() const { return index >= 0; }
+    };
+
+    struct KeyStats {
+        std::string fingerprint;
+        size_t limit = 0;           // 0 = unlimited
+        double submitsPerMinute = 0;
+        size_t inFlight = 0;
+        size_t peakInFlight = 0;
+        uint64_t submits = 0;
+        uint64_t throttled = 0;     // 429 responses
+        double meanInFlight = 0;    // Time-weighted, since the key was loaded
+        double utilization = 0;     // meanInFlight / limit; 0 if unlimited
+        double backoffMs = 0;       // Left on the current backoff
+    };
+
+    CredentialPool();
+
+    // Replaces the keys with the ones in a FAL_KEYS-style spec; false if it has none
+    bool load(const std::string& spec);
+
+    // FAL_KEYS, falling back to FAL_KEY; false if neither is set
+    bool loadFromEnvironment();
+
+    bool empty() const;
+    size_t size() const;
+
+    // Leases the least-loaded key that has concurrency and rate budget left and
+    // isn't backed off. False if none can take a submit now; retryAfter is a
+    // hint for when one might.
+    bool acquire(Lease& lease, Clock::duration& retryAfter);
+
+    // Re-leases the key that submitted a journaled request, ignoring its limits
+    // (the request is already running on it). Falls back to the least-loaded key
+    // if that key is no longer configured.
+    bool attach(const std::string& fingerprint, Lease& lease);
+
+    // Any key's header, without leasing it - for one-off calls outside the engine
+    bool anyAuthorization(std::string& authorization) const;
+
+    void release(Lease& lease);
+
+    // The key refused a submit with 429: stop handing it out for a while
+    // (doubling per strike) and, if it has no configured limit, infer one
+    void reportThrottled(const Lease& lease);
+
+    // A status poll answered 429. Backs the key off like reportThrottled, but
+    // says nothing about its concurrency limit, so no cap is inferred.
+    void reportPollThrottled(const Lease& lease);
+
+    // The key was accepted again; clears its backoff
+    void reportAccepted(const Lease& lease);
+
+    std::vector<KeyStats> getStats() const;
+    void printStats() const;
+
+private:
+    struct Key {
+        std::string apiKey;
+        std::string fingerprint;
+        size_t limit = 0;
+        bool limitInferred = false;         // limit came from a 429, not the spec
+        Clock::time_point lastRefusedAt;    // Last submit 429
+        double submitsPerMinute = 0;
+
+        size_t inFlight = 0;
+        size_t peakInFlight = 0;
+        uint64_t submits = 0;
+        uint64_t throttled = 0;
+
+        // Token bucket for the submit rate
+        double tokens = 0;
+        Clock::time_point refilledAt;
+
+        // 429 backoff
+        int strikes = 0;
+        Clock::time_point backoffUntil;
+
+        // Integral of inFlight over time, for utilization
+        double inFlightSeconds = 0;
+        Clock::time_point loadedAt;
+        Clock::time_point changedAt;
+    };
+
+    static constexpr double BACKOFF_BASE_MS = 1000.0;
+    static constexpr double BACKOFF_MAX_MS = 60000.0;
+    static constexpr double INFERRED_LIMIT_QUIET_MS = 300000.0;    // Without a submit 429 before an inferred cap is lifted
+
+    mutable std::mutex mutex;
+    std::vector<Key> keys;
+
+    static std::string fingerprintOf(const std::string& apiKey);
+    static void accumulate(Key& key, Clock::time_point now);
+    static void refill(Key& key, Clock::time_point now);
+    static void backOff(Key& key, Clock::time_point now);
+    static void relaxInferredLimit(Key& key, Clock::time_point now);
+    Lease leaseLocked(size_t index, Clock::time_point now);
+};
@@ -0,0 +1,554 @@
+#include "FalApi.h"
+#include "Backends.h"
+#include "PayloadTemplate.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+    std::mutex endpointMutex;
+    std::string baseUrlOverride;
+    bool keysOverridden = false;
+
+    // Single pass over a requests/{id} body that pulls out only the fields we act on
+    // and skips everything else (logs, metrics, timings) without building a DOM.
+    // While a job is queued or running nothing is allocated unless a field we keep
+    // is too long for small-string storage. A completed response allocates what
+    // QueueStatus keeps: the imageUrls vector and a string per URL (CDN URLs are
+    // always past small-string length), plus the copy in imageUrl. That is once
+    // per job, not once per poll.
+    class StatusScanner {
+    private:
+        const char* pos;
+        const char* end;
+        FalApi::QueueStatus& out;
+        bool statusIsString = false;
+        bool statusNull = false;
+
+        static constexpr int MAX_DEPTH = 64;
+
+        void skipWhitespace() {
+            while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')) pos++;
+        }
+
+        bool consume(char c) {
+            skipWhitespace();
+            if (pos < end && *pos == c) {
+                pos++;
+                return true;
+            }
+            return false;
+        }
+
+        bool consumeLiteral(const char* literal) {
+            size_t length = std::strlen(literal);
+            if (static_cast<size_t>(end - pos) < length || std::memcmp(pos, literal, length) != 0) {
+                return false;
+            }
+            pos += length;
+            return true;
+        }
+
+        // Leaves [begin, stop) spanning the raw contents between the quotes
+        bool rawString(const char*& begin, const char*& stop, bool& escaped) {
+            if (!consume('"')) return false;
+            begin = pos;
+            escaped = false;
+            while (pos < end && *pos != '"') {
+                if (*pos == '\\') {
+                    escaped = true;
+                    pos++;
+                }
+                pos++;
+            }
+            if (pos >= end) return false;
+            stop = pos++;
+            return true;
+        }
+
+        static void appendUtf8(std::string& target, unsigned long code) {
+            if (code < 0x80) {
+                target += static_cast<char>(code);
+            }
+            else if (code < 0x800) {
+                target += static_cast<char>(0xC0 | (code >> 6));
+                target += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000) {
+                target += static_cast<char>(0xE0 | (code >> 12));
+                target += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                target += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else {
+                target += static_cast<char>(0xF0 | (code >> 18));
+                target += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                target += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                target += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        static bool hex4(const char* at, const char* stop, unsigned long& code) {
+            if (stop - at < 4) return false;
+            code = 0;
+            for (int i = 0; i < 4; i++) {
+                char c = at[i];
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= c - '0';
+                else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+                else return false;
+            }
+            return true;
+        }
+
+        static bool decode(const char* begin, const char* stop, bool escaped, std::string& target) {
+            if (!escaped) {
+                target.assign(begin, stop);
+                return true;
+            }
+
+            target.clear();
+            for (const char* c = begin; c < stop; c++) {
+                if (*c != '\\') {
+                    target += *c;
+                    continue;
+                }
+                if (++c >= stop) return false;
+                switch (*c) {
+                case '"': target += '"'; break;
+                case '\\': target += '\\'; break;
+                case '/': target += '/'; break;
+                case 'b': target += '\b'; break;
+                case 'f': target += '\f'; break;
+                case 'n': target += '\n'; break;
+                case 'r': target += '\r'; break;
+                case 't': target += '\t'; break;
+                case 'u': {
+                    unsigned long code = 0;
+                    if (!hex4(c + 1, stop, code)) return false;
+                    c += 4;
+                    // Surrogate pair
+                    unsigned long low = 0;
+                    if (code >= 0xD800 && code <= 0xDBFF && stop - c > 6 && c[1] == '\\' && c[2] == 'u' &&
+                        hex4(c + 3, stop, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        c += 6;
+                    }
+                    appendUtf8(target, code);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool keyIs(const char* begin, const char* stop, bool escaped, const char* name) {
+            size_t length = std::strlen(name);
+            return !escaped && static_cast<size_t>(stop - begin) == length && std::memcmp(begin, name, length) == 0;
+        }
+
+        bool readString(std::string& target) {
+            const char* begin;
+            const char* stop;
+            bool escaped;
+            return rawString(begin, stop, escaped) && decode(begin, stop, escaped, target);
+        }
+
+        bool readInt(int& value) {
+            skipWhitespace();
+            const char* start = pos;
+            bool negative = pos < end && *pos == '-';
+            if (negative) pos++;
+            long long number = 0;
+            while (pos < end && *pos >= '0' && *pos <= '9') {
+                number = std::min(number * 10 + (*pos - '0'), 1LL << 31);
+                pos++;
+            }
+            if (pos == start + (negative ? 1 : 0)) return false;
+            value = static_cast<int>(negative ? -number : std::min(number, 0x7FFFFFFFLL));
+            // A fractional or exponent part is skipped, not rejected
+            while (pos < end && (*pos == '.' || *pos == 'e' || *pos == 'E' || *pos == '+' || *pos == '-' ||
+                (*pos >= '0' && *pos <= '9'))) pos++;
+            return true;
+        }
+
+        bool skipValue(int depth) {
+            if (depth > MAX_DEPTH) return false;
+            skipWhitespace();
+            if (pos >= end) return false;
+
+            const char* begin;
+            const char* stop;
+            bool escaped;
+            switch (*pos) {
+            case '"':
+                return rawString(begin, stop, escaped);
+            case '{':
+                pos++;
+                if (consume('}')) return true;
+                do {
+                    if (!rawString(begin, stop, escaped) || !consume(':') || !skipValue(depth + 1)) return false;
+                } while (consume(','));
+                return consume('}');
+            case '[':
+                pos++;
+                if (consume(']')) return true;
+                do {
+                    if (!skipValue(depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            case 't':
+                return consumeLiteral("true");
+            case 'f':
+                return consumeLiteral("false");
+            case 'n':
+                return consumeLiteral("null");
+            default: {
+                int ignored;
+                return readInt(ignored);
+            }
+            }
+        }
+
+        // images: [{"url": ...}, ...] - every entry's url, in order
+        bool scanImages() {
+            skipWhitespace();
+            if (pos >= end || *pos != '[') return skipValue(1);
+            pos++;
+            if (consume(']')) return true;
+
+            do {
+                skipWhitespace();
+                if (pos >= end || *pos != '{') {
+                    if (!skipValue(2)) return false;
+                    continue;
+                }
+
+                // Decoded straight into its slot; dropped again if the entry has no url
+                pos++;
+                out.imageUrls.emplace_back();
+                std::string& url = out.imageUrls.back();
+                if (!consume('}')) {
+                    do {
+                        const char* begin;
+                        const char* stop;
+                        bool escaped;
+                        if (!rawString(begin, stop, escaped) || !consume(':')) return false;
+                        skipWhitespace();
+                        if (keyIs(begin, stop, escaped, "url") && pos < end && *pos == '"') {
+                            if (!readString(url)) return false;
+                        }
+                        else if (!skipValue(3)) {
+                            return false;
+                        }
+                    } while (consume(','));
+                    if (!consume('}')) return false;
+                }
+                if (url.empty()) {
+                    out.imageUrls.pop_back();
+                }
+            } while (consume(','));
+
+            if (!consume(']')) return false;
+            if (!out.imageUrls.empty()) {
+                out.imageUrl = out.imageUrls.front();
+            }
+            return true;
+        }
+
+    public:
+        StatusScanner(const std::string& body, FalApi::QueueStatus& result) :
+            pos(body.data()), end(body.data() + body.size()), out(result) {
+        }
+
+        const char* position() const { return pos; }
+
+        bool scan() {
+            if (!consume('{')) return false;
+
+            if (!consume('}')) {
+                do {
+                    const char* begin;
+                    const char* stop;
+                    bool escaped;
+                    if (!rawString(begin, stop, escaped) || !consume(':')) return false;
+                    skipWhitespace();
+                    bool isString = pos < end && *pos == '"';
+
+                    if (keyIs(begin, stop, escaped, "status")) {
+                        statusIsString = isString;
+                        if (isString) {
+                            if (!readString(out.status)) return false;
+                        }
+                        else if (consumeLiteral("null")) {
+                            statusNull = true;
+                        }
+                        else if (!skipValue(1)) {
+                            return false;
+                        }
+                    }
+                    else if (keyIs(begin, stop, escaped, "queue_position") && pos < end && *pos != 'n') {
+                        if (!readInt(out.queuePosition)) return false;
+                    }
+                    else if (keyIs(begin, stop, escaped, "images")) {
+                        if (!scanImages()) return false;
+                    }
+                    else if ((keyIs(begin, stop, escaped, "error") || keyIs(begin, stop, escaped, "detail")) && isString) {
+                        if (!readString(out.error)) return false;
+                    }
+                    else if (!skipValue(1)) {
+                        return false;
+                    }
+                } while (consume(','));
+
+                if (!consume('}')) return false;
+            }
+
+            skipWhitespace();
+            if (pos != end) return false;
+
+            // Same precedence as before: an image means done, whatever status says
+            if (!out.imageUrl.empty()) {
+                out.status = "COMPLETED";
+            }
+            else if (!statusIsString) {
+                // null while queued; no status at all means still processing
+                out.status = statusNull ? "QUEUED" : "PROCESSING";
+            }
+            return true;
+        }
+    };
+}
+
+std::string FalApi::queueBaseUrl() {
+    {
+        std::lock_guard<std::mutex> lock(endpointMutex);
+        if (!baseUrlOverride.empty()) {
+            return baseUrlOverride;
+        }
+    }
+
+    const char* envUrl = std::getenv("FAL_QUEUE_URL");
+    return envUrl ? envUrl : "https://queue.fal.run";
+}
+
+bool FalApi::isLocalQueue() {
+    std::string url = queueBaseUrl();
+    size_t scheme = url.find("://");
+    std::string host = url.substr(scheme == std::string::npos ? 0 : scheme + 3);
+    host = host.substr(0, host.find('/'));
+    if (!host.empty() && host[0] == '[') {
+        host = host.substr(0, host.find(']') + 1);
+    }
+    else {
+        host = host.substr(0, host.find(':'));
+    }
+    return host == "127.0.0.1" || host == "localhost" || host == "[::1]";
+}
+
+void FalApi::setEndpoint(const std::string& baseUrl, const std::string& apiKeys) {
+    CredentialPool& pool = credentials();
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    baseUrlOverride = baseUrl;
+    if (!apiKeys.empty()) {
+        pool.load(apiKeys);
+        keysOverridden = true;
+    }
+    else if (keysOverridden) {
+        pool.loadFromEnvironment();
+        keysOverridden = false;
+    }
+}
+
+CredentialPool& FalApi::credentials() {
+    // Keys are read once, not per request
+    static CredentialPool pool;
+    static std::once_flag loaded;
+    std::call_once(loaded, []() { pool.loadFromEnvironment(); });
+    return pool;
+}
+
+std::string FalApi::backendName(BackendId backend) {
+    return Backends::get(backend).name;
+}
+
+void FalApi::imageDimensions(OrientationMode orientation, int& width, int& height) {
+    if (orientation == OrientationMode::PORTRAIT) {
+        width = 1296; height = 2304; // 9:16
+    }
+    else {
+        width = 2304; height = 1296; // 16:9
+    }
+}
+
+void FalApi::draftDimensions(OrientationMode orientation, int& width, int& height) {
+    imageDimensions(orientation, width, height);
+    width /= DRAFT_DIVISOR;
+    height /= DRAFT_DIVISOR;
+}
+
+std::string FalApi::submitUrl(BackendId backend) {
+    return queueBaseUrl() + "/" + Backends::get(backend).submitPath;
+}
+
+std::string FalApi::resultUrl(BackendId backend, const std::string& requestId) {
+    return queueBaseUrl() + "/" + Backends::get(backend).requestsPath + "/requests/" + requestId;
+}
+
+std::string FalApi::cancelUrl(BackendId backend, const std::string& requestId) {
+    return resultUrl(backend, requestId) + "/cancel";
+}
+
+std::string FalApi::buildPayload(const std::string& prompt, const std::string& styleModifier,
+    BackendId backend, OrientationMode orientation, int numImages) {
+    // Resolution and per-backend fields are pre-serialized; only the prompt (and
+    // the candidate count) is filled in
+    return PayloadTemplates::get(backend, orientation).render(prompt, styleModifier, std::max(1, std::min(numImages, MAX_IMAGES)));
+}
+
+std::string FalApi::buildDraftPayload(const std::string& prompt, const std::string& styleModifier,
+    BackendId backend, OrientationMode orientation) {
+    // Rare next to full renders, so built directly rather than from a template
+    const BackendSchema& schema = Backends::get(backend).schema;
+    int width, height;
+    draftDimensions(orientation, width, height);
+
+    json payload = {
+        {"prompt", prompt + styleModifier},
+        {"image_size", {{"width", width}, {"height", height}}},
+        {"num_inference_steps", std::max(1, std::min(DRAFT_STEPS, schema.steps))},
+        {"guidance_scale", schema.guidance},
+        {"num_images", 1},
+        {schema.formatKey, "jpeg"}
+    };
+    if (schema.safetyChecker) {
+        payload["enable_safety_checker"] = true;
+    }
+    return payload.dump();
+}
+
+bool FalApi::authHeaders(std::vector<std::string>& headers, bool jsonBody) {
+    std::string authorization;
+    if (!credentials().anyAuthorization(authorization)) {
+        return false;
+    }
+
+    if (jsonBody) {
+        headers.push_back("Content-Type: application/json");
+    }
+    headers.push_back(authorization);
+    return true;
+}
+
+void FalApi::authHeaders(std::vector<std::string>& headers, bool jsonBody, const CredentialPool::Lease& lease) {
+    if (jsonBody) {
+        headers.push_back("Content-Type: application/json");
+    }
+    headers.push_back(lease.authorization);
+}
+
+std::string FalApi::parseRequestId(const std::string& response) {
+    try {
+        json responseJson = json::parse(response);
+        if (responseJson.contains("request_id")) {
+            return responseJson["request_id"];
+        }
+    }
+    catch (const std::exception& e) {
+        std::cout << "Error parsing API response: " << e.what() << std::endl;
+        std::cout << "Response: " << response << std::endl;
+    }
+
+    return "";
+}
+
+FalApi::QueueStatus FalApi::parseStatus(const std::string& response) {
+    QueueStatus result;
+
+    StatusScanner scanner(response, result);
+    if (scanner.scan()) {
+        result.parsed = true;
+        return result;
+    }
+
+    size_t offset = static_cast<size_t>(scanner.position() - response.data());
+    result = QueueStatus();
+    std::cout << "Error parsing status at byte " << offset << std::endl;
+    std::cout << "Raw response: '" << response << "'" << std::endl;
+
+    // If we can't parse the response, it might be an HTTP error
+    if (response.find("404") != std::string::npos ||
+        response.find("Not Found") != std::string::npos) {
+        result.notFound = true;
+    }
+
+    return result;
+}
+
+bool FalApi::parseWebhook(const std::string& body, WebhookEvent& event) {
+    try {
+        json webhookJson = json::parse(body);
+        if (!webhookJson.contains("request_id") || !webhookJson["request_id"].is_string()) {
+            return false;
+        }
+
+        event.requestId = webhookJson["request_id"];
+        event.status.parsed = true;
+
+        std::string status = webhookJson.value("status", "");
+        if (status == "OK" && webhookJson.contains("payload") && webhookJson["payload"].is_object()) {
+            const json& payload = webhookJson["payload"];
+            if (payload.contains("images") && payload["images"].is_array()) {
+                for (const json& image : payload["images"]) {
+                    if (image.is_object() && image.contains("url") && image["url"].is_string()) {
+                        event.status.imageUrls.push_back(image["url"]);
+                    }
+                }
+            }
+            if (!event.status.imageUrls.empty()) {
+                event.status.imageUrl = event.status.imageUrls.front();
+                event.status.status = "COMPLETED";
+                return true;
+            }
+        }
+
+        // Error status, or OK without any image
+        event.status.status = "FAILED";
+        if (webhookJson.contains("error") && webhookJson["error"].is_string()) {
+            event.error = webhookJson["error"];
+        }
+        else {
+            event.error = "Webhook reported no image";
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Error parsing webhook: " << e.what() << std::endl;
+    }
+
+    return false;
+}
+
+std::string FalApi::urlEncode(const std::string& text) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string encoded;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded += static_cast<char>(c);
+        }
+        else {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 0x0F];
+        }
+    }
+    return encoded;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CredentialPool.h"
+#include "GenerationTypes.h"
+
+// Request building and response parsing for the fal.ai queue API.
+// Shared by the synchronous ImageGenerator calls and the async GenerationEngine.
+namespace FalApi {
+    // Parsed form of a requests/{id} response
+    struct QueueStatus {
+        std::string status;     // QUEUED, IN_PROGRESS, COMPLETED, FAILED, PROCESSING, ...
+        std::string imageUrl;   // Set once the result is available (the first of imageUrls)
+        std::vector<std::string> imageUrls;     // Every image the request returned, in order
+        std::string error;      // "error" or "detail" message, if any
+        int queuePosition = -1; // While IN_QUEUE, when reported
+        bool parsed = false;
+        bool notFound = false;  // Endpoint returned a 404 page
+    };
+
+    // Short backend name ("flux-1/schnell", "playground-v25", "flux-lora", "offline")
+    std::string backendName(BackendId backend);
+
+    // Output resolution for an orientation
+    void imageDimensions(OrientationMode orientation, int& width, int& height);
+
+    // Draft previews: a third of the output size on each side (432x768 / 768x432)
+    // at DRAFT_STEPS, so they land in a fraction of the full render's time
+    constexpr int DRAFT_DIVISOR = 3;
+    constexpr int DRAFT_STEPS = 2;
+    void draftDimensions(OrientationMode orientation, int& width, int& height);
+
+    // Remote drafts always go to flux-1/schnell, whatever the final render uses
+    constexpr BackendId DRAFT_BACKEND = BackendId::FLUX_SCHNELL;
+
+    // Body fal POSTs to fal_webhook when a queued request finishes
+    struct WebhookEvent {
+        std::string requestId;
+        QueueStatus status;     // COMPLETED with imageUrls, or FAILED
+        std::string error;
+    };
+
+    // Queue host: FAL_QUEUE_URL if set, otherwise https://queue.fal.run
+    std::string queueBaseUrl();
+
+    // Whether the queue is on this machine (the mock server), so it can reach a loopback webhook
+    bool isLocalQueue();
+
+    // Points all traffic at another queue (the local mock server) with the given key(s),
+    // in FAL_KEYS form. Call before any jobs start; empty arguments restore the defaults.
+    void setEndpoint(const std::string& baseUrl, const std::string& apiKeys);
+
+    // Process-wide key pool, loaded from FAL_KEYS / FAL_KEY on first use
+    CredentialPool& credentials();
+
+    // Queue URLs, built from the backend's registry entry
+    std::string submitUrl(BackendId backend);
+    std::string resultUrl(BackendId backend, const std::string& requestId);
+    std::string cancelUrl(BackendId backend, const std::string& requestId);     // PUT
+
+    // Candidates one request may ask for (num_images); fal's models cap it at 4
+    constexpr int MAX_IMAGES = 4;
+
+    // JSON body for a submission - HIGH RESOLUTION, sized by orientation, asking
+    // for numImages candidates (clamped to 1..MAX_IMAGES)
+    std::string buildPayload(const std::string& prompt, const std::string& styleModifier,
+        BackendId backend, OrientationMode orientation, int numImages = 1);
+
+    // JSON body for a draft preview on backend: draft size and steps, otherwise the
+    // backend's fields. Always a single image.
+    std::string buildDraftPayload(const std::string& prompt, const std::string& styleModifier,
+        BackendId backend, OrientationMode orientation);
+
+    // Authorization (and optionally Content-Type) headers with any configured key,
+    // for one-off calls; false if no key is set. Jobs use a leased key instead.
+    bool authHeaders(std::vector<std::string>& headers, bool jsonBody);
+    void authHeaders(std::vector<std::string>& headers, bool jsonBody, const CredentialPool::Lease& lease);
+
+    // Extracts request_id from a submission response, empty on failure
+    std::string parseRequestId(const std::string& response);
+
+    QueueStatus parseStatus(const std::string& response);
+
+    bool parseWebhook(const std::string& body, WebhookEvent& event);
+
+    std::string urlEncode(const std::string& text);
+}
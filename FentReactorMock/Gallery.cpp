@@ -0,0 +1,149 @@
+#include "Gallery.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+bool Gallery::load(std::vector<SavedImage>& images, std::string& error) {
+    images.clear();
+
+    std::ifstream file(METADATA_PATH);
+    if (!file.is_open()) {
+        error = "No saved images metadata found";
+        return false;
+    }
+
+    try {
+        json j;
+        file >> j;
+
+        for (const auto& item : j["saved_images"]) {
+            SavedImage img;
+            img.filename = item["filename"];
+            img.prompt = item["prompt"];
+            img.category = item["category"];
+            img.style = item["style"];
+            img.timestamp = item["timestamp"];
+            img.isLandscape = item["isLandscape"];
+            img.sweepId = item.value("sweep", "");
+
+            // Verify file still exists
+            if (std::filesystem::exists(img.filename)) {
+                images.push_back(img);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        images.clear();
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+bool Gallery::save(const std::vector<SavedImage>& images) {
+    std::error_code ec;
+    std::filesystem::create_directories(ROOT, ec);
+
+    json j;
+    j["saved_images"] = json::array();
+
+    for (const auto& img : images) {
+        json imgJson;
+        imgJson["filename"] = img.filename;
+        imgJson["prompt"] = img.prompt;
+        imgJson["category"] = img.category;
+        imgJson["style"] = img.style;
+        imgJson["timestamp"] = img.timestamp;
+        imgJson["isLandscape"] = img.isLandscape;
+        if (!img.sweepId.empty()) {
+            imgJson["sweep"] = img.sweepId;
+        }
+        j["saved_images"].push_back(imgJson);
+    }
+
+    // Written under a temp name and renamed over the old file, so a reader in
+    // another process (GUI and --sweep) never sees it half written. The name is
+    // per writer so two of them don't write into each other's temp file.
+    std::string tempPath = std::string(METADATA_PATH) + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream file(tempPath);
+        file << j.dump(4);
+        if (!file) {
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, METADATA_PATH, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool Gallery::append(const std::vector<SavedImage>& images, std::vector<SavedImage>* merged) {
+    std::vector<SavedImage> existing;
+    std::string error;
+    if (!load(existing, error) && std::filesystem::exists(METADATA_PATH)) {
+        return false;   // Unreadable: rewriting it would lose every entry in it
+    }
+
+    for (const SavedImage& img : images) {
+        bool known = std::any_of(existing.begin(), existing.end(),
+            [&img](const SavedImage& entry) { return entry.filename == img.filename; });
+        if (!known) {
+            existing.push_back(img);
+        }
+    }
+
+    if (!save(existing)) {
+        return false;
+    }
+    if (merged) {
+        *merged = std::move(existing);
+    }
+    return true;
+}
+
+std::string Gallery::timestamp() {
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    auto tm = *std::localtime(&time_t);
+
+    std::stringstream ss;
+    ss << std::put_time(&tm, "%Y-%m-%d_%H-%M-%S");
+    return ss.str();
+}
+
+std::vector<std::string> Gallery::sweepIds(const std::vector<SavedImage>& images) {
+    // Newest image of each sweep decides its place
+    std::vector<std::pair<std::string, std::string>> newest; // timestamp, sweep id
+    for (const SavedImage& img : images) {
+        if (img.sweepId.empty()) continue;
+        auto it = std::find_if(newest.begin(), newest.end(),
+            [&img](const std::pair<std::string, std::string>& entry) { return entry.second == img.sweepId; });
+        if (it == newest.end()) {
+            newest.emplace_back(img.timestamp, img.sweepId);
+        }
+        else if (img.timestamp > it->first) {
+            it->first = img.timestamp;
+        }
+    }
+
+    std::sort(newest.begin(), newest.end(), std::greater<>());
+    std::vector<std::string> ids;
+    for (const auto& entry : newest) {
+        ids.push_back(entry.second);
+    }
+    return ids;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Saved image metadata (saved/saved_images.json)
+struct SavedImage {
+    std::string filename;
+    std::string prompt;
+    std::string category;
+    std::string style;
+    std::string timestamp;
+    bool isLandscape = false;
+    std::string sweepId;        // Set on images written by a sweep; they show on its contact sheet
+
+    // Constructor
+    SavedImage() = default;
+    SavedImage(const std::string& fname, const std::string& p, const std::string& cat,
+        const std::string& st, const std::string& ts, bool landscape)
+        : filename(fname), prompt(p), category(cat), style(st), timestamp(ts), isLandscape(landscape) {}
+};
+
+// The saved image gallery on disk, shared by the UI and headless sweeps
+namespace Gallery {
+    // Images live in saved/portrait and saved/landscape
+    constexpr const char* ROOT = "saved";
+    constexpr const char* METADATA_PATH = "saved/saved_images.json";
+
+    // Reads the metadata file, skipping entries whose image is gone. False if the
+    // file is missing or unreadable (error says which); images is left empty.
+    bool load(std::vector<SavedImage>& images, std::string& error);
+
+    // Rewrites the metadata file with images (atomically: temp file, then rename)
+    bool save(const std::vector<SavedImage>& images);
+
+    // Adds images to what is on disk now, so entries another process wrote since
+    // it was last read are kept. Entries whose image file was deleted drop out,
+    // which is how removals are recorded. merged, if given, receives the result.
+    // False without writing anything if the file exists but can't be read.
+    bool append(const std::vector<SavedImage>& images, std::vector<SavedImage>* merged = nullptr);
+
+    // Local time as "2025-08-03_16-23-05"; sorts chronologically
+    std::string timestamp();
+
+    // Distinct sweep ids, newest first
+    std::vector<std::string> sweepIds(const std::vector<SavedImage>& images);
+}
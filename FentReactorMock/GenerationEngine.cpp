@@ -0,0 +1,1446 @@
+#include "GenerationEngine.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+    // Body of a fire-and-forget request nobody reads
+    size_t DiscardCallback(void*, size_t size, size_t nmemb, void*) {
+        return size * nmemb;
+    }
+
+    // Where candidate `index` of a multi-image job is written: the output file
+    // itself for the first, name_2.jpg, name_3.jpg, ... for the rest
+    std::string candidateFile(const std::string& outputFile, size_t index) {
+        if (index == 0) {
+            return outputFile;
+        }
+        size_t dot = outputFile.find_last_of('.');
+        size_t slash = outputFile.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            dot = outputFile.size();
+        }
+        return outputFile.substr(0, dot) + "_" + std::to_string(index + 1) + outputFile.substr(dot);
+    }
+
+    // Cache key of one candidate; the first shares the job's key, so single-image
+    // entries are where they always were
+    std::string candidateKey(const std::string& cacheKey, size_t index) {
+        return index == 0 ? cacheKey : ResultCache::makeKey(cacheKey, std::to_string(index));
+    }
+}
+
+GenerationEngine::GenerationEngine(HttpClient& httpClient, size_t maxConcurrent) :
+    http(httpClient),
+    multi(curl_multi_init()),
+    running(true),
+    nextJobId(1),
+    activeCount(0),
+    cancelsPending(0),
+    cancelledJobs(0),
+    webhookFallbackMs(0),
+    webhookCompletions(0),
+    pollingFallbacks(0),
+    rerouteOnOpenCircuit(false),
+    deadlineFailures(0) {
+
+    scheduler.setGlobalLimit(maxConcurrent);
+    if (const char* limits = std::getenv("FAL_BACKEND_LIMITS")) {
+        scheduler.applyBackendLimits(limits);
+    }
+    if (const char* weights = std::getenv("FAL_CLIENT_WEIGHTS")) {
+        scheduler.applyClientWeights(weights);
+    }
+    if (const char* reroute = std::getenv("FAL_REROUTE")) {
+        rerouteOnOpenCircuit = std::string(reroute) == "1";
+    }
+    if (const char* target = std::getenv("FAL_LATENCY_TARGET_MS")) {
+        BackendRouter::Options routing = router.getOptions();
+        routing.targetMs = std::max(1.0, std::atof(target));
+        router.setOptions(routing);
+    }
+    if (const char* pins = std::getenv("FAL_ROUTE_PINS")) {
+        router.applyPins(pins);
+    }
+
+    ioThread = std::thread(&GenerationEngine::ioLoop, this);
+}
+
+GenerationEngine::~GenerationEngine() {
+    shutdown();
+}
+
+void GenerationEngine::shutdown() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    curl_multi_wakeup(multi);
+    if (ioThread.joinable()) {
+        ioThread.join();
+    }
+
+    // Drop whatever is left without firing callbacks - the owner is going away
+    for (auto& entry : activeJobs) {
+        Job& job = *entry.second;
+        finishTransfer(job);
+        releaseCredential(job);
+    }
+    activeJobs.clear();
+
+    while (!cancelTransfers.empty()) {
+        finishCancelTransfer(cancelTransfers.begin()->first);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingJobs.clear();
+        heldJobs.clear();
+        scheduler.clear();
+        jobPhases.clear();
+        activeCount = 0;
+    }
+    idleCondition.notify_all();
+
+    curl_multi_cleanup(multi);
+    multi = nullptr;
+}
+
+uint64_t GenerationEngine::submit(const GenerationRequest& request, const std::string& outputFile, CompletionCallback onComplete) {
+    std::unique_ptr<Job> job = makeJob(request, outputFile, std::move(onComplete));
+    uint64_t id = job->id;
+    enqueue(std::move(job));
+    return id;
+}
+
+std::unique_ptr<GenerationEngine::Job> GenerationEngine::makeJob(const GenerationRequest& request,
+    const std::string& outputFile, CompletionCallback onComplete) {
+    auto job = std::make_unique<Job>();
+    job->engine = this;
+    job->id = nextJobId++;
+    job->request = request;
+    job->outputFile = outputFile;
+    job->onComplete = std::move(onComplete);
+    job->createdAt = Clock::now();
+    job->request.numImages = request.draft ? 1 : std::max(1, std::min(request.numImages, FalApi::MAX_IMAGES));
+    job->result.jobId = job->id;
+    job->result.draft = request.draft;
+
+    double deadlineMs = request.deadlineMs > 0 ? request.deadlineMs : DEFAULT_DEADLINE_MS;
+    job->deadline = job->createdAt + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(deadlineMs));
+    return job;
+}
+
+DraftedJob GenerationEngine::submitWithDraft(const GenerationRequest& request, const std::string& outputFile,
+    CompletionCallback onDraft, CompletionCallback onFinal, DraftMode mode) {
+    GenerationRequest draftRequest = request;
+    draftRequest.draft = true;
+    if (Backends::get(request.backend).isRemote()) {
+        draftRequest.backend = FalApi::DRAFT_BACKEND;
+    }
+
+    std::unique_ptr<Job> finalJob = makeJob(request, outputFile, std::move(onFinal));
+    DraftedJob ids;
+    ids.finalId = finalJob->id;
+
+    if (mode == DraftMode::ALONGSIDE) {
+        // Draft first, so with one free slot the preview still wins
+        ids.draftId = submit(draftRequest, "", std::move(onDraft));
+        enqueue(std::move(finalJob));
+        return ids;
+    }
+
+    // Park the final until the draft has finished, whichever way it finishes
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobPhases[ids.finalId] = JobPhase::PENDING;
+        heldJobs[ids.finalId] = std::move(finalJob);
+    }
+
+    uint64_t finalId = ids.finalId;
+    ids.draftId = submit(draftRequest, "", [this, finalId, onDraft = std::move(onDraft)](const GenerationResult& result) {
+        if (onDraft) {
+            onDraft(result);
+        }
+        releaseHeld(finalId);
+    });
+    return ids;
+}
+
+void GenerationEngine::releaseHeld(uint64_t jobId) {
+    std::unique_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto held = heldJobs.find(jobId);
+        if (held == heldJobs.end()) {
+            return;     // Rejected (cancelled) while the draft was running
+        }
+        job = std::move(held->second);
+        heldJobs.erase(held);
+    }
+
+    // Its deadline runs from the original request, draft time included
+    enqueue(std::move(job));
+}
+
+uint64_t GenerationEngine::resume(const JobJournal::Entry& entry, const std::string& outputFile, CompletionCallback onComplete) {
+    auto job = std::make_unique<Job>();
+    job->engine = this;
+    job->id = nextJobId++;
+    job->request.prompt = entry.prompt;
+    job->request.styleModifier = entry.styleModifier;
+    job->request.orientation = entry.orientation == "landscape" ? OrientationMode::LANDSCAPE : OrientationMode::PORTRAIT;
+    job->request.numImages = std::max(1, std::min(entry.numImages, FalApi::MAX_IMAGES));
+    if (!Backends::fromName(entry.backend, job->request.backend)) {
+        std::cout << "Journal entry " << entry.requestId << " has unknown backend " << entry.backend << std::endl;
+    }
+    job->outputFile = outputFile;
+    job->onComplete = std::move(onComplete);
+    job->createdAt = Clock::now();
+    job->requestId = entry.requestId;
+    job->credential.fingerprint = entry.credential;
+    job->resumed = true;
+    job->result.jobId = job->id;
+    job->result.requestId = entry.requestId;
+    job->deadline = job->createdAt + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(DEFAULT_DEADLINE_MS));
+
+    uint64_t id = job->id;
+    enqueue(std::move(job));
+    return id;
+}
+
+void GenerationEngine::enqueue(std::unique_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t id = job->id;
+        jobPhases[id] = JobPhase::PENDING;
+        job->slotBackend = job->request.backend;
+        scheduler.enqueue(id, job->request.client, job->request.priority, job->request.backend);
+        pendingJobs[id] = std::move(job);
+    }
+
+    curl_multi_wakeup(multi);
+}
+
+void GenerationEngine::releaseSlot(const Job& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scheduler.release(job.slotBackend);
+        activeCount--;
+    }
+    idleCondition.notify_all();
+}
+
+void GenerationEngine::cancel(uint64_t jobId) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelRequests.insert(jobId);
+        cancelsPending = cancelRequests.size();
+    }
+    curl_multi_wakeup(multi);
+}
+
+bool GenerationEngine::isCancelRequested(uint64_t jobId) {
+    if (cancelsPending == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return cancelRequests.count(jobId) > 0;
+}
+
+int GenerationEngine::ProgressCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    // Abort mid-transfer rather than waiting for the response; processCancellations()
+    // does the rest. A job with followers keeps its transfer for them.
+    Job* job = static_cast<Job*>(clientp);
+    return job->followers.empty() && job->engine->isCancelRequested(job->id) ? 1 : 0;
+}
+
+void GenerationEngine::setMaxConcurrentJobs(size_t maxConcurrent) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scheduler.setGlobalLimit(maxConcurrent);
+    }
+    curl_multi_wakeup(multi);
+}
+
+size_t GenerationEngine::getMaxConcurrentJobs() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return scheduler.getGlobalLimit();
+}
+
+void GenerationEngine::setBackendLimit(BackendId backend, size_t limit) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scheduler.setBackendLimit(backend, limit);
+    }
+    curl_multi_wakeup(multi);
+}
+
+void GenerationEngine::setClientWeight(const std::string& client, double weight) {
+    std::lock_guard<std::mutex> lock(mutex);
+    scheduler.setClientWeight(client, weight);
+}
+
+JobScheduler::Stats GenerationEngine::getSchedulerStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return scheduler.getStats();
+}
+
+void GenerationEngine::printSchedulerStats() const {
+    JobScheduler::Stats stats = getSchedulerStats();
+    const char* classNames[] = { "interactive", "batch" };
+
+    std::cout << "Scheduler: " << stats.running << " running" << std::endl;
+    for (size_t i = 0; i < stats.classes.size(); i++) {
+        const JobScheduler::ClassStats& cls = stats.classes[i];
+        std::cout << "  " << classNames[i] << ": " << cls.queued << " queued (oldest " << static_cast<int>(cls.oldestWaitMs)
+            << " ms), " << cls.started << " started, wait mean " << static_cast<int>(cls.meanWaitMs)
+            << " ms, max " << static_cast<int>(cls.maxWaitMs) << " ms" << std::endl;
+    }
+    for (const auto& entry : stats.queuedByClient) {
+        std::cout << "  client " << (entry.first.empty() ? "(default)" : entry.first) << ": " << entry.second << " queued" << std::endl;
+    }
+}
+
+size_t GenerationEngine::pendingJobCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingJobs.size();
+}
+
+void GenerationEngine::setWebhookMode(const std::string& url, double fallbackMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    webhookUrl = url;
+    webhookFallbackMs = fallbackMs;
+}
+
+bool GenerationEngine::isWebhookMode() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !webhookUrl.empty();
+}
+
+void GenerationEngine::setRerouteOnOpenCircuit(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rerouteOnOpenCircuit = enabled;
+}
+
+void GenerationEngine::deliverWebhook(const FalApi::WebhookEvent& event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        incomingWebhooks.push_back(event);
+    }
+    curl_multi_wakeup(multi);
+}
+
+void GenerationEngine::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this]() {
+        return !running || (pendingJobs.empty() && heldJobs.empty() && activeCount == 0);
+    });
+}
+
+void GenerationEngine::ioLoop() {
+    while (running) {
+        int stillRunning = 0;
+        curl_multi_perform(multi, &stillRunning);
+
+        // Before completions, so a transfer aborted for a cancel isn't reported as a failure
+        processCancellations();
+        processCompletedTransfers();
+        processWebhooks();
+
+        // Fill slots freed by finished jobs and start due polls before sleeping,
+        // so newly added transfers are picked up by the wait below
+        expirePendingJobs();
+        admitPendingJobs();
+        startDuePolls();
+
+        // Sleep until a socket is ready, a poll is due, or submit() wakes us
+        curl_multi_poll(multi, nullptr, 0, nextWakeupMs(), nullptr);
+    }
+}
+
+void GenerationEngine::admitPendingJobs() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t id = 0;
+            if (!scheduler.next(id)) {
+                return;
+            }
+            auto pending = pendingJobs.find(id);
+            job = std::move(pending->second);
+            pendingJobs.erase(pending);
+            activeCount++;
+        }
+
+        Job& ref = *job;
+        activeJobs[ref.id] = std::move(job);
+
+        if (failIfExpired(ref)) {
+            continue;
+        }
+
+        // Don't send new work into a backend that is failing; resumed jobs are
+        // already on it and only need polls
+        if (!ref.resumed && Backends::get(ref.request.backend).isRemote() && !breaker.allow(ref.request.backend)) {
+            if (!rerouteAround(ref)) {
+                completeJob(ref, false, std::string(Backends::get(ref.request.backend).name) + " unavailable (circuit open)");
+                continue;
+            }
+        }
+
+        const BackendOps& backend = Backends::get(ref.request.backend);
+        ref.payload = ref.request.draft
+            ? FalApi::buildDraftPayload(ref.request.prompt, ref.request.styleModifier, ref.request.backend, ref.request.orientation)
+            : FalApi::buildPayload(ref.request.prompt, ref.request.styleModifier, ref.request.backend, ref.request.orientation,
+                ref.request.numImages);
+        ref.cacheKey = ResultCache::makeKey(backend.name, ref.payload);
+
+        if (ref.resumed) {
+            resumePolling(ref);
+        }
+        else if (!backend.isRemote()) {
+            runLocal(ref, backend);
+        }
+        else if (!resolveFromCache(ref)) {
+            startSubmit(ref);
+        }
+    }
+}
+
+void GenerationEngine::expirePendingJobs() {
+    Clock::time_point now = Clock::now();
+    if (now < nextExpirySweep) {
+        return;
+    }
+    nextExpirySweep = now + std::chrono::milliseconds(EXPIRY_SWEEP_MS);
+
+    // A job stuck behind a full scheduler shouldn't outlive its deadline just
+    // because it never got a slot
+    std::vector<std::unique_ptr<Job>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = pendingJobs.begin(); it != pendingJobs.end();) {
+            if (it->second->deadline <= now && scheduler.remove(it->first)) {
+                expired.push_back(std::move(it->second));
+                it = pendingJobs.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto& job : expired) {
+        std::cout << "Job " << job->id << " failed: Deadline exceeded (queued)" << std::endl;
+        deadlineFailures++;
+        setPhase(*job, JobPhase::FAILED);
+        job->result.error = "Deadline exceeded";
+        job->result.totalMs = elapsedMs(*job);
+        if (job->onComplete) {
+            job->onComplete(job->result);
+        }
+    }
+    if (!expired.empty()) {
+        idleCondition.notify_all();
+    }
+}
+
+bool GenerationEngine::rerouteAround(Job& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!rerouteOnOpenCircuit) {
+            return false;
+        }
+    }
+
+    // First remote backend that will take it, in BackendId order
+    for (size_t b = 0; b < static_cast<size_t>(BackendId::COUNT); b++) {
+        BackendId candidate = static_cast<BackendId>(b);
+        if (candidate == job.request.backend || !Backends::get(candidate).isRemote() ||
+            breaker.getState(candidate) == CircuitBreaker::State::OPEN) {
+            continue;
+        }
+
+        // The job's slot goes with it, so the new backend's limit holds and the old one's frees up
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!scheduler.transfer(job.slotBackend, candidate)) {
+                continue;
+            }
+        }
+        if (!breaker.allow(candidate)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            scheduler.transfer(candidate, job.slotBackend);
+            continue;
+        }
+        job.slotBackend = candidate;
+
+        std::cout << "Job " << job.id << " rerouted from " << Backends::get(job.request.backend).name
+            << " to " << Backends::get(candidate).name << " (circuit open)" << std::endl;
+        job.request.backend = candidate;
+        return true;
+    }
+    return false;
+}
+
+bool GenerationEngine::failIfExpired(Job& job) {
+    if (Clock::now() < job.deadline) {
+        return false;
+    }
+
+    deadlineFailures++;
+    completeJob(job, false, "Deadline exceeded");
+    return true;
+}
+
+void GenerationEngine::applyTransferTimeout(const Job& job, CURL* easy, long phaseTimeoutMs) {
+    // A transfer never outlives the job's deadline
+    long long remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(job.deadline - Clock::now()).count();
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, static_cast<long>(std::max(1LL, std::min<long long>(phaseTimeoutMs, remainingMs))));
+}
+
+bool GenerationEngine::recordBackendOutcome(Job& job, CURLcode code) {
+    // Transport failures and server errors count against the backend. A 429 is
+    // the account's limit, not the backend's health, and a timeout caused by the
+    // job's own deadline says nothing about the backend either.
+    bool deadlineHit = code == CURLE_OPERATION_TIMEDOUT && Clock::now() >= job.deadline;
+    bool failed = (code != CURLE_OK && code != CURLE_ABORTED_BY_CALLBACK && !deadlineHit) || job.httpStatus >= 500;
+
+    if (failed) {
+        breaker.recordFailure(job.request.backend);
+    }
+    else if (code == CURLE_OK && job.httpStatus != 429) {
+        breaker.recordSuccess(job.request.backend);
+    }
+    return failed;
+}
+
+void GenerationEngine::startDuePolls() {
+    Clock::time_point now = Clock::now();
+
+    // Collect first - starting a poll can complete (and erase) a job
+    std::vector<uint64_t> due;
+    for (const auto& entry : activeJobs) {
+        const Job& job = *entry.second;
+        if ((job.phase == JobPhase::POLLING && !job.easy && job.nextPollAt <= now) ||
+            (job.waitingForKey && job.nextSubmitAt <= now)) {
+            due.push_back(job.id);
+        }
+    }
+
+    for (uint64_t id : due) {
+        auto it = activeJobs.find(id);
+        if (it == activeJobs.end()) {
+            continue;
+        }
+        if (it->second->waitingForKey) {
+            startSubmit(*it->second);
+        }
+        else {
+            startPoll(*it->second);
+        }
+    }
+}
+
+int GenerationEngine::nextWakeupMs() {
+    Clock::time_point now = Clock::now();
+    long long waitMs = 1000;
+
+    for (const auto& entry : activeJobs) {
+        const Job& job = *entry.second;
+        if (job.phase == JobPhase::POLLING && !job.easy) {
+            long long untilPoll = std::chrono::duration_cast<std::chrono::milliseconds>(job.nextPollAt - now).count();
+            waitMs = std::min(waitMs, std::max(0LL, untilPoll));
+        }
+        else if (job.waitingForKey) {
+            long long untilSubmit = std::chrono::duration_cast<std::chrono::milliseconds>(job.nextSubmitAt - now).count();
+            waitMs = std::min(waitMs, std::max(0LL, untilSubmit));
+        }
+    }
+
+    // Queued jobs are checked for expired deadlines even when nothing else is due
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pendingJobs.empty()) {
+            waitMs = std::min(waitMs, EXPIRY_SWEEP_MS);
+        }
+    }
+
+    return static_cast<int>(waitMs);
+}
+
+void GenerationEngine::processCompletedTransfers() {
+    int messagesLeft = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &messagesLeft)) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        if (cancelTransfers.count(message->easy_handle)) {
+            long status = 0;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+            std::cout << "Remote cancel returned " << status << std::endl;
+            finishCancelTransfer(message->easy_handle);
+            continue;
+        }
+
+        auto it = transfers.find(message->easy_handle);
+        if (it == transfers.end()) {
+            continue;
+        }
+
+        Job& job = *it->second;
+        CURLcode code = message->data.result;
+        if (job.phase == JobPhase::DOWNLOADING) {
+            handleDownloadDone(job, message->easy_handle, code);
+            continue;
+        }
+
+        job.httpStatus = 0;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &job.httpStatus);
+        finishTransfer(job);
+        handleTransferDone(job, code);
+    }
+}
+
+void GenerationEngine::processCancellations() {
+    std::unordered_set<uint64_t> ids;
+    std::vector<std::unique_ptr<Job>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cancelRequests.empty()) {
+            return;
+        }
+        ids.swap(cancelRequests);
+        cancelsPending = 0;
+
+        // Jobs still waiting for a slot (or for their draft) never touched the network
+        for (auto it = ids.begin(); it != ids.end();) {
+            auto held = heldJobs.find(*it);
+            if (held != heldJobs.end()) {
+                dropped.push_back(std::move(held->second));
+                heldJobs.erase(held);
+                it = ids.erase(it);
+            }
+            else if (scheduler.remove(*it)) {
+                auto pending = pendingJobs.find(*it);
+                dropped.push_back(std::move(pending->second));
+                pendingJobs.erase(pending);
+                it = ids.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto& job : dropped) {
+        std::cout << "Job " << job->id << " cancelled before it started" << std::endl;
+        cancelledJobs++;
+        setPhase(*job, JobPhase::FAILED);
+        job->result.cancelled = true;
+        job->result.error = "Cancelled";
+        job->result.totalMs = elapsedMs(*job);
+        if (job->onComplete) {
+            job->onComplete(job->result);
+        }
+    }
+    if (!dropped.empty()) {
+        idleCondition.notify_all();
+    }
+
+    for (uint64_t id : ids) {
+        auto it = activeJobs.find(id);
+        if (it != activeJobs.end()) {
+            cancelJob(*it->second);
+        }
+        else {
+            cancelFollower(id);     // Unknown ids have already finished
+        }
+    }
+}
+
+void GenerationEngine::cancelJob(Job& job) {
+    cancelledJobs++;
+
+    if (!job.followers.empty()) {
+        // Identical submissions still want the image: release this caller and keep going for them
+        std::cout << "Job " << job.id << " cancelled, still running for " << job.followers.size() << " identical job(s)" << std::endl;
+        GenerationResult result = job.result;
+        result.cancelled = true;
+        result.error = "Cancelled";
+        result.totalMs = elapsedMs(job);
+
+        CompletionCallback onComplete = std::move(job.onComplete);
+        job.onComplete = nullptr;
+        job.outputFile.clear();
+        job.result.cancelled = true;    // Marks it as running for followers only
+        if (onComplete) {
+            onComplete(result);
+        }
+        return;
+    }
+
+    std::cout << "Job " << job.id << " cancelled" << std::endl;
+    abortJob(job);
+}
+
+void GenerationEngine::abortJob(Job& job) {
+    // Accepted but not finished: stop fal working on it (and billing for it). A job
+    // still SUBMITTING has no request id yet, so aborting the POST is all we can do.
+    if (job.phase == JobPhase::POLLING && !job.requestId.empty()) {
+        sendRemoteCancel(job);
+    }
+
+    finishTransfer(job);
+
+    job.result.cancelled = true;
+    completeJob(job, false, "Cancelled");
+}
+
+void GenerationEngine::cancelFollower(uint64_t jobId) {
+    for (auto& entry : activeJobs) {
+        auto& followers = entry.second->followers;
+        auto it = std::find_if(followers.begin(), followers.end(),
+            [jobId](const std::unique_ptr<Job>& follower) { return follower->id == jobId; });
+        if (it == followers.end()) {
+            continue;
+        }
+
+        // Followers don't hold a slot; the leader carries on for everyone else
+        Job& leader = *entry.second;
+        std::unique_ptr<Job> follower = std::move(*it);
+        followers.erase(it);
+
+        std::cout << "Job " << jobId << " cancelled" << std::endl;
+        cancelledJobs++;
+        setPhase(*follower, JobPhase::FAILED);
+        follower->result.cancelled = true;
+        follower->result.error = "Cancelled";
+        follower->result.totalMs = elapsedMs(*follower);
+        if (follower->onComplete) {
+            follower->onComplete(follower->result);
+        }
+
+        // ...unless its own caller already cancelled and this was the last one waiting
+        if (leader.result.cancelled && leader.followers.empty()) {
+            std::cout << "Job " << leader.id << " no longer needed" << std::endl;
+            abortJob(leader);
+        }
+        return;
+    }
+}
+
+void GenerationEngine::sendRemoteCancel(const Job& job) {
+    // Only the key that submitted the request can cancel it
+    std::vector<std::string> headers;
+    if (job.credential.valid()) {
+        FalApi::authHeaders(headers, false, job.credential);
+    }
+    CURL* easy = !headers.empty() ? http.acquireHandle() : nullptr;
+    if (!easy) {
+        return;
+    }
+
+    struct curl_slist* headerList = nullptr;
+    for (const auto& header : headers) {
+        headerList = curl_slist_append(headerList, header.c_str());
+    }
+
+    std::string url = FalApi::cancelUrl(job.request.backend, job.requestId);
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, "PUT");
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headerList);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, DiscardCallback);
+
+    // Nothing waits on the answer; processCompletedTransfers() just cleans it up
+    cancelTransfers[easy] = headerList;
+    if (curl_multi_add_handle(multi, easy) != CURLM_OK) {
+        finishCancelTransfer(easy);
+    }
+}
+
+void GenerationEngine::finishCancelTransfer(CURL* easy) {
+    auto it = cancelTransfers.find(easy);
+    if (it == cancelTransfers.end()) {
+        return;
+    }
+
+    curl_multi_remove_handle(multi, easy);
+    curl_slist_free_all(it->second);
+    cancelTransfers.erase(it);
+    http.releaseHandle(easy);
+}
+
+void GenerationEngine::processWebhooks() {
+    std::deque<FalApi::WebhookEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.swap(incomingWebhooks);
+    }
+
+    for (const FalApi::WebhookEvent& event : events) {
+        auto it = jobsByRequestId.find(event.requestId);
+        if (it == jobsByRequestId.end()) {
+            // A fast job can call back before its submit response is processed
+            if (earlyWebhooks.size() >= MAX_EARLY_WEBHOOKS) {
+                earlyWebhooks.clear();
+            }
+            earlyWebhooks[event.requestId] = event;
+            continue;
+        }
+
+        auto jobIt = activeJobs.find(it->second);
+        if (jobIt != activeJobs.end()) {
+            applyWebhook(*jobIt->second, event);
+        }
+    }
+}
+
+void GenerationEngine::applyWebhook(Job& job, const FalApi::WebhookEvent& event) {
+    if (job.phase != JobPhase::POLLING) {
+        return; // Already downloading via a fallback poll
+    }
+
+    // Drop a fallback poll that's still in flight
+    if (job.easy) {
+        finishTransfer(job);
+    }
+
+    if (event.status.imageUrl.empty()) {
+        completeJob(job, false, event.error.empty() ? "API request failed" : event.error);
+        return;
+    }
+
+    std::cout << "Job " << job.id << " completed (webhook)" << std::endl;
+    webhookCompletions++;
+
+    // The callback time is the completion time, so the scheduler gets an exact sample
+    double sinceAcceptedMs = elapsedMs(job) - job.acceptedMs;
+    if (!job.resumed) {
+        pollScheduler.recordCompletion(job.request.backend, job.width, job.height, sinceAcceptedMs, sinceAcceptedMs, false);
+    }
+
+    job.result.completedMs = elapsedMs(job);
+    startDownloads(job, event.status.imageUrls);
+}
+
+bool GenerationEngine::addTransfer(Job& job, CURL* easy) {
+    // Downloads track their handles in job.downloads
+    if (job.phase != JobPhase::DOWNLOADING) {
+        job.easy = easy;
+    }
+    transfers[easy] = &job;
+
+    // Lets cancel() abort the transfer mid-flight
+    curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+    curl_easy_setopt(easy, CURLOPT_XFERINFODATA, &job);
+    curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+
+    if (curl_multi_add_handle(multi, easy) != CURLM_OK) {
+        finishTransfer(job);
+        completeJob(job, false, "Failed to start transfer");
+        return false;
+    }
+    return true;
+}
+
+void GenerationEngine::finishTransfer(Job& job) {
+    if (job.easy) {
+        curl_multi_remove_handle(multi, job.easy);
+        transfers.erase(job.easy);
+        http.releaseHandle(job.easy);
+        job.easy = nullptr;
+    }
+
+    if (job.headers) {
+        curl_slist_free_all(job.headers);
+        job.headers = nullptr;
+    }
+
+    for (Job::Download& download : job.downloads) {
+        if (download.easy) {
+            curl_multi_remove_handle(multi, download.easy);
+            transfers.erase(download.easy);
+            http.releaseHandle(download.easy);
+            download.easy = nullptr;
+        }
+    }
+}
+
+bool GenerationEngine::resolveFromCache(Job& job) {
+    if (!resultCache.isEnabled()) {
+        return false;
+    }
+
+    // Only a hit if every candidate is there
+    std::vector<std::shared_ptr<const ByteBuffer>> cached;
+    for (int i = 0; i < job.request.numImages; i++) {
+        std::shared_ptr<const ByteBuffer> image = resultCache.lookup(candidateKey(job.cacheKey, i));
+        if (!image) {
+            cached.clear();
+            break;
+        }
+        cached.push_back(std::move(image));
+    }
+
+    if (!cached.empty()) {
+        std::cout << "Job " << job.id << " served from result cache" << std::endl;
+        std::string error;
+        bool ok = attachImages(job, cached, error);
+        completeJob(job, ok, error);
+        return true;
+    }
+
+    auto leader = inFlightByKey.find(job.cacheKey);
+    if (leader != inFlightByKey.end()) {
+        auto leaderJob = activeJobs.find(leader->second);
+        if (leaderJob != activeJobs.end()) {
+            std::cout << "Job " << job.id << " joined identical job " << leader->second << std::endl;
+            resultCache.recordCoalesced();
+
+            // Followers ride along with the leader and don't hold a concurrency slot
+            setPhase(job, leaderJob->second->phase);
+            uint64_t id = job.id;
+            leaderJob->second->followers.push_back(std::move(activeJobs[id]));
+            activeJobs.erase(id);
+            releaseSlot(*leaderJob->second->followers.back());
+            return true;
+        }
+    }
+
+    inFlightByKey[job.cacheKey] = job.id;
+    return false;
+}
+
+void GenerationEngine::runLocal(Job& job, const BackendOps& backend) {
+    outputSize(job);
+
+    // Later candidates get a varied seed so they differ from the first
+    std::vector<std::shared_ptr<const ByteBuffer>> images;
+    for (int i = 0; i < job.request.numImages; i++) {
+        auto image = std::make_shared<ByteBuffer>();
+        std::string prompt = job.request.prompt + job.request.styleModifier + (i > 0 ? " #" + std::to_string(i + 1) : "");
+        if (!backend.generateLocal(prompt, job.width, job.height, *image)) {
+            completeJob(job, false, std::string(backend.name) + " backend failed");
+            return;
+        }
+        images.push_back(std::move(image));
+    }
+
+    job.result.submittedMs = elapsedMs(job);
+    job.result.completedMs = job.result.submittedMs;
+
+    std::string error;
+    bool ok = attachImages(job, images, error);
+    completeJob(job, ok, error);
+}
+
+bool GenerationEngine::attachImages(Job& job, const std::vector<std::shared_ptr<const ByteBuffer>>& images, std::string& error) {
+    job.result.images = images;
+    job.result.imageData = images.front();
+    if (job.outputFile.empty()) {
+        return true;
+    }
+
+    job.result.filenames.clear();
+    for (size_t i = 0; i < images.size(); i++) {
+        std::string path = candidateFile(job.outputFile, i);
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(images[i]->data()), images[i]->size());
+        if (!file) {
+            error = "Could not write " + path;
+            return false;
+        }
+        job.result.filenames.push_back(path);
+    }
+
+    job.result.filename = job.outputFile;
+    return true;
+}
+
+void GenerationEngine::finishFollower(Job& follower, const Job& leader) {
+    GenerationResult& result = follower.result;
+    result.requestId = leader.result.requestId;
+    result.imageUrl = leader.result.imageUrl;
+    result.imageUrls = leader.result.imageUrls;
+    result.success = leader.result.success;
+    result.error = leader.result.error;
+    result.submittedMs = leader.result.submittedMs;
+    result.completedMs = leader.result.completedMs;
+
+    if (result.success && !attachImages(follower, leader.result.images, result.error)) {
+        result.success = false;
+    }
+
+    setPhase(follower, result.success ? JobPhase::COMPLETED : JobPhase::FAILED);
+    result.totalMs = elapsedMs(follower);
+
+    if (follower.onComplete) {
+        follower.onComplete(result);
+    }
+}
+
+void GenerationEngine::startSubmit(Job& job) {
+    if (failIfExpired(job)) {
+        return;
+    }
+
+    CredentialPool& credentials = FalApi::credentials();
+    if (credentials.empty()) {
+        std::cout << "ERROR: FAL_KEY environment variable not set!" << std::endl;
+        completeJob(job, false, "FAL_KEY environment variable not set");
+        return;
+    }
+
+    // Least-loaded key; if every key is at its limit or backed off, keep the slot and retry
+    CredentialPool::Clock::duration retryAfter;
+    if (!credentials.acquire(job.credential, retryAfter)) {
+        setPhase(job, JobPhase::SUBMITTING);
+        job.waitingForKey = true;
+        job.nextSubmitAt = Clock::now() + retryAfter;
+        return;
+    }
+    job.waitingForKey = false;
+
+    std::vector<std::string> headers;
+    FalApi::authHeaders(headers, true, job.credential);
+
+    CURL* easy = http.acquireHandle();
+    if (!easy) {
+        completeJob(job, false, "curl_easy_init failed");
+        return;
+    }
+
+    setPhase(job, JobPhase::SUBMITTING);
+    job.responseBody.clear();
+    if (job.sentMs < 0) {
+        job.sentMs = elapsedMs(job);
+    }
+
+    for (const auto& header : headers) {
+        job.headers = curl_slist_append(job.headers, header.c_str());
+    }
+
+    std::string url = FalApi::submitUrl(job.request.backend);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!webhookUrl.empty()) {
+            url += "?fal_webhook=" + FalApi::urlEncode(webhookUrl);
+            job.webhookRequested = true;
+        }
+    }
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, job.payload.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(job.payload.size()));
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, job.headers);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, HttpClient::WriteCallback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &job.responseBody);
+    applyTransferTimeout(job, easy, SUBMIT_TIMEOUT_MS);
+
+    addTransfer(job, easy);
+}
+
+void GenerationEngine::resumePolling(Job& job) {
+    std::cout << "Job " << job.id << " resuming request " << job.requestId << std::endl;
+
+    // Polls must use the key that submitted it
+    if (!FalApi::credentials().attach(job.credential.fingerprint, job.credential)) {
+        completeJob(job, false, "FAL_KEY environment variable not set");
+        return;
+    }
+
+    // Identical new submissions can join it instead of paying again
+    inFlightByKey[job.cacheKey] = job.id;
+    jobsByRequestId[job.requestId] = job.id;
+
+    outputSize(job);
+    setPhase(job, JobPhase::POLLING);
+    job.nextPollAt = Clock::now();
+}
+
+void GenerationEngine::startPoll(Job& job) {
+    if (failIfExpired(job)) {
+        return;
+    }
+
+    std::vector<std::string> headers;
+    FalApi::authHeaders(headers, false, job.credential);
+    CURL* easy = http.acquireHandle();
+    if (!easy) {
+        completeJob(job, false, "Failed to start status poll");
+        return;
+    }
+
+    if (job.webhookRequested && job.pollCount == 0) {
+        std::cout << "Job " << job.id << ": no webhook yet, falling back to polling" << std::endl;
+        pollingFallbacks++;
+    }
+
+    job.responseBody.clear();
+    for (const auto& header : headers) {
+        job.headers = curl_slist_append(job.headers, header.c_str());
+    }
+
+    std::string url = FalApi::resultUrl(job.request.backend, job.requestId);
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, job.headers);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, HttpClient::WriteCallback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &job.responseBody);
+    applyTransferTimeout(job, easy, POLL_TIMEOUT_MS);
+
+    addTransfer(job, easy);
+}
+
+void GenerationEngine::startDownloads(Job& job, const std::vector<std::string>& imageUrls) {
+    // fal is done with the request; the images are on the CDN and need no key
+    releaseCredential(job);
+    if (failIfExpired(job)) {
+        return;
+    }
+
+    job.imageUrls = imageUrls;
+    job.result.imageUrl = imageUrls.front();
+    job.result.imageUrls = imageUrls;
+    if (imageUrls.size() > 1) {
+        std::cout << "Job " << job.id << " downloading " << imageUrls.size() << " candidates" << std::endl;
+    }
+
+    // Sized once: each sink's address is handed to curl
+    setPhase(job, JobPhase::DOWNLOADING);
+    job.downloads.resize(imageUrls.size());
+    job.downloadsLeft = imageUrls.size();
+
+    for (size_t i = 0; i < imageUrls.size(); i++) {
+        CURL* easy = http.acquireHandle();
+        if (!easy) {
+            finishTransfer(job);
+            completeJob(job, false, "Failed to start download");
+            return;
+        }
+
+        Job::Download& download = job.downloads[i];
+        download.easy = easy;
+        download.data = std::make_shared<ByteBuffer>();
+        download.sink.curl = easy;
+        download.sink.buffer = download.data.get();
+
+        curl_easy_setopt(easy, CURLOPT_URL, imageUrls[i].c_str());
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, HttpClient::BufferWriteCallback);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, &download.sink);
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        applyTransferTimeout(job, easy, DOWNLOAD_TIMEOUT_MS);
+
+        if (!addTransfer(job, easy)) {
+            return;
+        }
+    }
+}
+
+void GenerationEngine::handleTransferDone(Job& job, CURLcode code) {
+    switch (job.phase) {
+    case JobPhase::SUBMITTING: {
+        bool backendFailed = recordBackendOutcome(job, code);
+        if (code != CURLE_OK) {
+            std::cout << "curl_easy_perform() failed: " << curl_easy_strerror(code) << std::endl;
+            if (failIfExpired(job)) {
+                return;
+            }
+            completeJob(job, false, code == CURLE_OPERATION_TIMEDOUT ? "Submit timed out" : "Failed to submit API request");
+            return;
+        }
+        if (backendFailed) {
+            completeJob(job, false, "API unavailable (HTTP " + std::to_string(job.httpStatus) + ")");
+            return;
+        }
+
+        if (job.httpStatus == 429) {
+            // Over this key's limit: back it off and resubmit, probably on another key
+            FalApi::credentials().reportThrottled(job.credential);
+            releaseCredential(job);
+            if (++job.throttledSubmits > MAX_THROTTLED_SUBMITS) {
+                completeJob(job, false, "Rate limited by the API (429)");
+                return;
+            }
+            job.waitingForKey = true;
+            job.nextSubmitAt = Clock::now();
+            return;
+        }
+
+        job.requestId = FalApi::parseRequestId(job.responseBody);
+        if (job.requestId.empty()) {
+            completeJob(job, false, "Failed to submit API request");
+            return;
+        }
+
+        std::cout << "Job " << job.id << " submitted with ID: " << job.requestId << std::endl;
+        FalApi::credentials().reportAccepted(job.credential);
+        job.result.requestId = job.requestId;
+        job.result.submittedMs = elapsedMs(job);
+        job.acceptedMs = job.result.submittedMs;
+        setPhase(job, JobPhase::POLLING);
+        jobsByRequestId[job.requestId] = job.id;
+        outputSize(job);
+
+        // Journal before waiting on it, so a crash from here on doesn't lose the request.
+        // Drafts aren't worth resuming: only the session that asked wants them.
+        if (journal.isOpen() && !job.request.draft) {
+            JobJournal::Entry entry;
+            entry.requestId = job.requestId;
+            entry.backend = Backends::get(job.request.backend).name;
+            entry.cacheKey = job.cacheKey;
+            entry.credential = job.credential.fingerprint;
+            entry.prompt = job.request.prompt;
+            entry.styleModifier = job.request.styleModifier;
+            entry.orientation = job.request.orientation == OrientationMode::LANDSCAPE ? "landscape" : "portrait";
+            entry.outputFile = job.outputFile;
+            entry.numImages = job.request.numImages;
+            journal.recordSubmitted(entry);
+        }
+
+        if (job.webhookRequested) {
+            // Only poll if the webhook never shows up
+            double fallbackMs;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                fallbackMs = webhookFallbackMs;
+            }
+            job.nextPollAt = std::min(job.deadline, Clock::now() + std::chrono::milliseconds(static_cast<long long>(fallbackMs)));
+
+            auto early = earlyWebhooks.find(job.requestId);
+            if (early != earlyWebhooks.end()) {
+                FalApi::WebhookEvent event = early->second;
+                earlyWebhooks.erase(early);
+                applyWebhook(job, event);
+            }
+            return;
+        }
+
+        // First poll near the time this backend/resolution usually finishes
+        job.nextPollAt = std::min(job.deadline, Clock::now() + pollScheduler.firstPollDelay(job.request.backend, job.width, job.height));
+        return;
+    }
+
+    case JobPhase::POLLING: {
+        job.pollCount++;
+        double sinceAcceptedMs = elapsedMs(job) - job.acceptedMs;
+
+        bool backendFailed = recordBackendOutcome(job, code);
+
+        if (job.httpStatus == 429) {
+            // Counts as a miss; keeps new submits off this key for a while. A poll
+            // 429 says nothing about how many jobs the key can run, so no cap.
+            FalApi::credentials().reportPollThrottled(job.credential);
+        }
+        else if (backendFailed || code != CURLE_OK || job.responseBody.empty()) {
+            std::cout << "Failed to get status" << std::endl;
+
+            // The backend is down: answer now rather than polling into it until the deadline
+            if (backendFailed && breaker.getState(job.request.backend) == CircuitBreaker::State::OPEN) {
+                completeJob(job, false, std::string(Backends::get(job.request.backend).name) + " unavailable (circuit open)");
+                return;
+            }
+        }
+        else {
+            FalApi::QueueStatus status = FalApi::parseStatus(job.responseBody);
+
+            if (!status.imageUrl.empty()) {
+                std::cout << "Job " << job.id << " image generation completed!" << std::endl;
+                if (!job.resumed) {
+                    pollScheduler.recordCompletion(job.request.backend, job.width, job.height, job.lastMissMs, sinceAcceptedMs);
+                }
+                job.result.completedMs = elapsedMs(job);
+                startDownloads(job, status.imageUrls);
+                return;
+            }
+
+            if (status.notFound) {
+                std::cout << "Endpoint not found - check API URL" << std::endl;
+                completeJob(job, false, "Endpoint not found");
+                return;
+            }
+
+            if (status.parsed) {
+                std::cout << "Job " << job.id << " status: " << status.status;
+                if (status.queuePosition >= 0) {
+                    std::cout << " #" << status.queuePosition;
+                }
+                std::cout << " (poll " << job.pollCount << ", " << static_cast<int>(sinceAcceptedMs) << " ms)" << std::endl;
+            }
+
+            if (status.status == "FAILED") {
+                completeJob(job, false, status.error.empty() ? "API request failed" : status.error);
+                return;
+            }
+        }
+
+        if (failIfExpired(job)) {
+            return;
+        }
+
+        // The last poll lands on the deadline rather than past it
+        job.lastMissMs = sinceAcceptedMs;
+        job.nextPollAt = std::min(job.deadline, Clock::now() + pollScheduler.afterMissedPoll(job.request.backend, job.width, job.height,
+            sinceAcceptedMs, job.pollCount));
+        return;
+    }
+
+    default:
+        return;
+    }
+}
+
+void GenerationEngine::handleDownloadDone(Job& job, CURL* easy, CURLcode code) {
+    for (size_t i = 0; i < job.downloads.size(); i++) {
+        Job::Download& download = job.downloads[i];
+        if (download.easy != easy) {
+            continue;
+        }
+
+        // An error page from the CDN is not an image; it must never reach the cache
+        long status = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+
+        curl_multi_remove_handle(multi, easy);
+        transfers.erase(easy);
+        http.releaseHandle(easy);
+        download.easy = nullptr;
+
+        if (code != CURLE_OK || status < 200 || status >= 300 || download.data->empty()) {
+            std::cout << "Job " << job.id << ": candidate " << i + 1 << " failed to download";
+            if (code == CURLE_OK) {
+                std::cout << " (HTTP " << status << ")";
+            }
+            std::cout << std::endl;
+            download.data.reset();
+        }
+        break;
+    }
+
+    // The job finishes with its last candidate
+    if (--job.downloadsLeft > 0) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<const ByteBuffer>> images;
+    job.result.imageUrls.clear();
+    for (size_t i = 0; i < job.downloads.size(); i++) {
+        if (job.downloads[i].data) {
+            resultCache.store(candidateKey(job.cacheKey, i), *job.downloads[i].data);
+            images.push_back(job.downloads[i].data);
+            job.result.imageUrls.push_back(job.imageUrls[i]);
+        }
+    }
+    job.downloads.clear();
+
+    if (images.empty()) {
+        if (failIfExpired(job)) {
+            return;
+        }
+        completeJob(job, false, "Failed to download image");
+        return;
+    }
+
+    job.result.imageUrl = job.result.imageUrls.front();
+    std::string error;
+    bool ok = attachImages(job, images, error);
+    completeJob(job, ok, error);
+}
+
+void GenerationEngine::releaseCredential(Job& job) {
+    if (job.credential.valid()) {
+        FalApi::credentials().release(job.credential);
+    }
+    job.waitingForKey = false;
+}
+
+void GenerationEngine::completeJob(Job& job, bool success, const std::string& error) {
+    releaseCredential(job);
+    setPhase(job, success ? JobPhase::COMPLETED : JobPhase::FAILED);
+    job.result.success = success;
+    job.result.error = error;
+    job.result.pollCount = job.pollCount;
+    job.result.totalMs = elapsedMs(job);
+
+    if (!success && !job.result.cancelled) {
+        std::cout << "Job " << job.id << " failed: " << error << std::endl;
+    }
+
+    // What routing learns from: final renders that were actually sent. Cancels say
+    // nothing about the backend, and neither does running out of 429 retries.
+    if (job.sentMs >= 0 && !job.resumed && !job.request.draft && !job.result.cancelled &&
+        job.throttledSubmits <= MAX_THROTTLED_SUBMITS) {
+        if (success) {
+            router.recordSuccess(job.request.backend, job.result.totalMs - job.sentMs);
+        }
+        else {
+            router.recordFailure(job.request.backend);
+        }
+    }
+
+    if (!job.requestId.empty()) {
+        jobsByRequestId.erase(job.requestId);
+
+        // Done with it either way; only shutdown leaves jobs in the journal for next time
+        journal.recordFinished(job.requestId);
+    }
+
+    auto inFlight = inFlightByKey.find(job.cacheKey);
+    if (inFlight != inFlightByKey.end() && inFlight->second == job.id) {
+        inFlightByKey.erase(inFlight);
+    }
+
+    // Take ownership out of the active set before calling back
+    uint64_t id = job.id;
+    std::unique_ptr<Job> finished = std::move(activeJobs[id]);
+    activeJobs.erase(id);
+
+    if (finished->onComplete) {
+        finished->onComplete(finished->result);
+    }
+
+    // Identical submissions that waited on this job get the same outcome
+    for (auto& follower : finished->followers) {
+        finishFollower(*follower, *finished);
+    }
+
+    releaseSlot(*finished);
+}
+
+void GenerationEngine::setPhase(Job& job, JobPhase phase) {
+    job.phase = phase;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (phase == JobPhase::COMPLETED || phase == JobPhase::FAILED) {
+        jobPhases.erase(job.id);
+    }
+    else {
+        jobPhases[job.id] = phase;
+    }
+}
+
+JobPhase GenerationEngine::getJobPhase(uint64_t jobId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobPhases.find(jobId);
+    return it != jobPhases.end() ? it->second : JobPhase::COMPLETED;
+}
+
+void GenerationEngine::outputSize(Job& job) {
+    // Drafts get their own poll scheduler buckets through their smaller size
+    if (job.request.draft) {
+        FalApi::draftDimensions(job.request.orientation, job.width, job.height);
+    }
+    else {
+        FalApi::imageDimensions(job.request.orientation, job.width, job.height);
+    }
+}
+
+double GenerationEngine::elapsedMs(const Job& job) const {
+    return std::chrono::duration<double, std::milli>(Clock::now() - job.createdAt).count();
+}
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <curl/curl.h>
+#include "GenerationTypes.h"
+#include "Backends.h"
+#include "BackendRouter.h"
+#include "CircuitBreaker.h"
+#include "FalApi.h"
+#include "HttpClient.h"
+#include "JobJournal.h"
+#include "JobScheduler.h"
+#include "PollScheduler.h"
+#include "ResultCache.h"
+
+enum class JobPhase {
+    PENDING,        // Waiting for a free concurrency slot
+    SUBMITTING,     // POST to the queue in flight
+    POLLING,        // Waiting for the remote job to finish
+    DOWNLOADING,    // Fetching the result image
+    COMPLETED,
+    FAILED
+};
+
+struct GenerationRequest {
+    std::string prompt;
+    std::string styleModifier;
+    BackendId backend = BackendId::FLUX_SCHNELL;    // Resolved from the UI category via Backends::forCategory
+    OrientationMode orientation = OrientationMode::PORTRAIT;
+    std::string client;         // Fair-share key for the scheduler ("" counts as one client)
+    JobPriority priority = JobPriority::INTERACTIVE;
+    double deadlineMs = 0;      // Budget from submit() to the downloaded image; 0 = the engine default
+    bool draft = false;         // Low-resolution, low-step preview (FalApi::draftDimensions); see submitWithDraft
+    int numImages = 1;          // Candidates from one submission (num_images, up to FalApi::MAX_IMAGES); drafts get one
+};
+
+struct GenerationResult {
+    uint64_t jobId = 0;
+    bool success = false;
+    bool cancelled = false;     // Stopped by cancel(); success is false
+    std::string error;
+    std::string requestId;
+    std::string imageUrl;
+    bool draft = false;         // Result of a draft preview, not the final render
+    std::string filename;       // Only set when the job was given an output file
+    std::shared_ptr<const ByteBuffer> imageData;    // Encoded image exactly as downloaded
+
+    // Every candidate of a multi-image request, in the backend's order; the fields
+    // above describe the first. Candidates after the first are written next to the
+    // output file as name_2.jpg, name_3.jpg, ... A candidate that failed to
+    // download is left out.
+    std::vector<std::string> imageUrls;
+    std::vector<std::shared_ptr<const ByteBuffer>> images;
+    std::vector<std::string> filenames;
+    int pollCount = 0;
+
+    // Timings in milliseconds, measured from when the job was submitted to the engine
+    double submittedMs = 0;     // Queue accepted the request
+    double completedMs = 0;     // Result URL received
+    double totalMs = 0;         // Image downloaded
+};
+
+using CompletionCallback = std::function<void(const GenerationResult&)>;
+
+// How submitWithDraft orders the two jobs
+enum class DraftMode {
+    ALONGSIDE,      // Draft and final are queued together; fastest final, pays for the final even if rejected
+    AHEAD           // Final is queued once the draft has landed; a rejected draft costs only the draft
+};
+
+struct DraftedJob {
+    uint64_t draftId = 0;
+    uint64_t finalId = 0;
+};
+
+// Event-loop generation engine. A single I/O thread drives every job's
+// submit -> poll -> download state machine through one curl_multi handle,
+// so the number of jobs in flight is bounded by the scheduler's limits, not by threads.
+// Completion callbacks run on the I/O thread.
+class GenerationEngine {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        GenerationEngine* engine = nullptr;
+        uint64_t id = 0;
+        GenerationRequest request;
+        std::string outputFile;
+        CompletionCallback onComplete;
+        std::string cacheKey;       // Hash of backend + payload
+        std::vector<std::unique_ptr<Job>> followers;    // Identical submissions waiting on this one
+        JobPhase phase = JobPhase::PENDING;
+
+        std::string requestId;
+        std::vector<std::string> imageUrls;
+        int pollCount = 0;
+        int width = 0;
+        int height = 0;
+        double acceptedMs = 0;      // When the queue accepted the request
+        double lastMissMs = 0;      // Time since acceptance of the last poll without a result
+        bool webhookRequested = false;  // Submitted with fal_webhook; polling is only a fallback
+        bool resumed = false;           // Picked up from the journal; already accepted by the queue
+        CredentialPool::Lease credential;   // Key it was submitted with; polls and cancel reuse it
+        bool waitingForKey = false;     // Every key is busy or backed off; submit again at nextSubmitAt
+        int throttledSubmits = 0;
+        long httpStatus = 0;            // Of the last finished transfer
+        BackendId slotBackend = BackendId::FLUX_SCHNELL;   // Backend whose scheduler slot it holds (follows reroutes)
+        double sentMs = -1;             // First submission sent; the router's latency runs from here
+        Clock::time_point createdAt;
+        Clock::time_point deadline;     // Fails with "Deadline exceeded" past this, whatever the phase
+        Clock::time_point nextPollAt;
+        Clock::time_point nextSubmitAt;
+        GenerationResult result;
+
+        // Current submit or poll transfer
+        CURL* easy = nullptr;
+        struct curl_slist* headers = nullptr;
+        std::string payload;
+        std::string responseBody;
+
+        // One per returned image, all in flight together on the pooled connections
+        struct Download {
+            CURL* easy = nullptr;
+            std::shared_ptr<ByteBuffer> data;
+            HttpClient::DownloadSink sink;
+        };
+        std::vector<Download> downloads;
+        size_t downloadsLeft = 0;
+    };
+
+    HttpClient& http;
+    CURLM* multi;
+    std::thread ioThread;
+    std::atomic<bool> running;
+
+    // Protects pendingJobs, scheduler, jobPhases and the idle condition
+    mutable std::mutex mutex;
+    std::condition_variable idleCondition;
+    std::unordered_map<uint64_t, std::unique_ptr<Job>> pendingJobs;    // Waiting for the scheduler
+    std::unordered_map<uint64_t, std::unique_ptr<Job>> heldJobs;       // DraftMode::AHEAD finals waiting for their draft
+    JobScheduler scheduler;
+    std::unordered_map<uint64_t, JobPhase> jobPhases;   // Unfinished jobs, for getJobPhase()
+    std::atomic<uint64_t> nextJobId;
+
+    // Owned by the I/O thread
+    std::unordered_map<uint64_t, std::unique_ptr<Job>> activeJobs;
+    std::unordered_map<CURL*, Job*> transfers;
+    std::atomic<size_t> activeCount;
+
+    PollScheduler pollScheduler;
+    ResultCache resultCache;
+    JobJournal journal;
+    std::unordered_map<std::string, uint64_t> inFlightByKey;   // Cache key -> leading job (I/O thread)
+
+    // Cancellation. Requested ids are guarded by mutex; cancelsPending lets the
+    // progress callback skip the lock while nothing is being cancelled.
+    std::unordered_set<uint64_t> cancelRequests;
+    std::atomic<size_t> cancelsPending;
+    std::unordered_map<CURL*, struct curl_slist*> cancelTransfers;     // Fire-and-forget PUT .../cancel (I/O thread)
+    std::atomic<uint64_t> cancelledJobs;
+
+    // Webhook completion. webhookUrl/webhookFallbackMs and the incoming queue are
+    // guarded by mutex; the request id index is owned by the I/O thread.
+    std::string webhookUrl;
+    double webhookFallbackMs;
+    std::deque<FalApi::WebhookEvent> incomingWebhooks;
+    std::unordered_map<std::string, uint64_t> jobsByRequestId;
+    std::unordered_map<std::string, FalApi::WebhookEvent> earlyWebhooks;   // Arrived before the submit response
+    std::atomic<uint64_t> webhookCompletions;
+    std::atomic<uint64_t> pollingFallbacks;
+
+    // Failing backends. rerouteOnOpenCircuit is guarded by mutex.
+    CircuitBreaker breaker;
+    bool rerouteOnOpenCircuit;
+    BackendRouter router;
+    std::atomic<uint64_t> deadlineFailures;
+    Clock::time_point nextExpirySweep;
+
+    // Give up on a job that hasn't produced a result this long after submission,
+    // unless the request sets its own deadline
+    static constexpr double DEFAULT_DEADLINE_MS = 120000.0;
+    // Longest a single transfer of each phase may take (less if the deadline is nearer)
+    static constexpr long SUBMIT_TIMEOUT_MS = 15000;
+    static constexpr long POLL_TIMEOUT_MS = 10000;
+    static constexpr long DOWNLOAD_TIMEOUT_MS = 60000;
+    // How often queued jobs are checked for expired deadlines
+    static constexpr long long EXPIRY_SWEEP_MS = 250;
+    static constexpr size_t MAX_EARLY_WEBHOOKS = 256;
+    // Submits answered 429 before the job fails; each retry may go to another key
+    static constexpr int MAX_THROTTLED_SUBMITS = 8;
+
+    std::unique_ptr<Job> makeJob(const GenerationRequest& request, const std::string& outputFile, CompletionCallback onComplete);
+    void releaseHeld(uint64_t jobId);
+    static void outputSize(Job& job);
+
+    void ioLoop();
+    void admitPendingJobs();
+    void expirePendingJobs();
+    bool rerouteAround(Job& job);
+    bool recordBackendOutcome(Job& job, CURLcode code);
+    bool failIfExpired(Job& job);
+    void applyTransferTimeout(const Job& job, CURL* easy, long phaseTimeoutMs);
+    void startDuePolls();
+    void processCompletedTransfers();
+    void processWebhooks();
+    void processCancellations();
+    bool isCancelRequested(uint64_t jobId);
+    void cancelJob(Job& job);
+    void abortJob(Job& job);
+    void cancelFollower(uint64_t jobId);
+    void sendRemoteCancel(const Job& job);
+    void finishCancelTransfer(CURL* easy);
+    void applyWebhook(Job& job, const FalApi::WebhookEvent& event);
+    int nextWakeupMs();
+
+    bool resolveFromCache(Job& job);
+    void runLocal(Job& job, const BackendOps& backend);
+    bool attachImages(Job& job, const std::vector<std::shared_ptr<const ByteBuffer>>& images, std::string& error);
+    void finishFollower(Job& follower, const Job& leader);
+    void startSubmit(Job& job);
+    void resumePolling(Job& job);
+    void releaseCredential(Job& job);
+    void startPoll(Job& job);
+    void startDownloads(Job& job, const std::vector<std::string>& imageUrls);
+    bool addTransfer(Job& job, CURL* easy);
+    void finishTransfer(Job& job);
+    void handleTransferDone(Job& job, CURLcode code);
+    void handleDownloadDone(Job& job, CURL* easy, CURLcode code);
+    void completeJob(Job& job, bool success, const std::string& error);
+    void setPhase(Job& job, JobPhase phase);
+    void enqueue(std::unique_ptr<Job> job);
+    void releaseSlot(const Job& job);
+    double elapsedMs(const Job& job) const;
+
+    static int ProgressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+
+public:
+    GenerationEngine(HttpClient& httpClient, size_t maxConcurrent = 4);
+    ~GenerationEngine();
+
+    GenerationEngine(const GenerationEngine&) = delete;
+    GenerationEngine& operator=(const GenerationEngine&) = delete;
+
+    // Queues a job and returns its id; onComplete fires once on the I/O thread.
+    // The image (every candidate, for request.numImages > 1) is always delivered in
+    // memory; a non-empty outputFile is also written once.
+    uint64_t submit(const GenerationRequest& request, const std::string& outputFile, CompletionCallback onComplete);
+
+    // Two-phase generation: a draft of the same prompt and style (on flux-1/schnell
+    // for remote backends, at draft size and steps) plus the full render. onDraft
+    // fires with the preview, onFinal with the real image; either may fail on its
+    // own. A rejected draft is dropped by cancel(finalId) - in AHEAD mode before
+    // the final has cost anything. Callbacks run on the I/O thread.
+    DraftedJob submitWithDraft(const GenerationRequest& request, const std::string& outputFile,
+        CompletionCallback onDraft, CompletionCallback onFinal, DraftMode mode);
+
+    // Thread-safe. Stops the job wherever it is: a queued job is dropped, a live
+    // transfer is aborted, and a request fal has already accepted is cancelled
+    // remotely. The slot frees at once and onComplete fires with result.cancelled,
+    // unless the job had already finished.
+    void cancel(uint64_t jobId);
+    uint64_t getCancelledJobs() const { return cancelledJobs; }
+
+    void setMaxConcurrentJobs(size_t maxConcurrent);
+    size_t getMaxConcurrentJobs() const;
+    size_t pendingJobCount() const;
+
+    // Scheduling between clients (see JobScheduler.h). Thread-safe. The constructor
+    // applies FAL_BACKEND_LIMITS ("playground-v25=2,...") and FAL_CLIENT_WEIGHTS ("ui=4,batch=1").
+    void setBackendLimit(BackendId backend, size_t limit);
+    void setClientWeight(const std::string& client, double weight);
+    JobScheduler::Stats getSchedulerStats() const;
+    void printSchedulerStats() const;
+    size_t activeJobCount() const { return activeCount; }
+
+    // Thread-safe; COMPLETED once the job has finished (or for unknown ids).
+    // A coalesced job reports its leader's phase as of joining.
+    JobPhase getJobPhase(uint64_t jobId) const;
+
+    PollScheduler& getPollScheduler() { return pollScheduler; }
+
+    // Repeat requests are answered from here and identical in-flight requests share
+    // one remote job, once the cache has been opened
+    ResultCache& getResultCache() { return resultCache; }
+
+    // Accepted jobs are journaled once it has been opened, so they survive a crash
+    JobJournal& getJournal() { return journal; }
+
+    // Re-queues a journaled job: it skips submission and goes straight to polling
+    // (then downloading) under its existing request id
+    uint64_t resume(const JobJournal::Entry& entry, const std::string& outputFile, CompletionCallback onComplete);
+
+    // Submit with ?fal_webhook=url and wait for deliverWebhook(); a job only
+    // falls back to polling if nothing arrives within fallbackMs of acceptance.
+    // An empty url returns to pure polling.
+    void setWebhookMode(const std::string& url, double fallbackMs);
+    bool isWebhookMode() const;
+
+    // Thread-safe; called by the webhook listener
+    void deliverWebhook(const FalApi::WebhookEvent& event);
+
+    uint64_t getWebhookCompletions() const { return webhookCompletions; }
+    uint64_t getPollingFallbacks() const { return pollingFallbacks; }
+
+    // Remote backends that keep failing (transport errors, timeouts, 5xx) trip a
+    // circuit; new jobs for them then fail at once, or with rerouting enabled
+    // (also FAL_REROUTE=1) go to another remote backend whose circuit is closed.
+    CircuitBreaker& getCircuitBreaker() { return breaker; }
+    void setRerouteOnOpenCircuit(bool enabled);
+    uint64_t getDeadlineFailures() const { return deadlineFailures; }
+
+    // Backend for a new job in category: the one most likely to meet the latency
+    // target, from what this engine's jobs have measured (see BackendRouter.h).
+    // Thread-safe. The constructor applies FAL_LATENCY_TARGET_MS and FAL_ROUTE_PINS
+    // ("gaming_tech=flux-schnell,...").
+    BackendId routeCategory(APIModel category) { return router.choose(category, breaker); }
+    BackendRouter& getRouter() { return router; }
+
+    // Blocks until no jobs are pending or active
+    void waitUntilIdle();
+    void shutdown();
+};
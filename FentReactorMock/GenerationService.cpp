@@ -0,0 +1,412 @@
+#include "GenerationService.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include "BatchRunner.h"
+#include "StyleCatalog.h"
+
+using json = nlohmann::json;
+
+namespace {
+    const char* phaseName(JobPhase phase) {
+        switch (phase) {
+        case JobPhase::PENDING: return "queued";
+        case JobPhase::SUBMITTING: return "submitting";
+        case JobPhase::POLLING: return "running";
+        default: return "downloading";
+        }
+    }
+
+    // Generated images are JPEG; the offline backend and the mock queue serve BMP
+    std::string imageContentType(const ByteBuffer& data) {
+        if (data.size() >= 2 && data[0] == 0xFF && data[1] == 0xD8) return "image/jpeg";
+        if (data.size() >= 4 && data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') return "image/png";
+        if (data.size() >= 2 && data[0] == 'B' && data[1] == 'M') return "image/bmp";
+        return "application/octet-stream";
+    }
+
+    HttpServerResponse errorResponse(int status, const std::string& message) {
+        return HttpServerResponse::json(status, json({ {"error", message} }).dump());
+    }
+}
+
+GenerationService::GenerationService(GenerationEngine& generationEngine, const Options& serviceOptions) :
+    engine(generationEngine),
+    options(serviceOptions),
+    server([this](const HttpServerRequest& request) { return handleRequest(request); }, serviceOptions.workerThreads),
+    hasPinnedBackend(false),
+    pinnedBackend(BackendId::FLUX_SCHNELL),
+    unfinishedJobs(0),
+    waiters(0),
+    stopping(false) {
+}
+
+GenerationService::~GenerationService() {
+    stop();
+}
+
+bool GenerationService::start(unsigned short port) {
+    std::string backendName = options.backend;
+    if (!Backends::pinFromEnvironment(backendName, hasPinnedBackend, pinnedBackend)) {
+        std::cout << "Generation service: unknown backend " << backendName << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    if (!server.start(port)) {
+        return false;
+    }
+
+    std::cout << "Generation service at " << getBaseUrl() << " (queue limit " << options.maxQueuedJobs
+        << ", " << engine.getMaxConcurrentJobs() << " concurrent generations)" << std::endl;
+    return true;
+}
+
+void GenerationService::stop() {
+    // Release long-polls first, or the server's workers can't be joined
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    finishedCondition.notify_all();
+    server.stop();
+}
+
+std::string GenerationService::getBaseUrl() const {
+    return "http://127.0.0.1:" + std::to_string(server.getPort());
+}
+
+HttpServerResponse GenerationService::handleRequest(const HttpServerRequest& request) {
+    const std::string& path = request.path;
+
+    if (path == "/jobs" || path == "/jobs/") {
+        return request.method == "POST" ? createJob(request) : HttpServerResponse::text(405, "Method Not Allowed");
+    }
+
+    if (path == "/stats" && request.method == "GET") {
+        return getStatsResponse();
+    }
+
+    if (path.rfind("/jobs/", 0) != 0) {
+        return HttpServerResponse::text(404, "Not Found");
+    }
+
+    // /jobs/{id}[/image]
+    std::string rest = path.substr(6);
+    size_t slash = rest.find('/');
+    std::string id = rest.substr(0, slash);
+    std::string action = slash == std::string::npos ? "" : rest.substr(slash + 1);
+
+    if (action == "image" && request.method == "GET") {
+        return getImage(id);
+    }
+    if (!action.empty()) {
+        return HttpServerResponse::text(404, "Not Found");
+    }
+    if (request.method == "GET") {
+        int waitMs = std::atoi(request.queryParam("wait").c_str());
+        return getJob(id, std::clamp(waitMs, 0, MAX_WAIT_MS));
+    }
+    if (request.method == "DELETE") {
+        return deleteJob(id);
+    }
+    return HttpServerResponse::text(405, "Method Not Allowed");
+}
+
+HttpServerResponse GenerationService::createJob(const HttpServerRequest& request) {
+    BatchRunner::Row row;
+    row.client = request.header("x-client-id");
+    row.priority = JobPriority::INTERACTIVE;
+    BatchRunner::parseJsonRow(request.body, row);
+    if (!row.error.empty()) {
+        return errorResponse(400, row.error);
+    }
+
+    GenerationRequest generation;
+    generation.prompt = row.prompt;
+    generation.styleModifier = StyleCatalog::promptModifier(row.style);
+    generation.backend = hasPinnedBackend ? pinnedBackend : engine.routeCategory(row.category);
+    generation.orientation = row.orientation;
+    generation.client = row.client.empty() ? "service" : row.client;
+    generation.priority = row.priority;
+    generation.deadlineMs = row.deadlineMs;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        return errorResponse(503, "Shutting down");
+    }
+
+    // Bounded queue: shed load here instead of letting jobs wait unboundedly in the engine
+    if (unfinishedJobs >= options.maxQueuedJobs) {
+        stats.rejected++;
+        return errorResponse(429, "Queue full, retry later");
+    }
+
+    // Registered under the lock, so the completion can't run before the job exists
+    uint64_t jobId = engine.submit(generation, "", [this](const GenerationResult& result) {
+        onJobFinished(std::to_string(result.jobId), result);
+    });
+
+    std::string id = std::to_string(jobId);
+    ServiceJob& job = jobs[id];
+    job.jobId = jobId;
+    job.prompt = row.prompt;
+    job.style = StyleCatalog::styleKey(row.style);
+    job.category = StyleCatalog::categoryKey(row.category);
+    job.orientation = row.orientation == OrientationMode::LANDSCAPE ? "landscape" : "portrait";
+    unfinishedJobs++;
+    stats.accepted++;
+
+    json response = {
+        {"id", id},
+        {"status", "queued"},
+        {"url", "/jobs/" + id}
+    };
+    return HttpServerResponse::json(202, response.dump());
+}
+
+void GenerationService::onJobFinished(const std::string& id, const GenerationResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) {
+            return;
+        }
+
+        it->second.finished = true;
+        it->second.result = result;
+        unfinishedJobs--;
+        if (result.success) stats.completed++;
+        else if (result.cancelled) stats.cancelled++;
+        else stats.failed++;
+
+        finishedOrder.push_back(id);
+        while (finishedOrder.size() > options.maxFinishedJobs) {
+            jobs.erase(finishedOrder.front());
+            finishedOrder.pop_front();
+        }
+    }
+    finishedCondition.notify_all();
+}
+
+std::string GenerationService::jobJson(const std::string& id, const ServiceJob& job) const {
+    json response = {
+        {"id", id},
+        {"prompt", job.prompt},
+        {"style", job.style},
+        {"category", job.category},
+        {"orientation", job.orientation}
+    };
+
+    if (!job.finished) {
+        response["status"] = phaseName(engine.getJobPhase(job.jobId));
+        return response.dump();
+    }
+
+    const GenerationResult& result = job.result;
+    response["status"] = result.success ? "completed" : (result.cancelled ? "cancelled" : "failed");
+    response["error"] = result.error;
+    response["request_id"] = result.requestId;
+    response["polls"] = result.pollCount;
+    response["submitted_ms"] = result.submittedMs;
+    response["completed_ms"] = result.completedMs;
+    response["total_ms"] = result.totalMs;
+    if (result.success) {
+        response["image"] = "/jobs/" + id + "/image";
+    }
+    return response.dump();
+}
+
+HttpServerResponse GenerationService::getJob(const std::string& id, int waitMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    auto finishedOrGone = [&]() {
+        auto it = jobs.find(id);
+        return stopping || it == jobs.end() || it->second.finished;
+    };
+    // Every held GET ties up a worker thread; keep a quarter of them (at least one) free
+    size_t reserved = std::max<size_t>(1, options.workerThreads / 4);
+    size_t maxWaiters = options.workerThreads > reserved ? options.workerThreads - reserved : 0;
+    if (waitMs > 0 && waiters >= maxWaiters) {
+        stats.waitsRefused++;
+        waitMs = 0;
+    }
+    if (waitMs > 0) {
+        waiters++;
+        finishedCondition.wait_for(lock, std::chrono::milliseconds(waitMs), finishedOrGone);
+        waiters--;
+    }
+
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return errorResponse(404, "Unknown job");
+    }
+    return HttpServerResponse::json(200, jobJson(id, it->second));
+}
+
+HttpServerResponse GenerationService::getImage(const std::string& id) {
+    std::shared_ptr<const ByteBuffer> image;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) {
+            return errorResponse(404, "Unknown job");
+        }
+        if (!it->second.finished || !it->second.result.success) {
+            return errorResponse(409, "Job has no image");
+        }
+        image = it->second.result.imageData;
+    }
+
+    // Copied outside the lock; the buffer is shared and immutable
+    HttpServerResponse response;
+    response.status = 200;
+    response.contentType = imageContentType(*image);
+    response.body.assign(image->begin(), image->end());
+    return response;
+}
+
+HttpServerResponse GenerationService::deleteJob(const std::string& id) {
+    uint64_t jobId = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) {
+            return errorResponse(404, "Unknown job");
+        }
+
+        if (it->second.finished) {
+            jobs.erase(it);
+            finishedOrder.erase(std::remove(finishedOrder.begin(), finishedOrder.end(), id), finishedOrder.end());
+            return HttpServerResponse::json(200, json({ {"id", id}, {"status", "deleted"} }).dump());
+        }
+        jobId = it->second.jobId;
+    }
+
+    // Finishes as "cancelled" once the engine has stopped it
+    engine.cancel(jobId);
+    return HttpServerResponse::json(202, json({ {"id", id}, {"status", "cancelling"} }).dump());
+}
+
+HttpServerResponse GenerationService::getStatsResponse() {
+    Stats current = getStats();
+    json response;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        response["unfinished"] = unfinishedJobs;
+        response["retained"] = jobs.size();
+    }
+    response["queue_limit"] = options.maxQueuedJobs;
+    response["pending"] = engine.pendingJobCount();
+    response["active"] = engine.activeJobCount();
+    response["accepted"] = current.accepted;
+    response["rejected"] = current.rejected;
+    response["completed"] = current.completed;
+    response["failed"] = current.failed;
+    response["cancelled"] = current.cancelled;
+    response["waits_refused"] = current.waitsRefused;
+
+    JobScheduler::Stats scheduling = engine.getSchedulerStats();
+    const char* classNames[] = { "interactive", "batch" };
+    for (size_t i = 0; i < scheduling.classes.size(); i++) {
+        const JobScheduler::ClassStats& cls = scheduling.classes[i];
+        response["scheduler"][classNames[i]] = {
+            {"queued", cls.queued},
+            {"started", cls.started},
+            {"mean_wait_ms", cls.meanWaitMs},
+            {"max_wait_ms", cls.maxWaitMs},
+            {"oldest_wait_ms", cls.oldestWaitMs}
+        };
+    }
+    response["scheduler"]["queued_by_client"] = scheduling.queuedByClient;
+
+    response["keys"] = json::array();
+    for (const CredentialPool::KeyStats& key : FalApi::credentials().getStats()) {
+        response["keys"].push_back({
+            {"key", key.fingerprint},
+            {"limit", key.limit},
+            {"in_flight", key.inFlight},
+            {"peak_in_flight", key.peakInFlight},
+            {"submits", key.submits},
+            {"throttled", key.throttled},
+            {"utilization", key.utilization},
+            {"backoff_ms", key.backoffMs}
+        });
+    }
+
+    // Circuit state of each remote backend
+    for (size_t b = 0; b < static_cast<size_t>(BackendId::COUNT); b++) {
+        BackendId backend = static_cast<BackendId>(b);
+        if (!Backends::get(backend).isRemote()) {
+            continue;
+        }
+        CircuitBreaker::Stats circuit = engine.getCircuitBreaker().getStats(backend);
+        response["backends"][Backends::get(backend).name] = {
+            {"circuit", CircuitBreaker::stateName(circuit.state)},
+            {"consecutive_failures", circuit.consecutiveFailures},
+            {"failures", circuit.failures},
+            {"opens", circuit.opens},
+            {"rejected", circuit.rejected},
+            {"open_remaining_ms", circuit.openRemainingMs}
+        };
+    }
+    // Routing: what each remote backend has measured lately, and where each
+    // category's jobs went because of it
+    BackendRouter& router = engine.getRouter();
+    response["routing"]["target_ms"] = router.getOptions().targetMs;
+    for (const BackendRouter::BackendStats& backend : router.getBackendStats()) {
+        json histogram = json::array();
+        for (size_t i = 0; i < backend.histogram.size(); i++) {
+            histogram.push_back({
+                {"le_ms", i < BackendRouter::BUCKET_BOUNDS.size() ? json(BackendRouter::BUCKET_BOUNDS[i]) : json(nullptr)},
+                {"count", backend.histogram[i]}
+            });
+        }
+        response["routing"]["backends"][Backends::get(backend.backend).name] = {
+            {"samples", backend.samples},
+            {"error_rate", backend.errorRate},
+            {"p50_ms", backend.p50Ms},
+            {"p90_ms", backend.p90Ms},
+            {"meet_probability", backend.meetProbability},
+            {"histogram", histogram},
+            {"successes", backend.successes},
+            {"failures", backend.failures}
+        };
+    }
+    for (const BackendRouter::CategoryStats& category : router.getCategoryStats()) {
+        json routed = json::object();
+        for (size_t b = 0; b < category.routed.size(); b++) {
+            if (category.routed[b] > 0) {
+                routed[Backends::get(static_cast<BackendId>(b)).name] = category.routed[b];
+            }
+        }
+        response["routing"]["categories"][StyleCatalog::categoryKey(category.category)] = {
+            {"backend", Backends::get(category.lastChoice).name},
+            {"pinned", category.pinned},
+            {"decisions", category.decisions},
+            {"diverted", category.diverted},
+            {"routed", routed}
+        };
+    }
+    response["deadline_failures"] = engine.getDeadlineFailures();
+    return HttpServerResponse::json(200, response.dump());
+}
+
+GenerationService::Stats GenerationService::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void GenerationService::printStats() const {
+    Stats current = getStats();
+    std::cout << "Generation service: " << current.accepted << " accepted, " << current.rejected << " rejected (queue full), "
+        << current.completed << " completed, " << current.failed << " failed, " << current.cancelled << " cancelled";
+    if (current.waitsRefused > 0) {
+        std::cout << ", " << current.waitsRefused << " long-polls answered early (workers busy)";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "GenerationEngine.h"
+#include "HttpServer.h"
+
+// The generation pipeline as a local HTTP service that several tools can share
+// (--serve in main.cpp). Jobs run on the given engine, which must be shut down
+// before the service is destroyed; images are kept in memory.
+//   POST   /jobs                {"prompt", "category", "style", "orientation", "client", "priority", "deadline_ms"} -> 202 {"id", "status"}, 429 when full
+//                                (client defaults to the X-Client-Id header, then "service"; priority to "interactive";
+//                                 deadline_ms to the engine's two minutes)
+//   GET    /jobs/{id}[?wait=ms] -> job status; with wait, holds the request until the job finishes (long-poll).
+//                               A quarter of the workers (at least one) is never held this way; past that, wait is
+//                               ignored and the status comes back at once, so other requests still get served
+//   GET    /jobs/{id}/image     -> the encoded image once completed
+//   DELETE /jobs/{id}           -> cancels a running job, forgets a finished one
+//   GET    /stats               -> queue and job counts, scheduler queue depth and wait times, per-key load,
+//                               circuit state per backend, routing (latency histogram, error rate and
+//                               on-target odds per backend; chosen backend and decision counts per category)
+class GenerationService {
+public:
+    struct Options {
+        size_t maxQueuedJobs = 64;      // Unfinished jobs accepted before POST /jobs answers 429
+        size_t maxFinishedJobs = 128;   // Finished jobs (and their images) kept for GET; oldest dropped first
+        size_t workerThreads = 32;      // HTTP workers; each long-poll holds one
+        std::string backend;            // Overrides category routing (like FAL_BACKEND)
+    };
+
+    struct Stats {
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;      // Queue full
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint64_t cancelled = 0;
+        uint64_t waitsRefused = 0;  // Long-polls answered at once because too many were held
+    };
+
+    GenerationService(GenerationEngine& generationEngine, const Options& options);
+    ~GenerationService();
+
+    GenerationService(const GenerationService&) = delete;
+    GenerationService& operator=(const GenerationService&) = delete;
+
+    bool start(unsigned short port);
+    void stop();
+
+    unsigned short getPort() const { return server.getPort(); }
+    std::string getBaseUrl() const;
+    Stats getStats() const;
+    void printStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ServiceJob {
+        uint64_t jobId = 0;
+        std::string prompt;
+        std::string style;
+        std::string category;
+        std::string orientation;
+        bool finished = false;
+        GenerationResult result;
+    };
+
+    GenerationEngine& engine;
+    Options options;
+    HttpServer server;
+    bool hasPinnedBackend;
+    BackendId pinnedBackend;
+
+    // Guards everything below; finishedCondition wakes long-polls
+    mutable std::mutex mutex;
+    std::condition_variable finishedCondition;
+    std::map<std::string, ServiceJob> jobs;
+    std::deque<std::string> finishedOrder;     // For dropping the oldest finished jobs
+    size_t unfinishedJobs;
+    size_t waiters;                             // GETs currently held in a long-poll
+    bool stopping;
+    Stats stats;
+
+    // Longest a GET may wait for a job to finish
+    static constexpr int MAX_WAIT_MS = 30000;
+
+    HttpServerResponse handleRequest(const HttpServerRequest& request);
+    HttpServerResponse createJob(const HttpServerRequest& request);
+    HttpServerResponse getJob(const std::string& id, int waitMs);
+    HttpServerResponse getImage(const std::string& id);
+    HttpServerResponse deleteJob(const std::string& id);
+    HttpServerResponse getStatsResponse();
+
+    void onJobFinished(const std::string& id, const GenerationResult& result);
+    std::string jobJson(const std::string& id, const ServiceJob& job) const;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+// Enums shared by the UI and the generation pipeline
+
+enum class OrientationMode {
+    PORTRAIT,   // 9:16 (1296x2304)
+    LANDSCAPE   // 16:9 (2304x1296)
+};
+
+enum class StyleMode {
+    NONE,
+    // Legacy styles (for backward compatibility)
+    STUDIO_GHIBLI,
+    PHOTOREALISTIC,
+    // Artistic styles
+    IMPRESSIONISM,
+    ABSTRACT_EXPRESSIONISM,
+    CUBISM,
+    ART_DECO,
+    POP_ART,
+    REALISM_ART,
+    EXPRESSIONISM,
+    BAROQUE,
+    FAUVISM,
+    NEOCLASSICISM,
+    FUTURISM,
+    SURREALISM,
+    RENAISSANCE,
+    ACADEMIC_ART,
+    ANALYTICAL_ART,
+    BAUHAUS,
+    CONCEPTUAL_ART,
+    CONSTRUCTIVISM,
+    DADA,
+    GEOMETRIC_ABSTRACTION,
+    MINIMALISM_ART,
+    NEO_IMPRESSIONISM,
+    POST_IMPRESSIONISM,
+    // Interior design styles
+    MID_CENTURY_MODERN,
+    BOHEMIAN,
+    MINIMALISM_DESIGN,
+    SCANDINAVIAN,
+    ART_DECO_DESIGN,
+    FARMHOUSE,
+    INDUSTRIAL,
+    CONTEMPORARY,
+    TRADITIONAL,
+    RUSTIC,
+    TRANSITIONAL,
+    FRENCH_COUNTRY,
+    JAPANDI,
+    MEDITERRANEAN,
+    SHABBY_CHIC,
+    ECLECTIC,
+    REGENCY,
+    COASTAL,
+    MAXIMALISM,
+    // Gaming & Tech styles
+    CYBERPUNK,
+    SYNTHWAVE,
+    PIXEL_ART,
+    ANIME_MANGA,
+    SCI_FI_TECH,
+    RETRO_GAMING,
+    // Entertainment styles
+    MOVIE_POSTER,
+    FILM_NOIR,
+    CONCERT_POSTER,
+    SPORTS_MEMORABILIA,
+    VINTAGE_CINEMA,
+    // Professional styles
+    CORPORATE_MODERN,
+    ABSTRACT_CORPORATE,
+    NATURE_ZEN,
+    // Specialty Room styles
+    CULINARY_KITCHEN,
+    LIBRARY_ACADEMIC,
+    FITNESS_GYM,
+    KIDS_CARTOON,
+    // Landscape styles
+    PHOTOREALISTIC_LANDSCAPES,
+    SEASONAL_LANDSCAPES,
+    WEATHER_MOODS,
+    TIME_OF_DAY
+};
+
+enum class APIModel {
+    REALISM,        // FLUX schnell for photorealistic, fast generation
+    AESTHETIC,      // Playground v2.5 for artistic, aesthetic quality
+    ARTISTIC,       // FLUX LoRA for artistic styles with high quality
+    GAMING_TECH,    // FLUX LoRA for gaming and tech aesthetics
+    ENTERTAINMENT,  // FLUX LoRA for movie posters, film noir, etc.
+    PROFESSIONAL,   // FLUX schnell for corporate and professional themes
+    SPECIALTY_ROOMS,// FLUX LoRA for themed room content
+    LANDSCAPES      // FLUX schnell for photorealistic nature scenes
+};
+
+// Concrete generation backends (see Backends.h). APIModel above is the UI
+// category; several categories share one backend.
+enum class BackendId {
+    FLUX_SCHNELL,   // fal-ai/flux-1/schnell
+    PLAYGROUND_V25, // fal-ai/playground-v25
+    FLUX_LORA,      // fal-ai/flux-lora
+    OFFLINE,        // In-process procedural images, for tests and benchmarks
+    COUNT
+};
+
+// Scheduling class of a generation (see JobScheduler.h). Interactive work is
+// always started before batch work when both are waiting.
+enum class JobPriority {
+    INTERACTIVE,
+    BATCH,
+    COUNT
+};
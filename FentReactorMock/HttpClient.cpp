@@ -0,0 +1,225 @@
+#include "HttpClient.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    std::once_flag curlGlobalInitFlag;
+}
+
+HttpClient::HttpClient(bool enablePooling) :
+    share(nullptr), pooling(enablePooling), verifyPeer(true),
+    connectTimeoutMs(DEFAULT_CONNECT_TIMEOUT_MS), requestTimeoutMs(DEFAULT_REQUEST_TIMEOUT_MS) {
+    // curl_global_init is not thread-safe, so do it exactly once before any handle exists
+    std::call_once(curlGlobalInitFlag, []() {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+    });
+
+    if (!pooling) {
+        return;
+    }
+
+    share = curl_share_init();
+    if (!share) {
+        std::cout << "Warning: curl_share_init failed, connections will not be shared" << std::endl;
+        return;
+    }
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HttpClient::~HttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        for (CURL* curl : idleHandles) {
+            curl_easy_cleanup(curl);
+        }
+        idleHandles.clear();
+    }
+
+    if (share) {
+        curl_share_cleanup(share);
+    }
+}
+
+void HttpClient::lockShare(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* userptr) {
+    HttpClient* client = static_cast<HttpClient*>(userptr);
+    client->shareLocks[data].lock();
+}
+
+void HttpClient::unlockShare(CURL* /*handle*/, curl_lock_data data, void* userptr) {
+    HttpClient* client = static_cast<HttpClient*>(userptr);
+    client->shareLocks[data].unlock();
+}
+
+CURL* HttpClient::acquireHandle() {
+    CURL* curl = nullptr;
+
+    if (pooling) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!idleHandles.empty()) {
+            curl = idleHandles.back();
+            idleHandles.pop_back();
+        }
+    }
+
+    if (!curl) {
+        curl = curl_easy_init();
+        if (!curl) {
+            return nullptr;
+        }
+    }
+
+    if (share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    }
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    // Reset on release, so set again on every acquire
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, connectTimeoutMs);
+    if (!verifyPeer) {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    }
+
+    return curl;
+}
+
+void HttpClient::releaseHandle(CURL* curl) {
+    if (!curl) {
+        return;
+    }
+
+    if (pooling) {
+        // Reset clears per-request options but keeps the handle's live connections
+        curl_easy_reset(curl);
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (idleHandles.size() < MAX_IDLE_HANDLES) {
+            idleHandles.push_back(curl);
+            return;
+        }
+    }
+
+    curl_easy_cleanup(curl);
+}
+
+HttpResponse HttpClient::perform(CURL* curl, struct curl_slist* headers, std::string& body) {
+    HttpResponse response;
+
+    if (headers) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    if (requestTimeoutMs > 0) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, requestTimeoutMs);
+    }
+
+    response.result = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+
+    curl_slist_free_all(headers);
+    releaseHandle(curl);
+
+    response.body = std::move(body);
+    return response;
+}
+
+HttpResponse HttpClient::get(const std::string& url, const std::vector<std::string>& headers) {
+    CURL* curl = acquireHandle();
+    if (!curl) {
+        HttpResponse failed;
+        failed.result = CURLE_FAILED_INIT;
+        return failed;
+    }
+
+    struct curl_slist* headerList = nullptr;
+    for (const auto& header : headers) {
+        headerList = curl_slist_append(headerList, header.c_str());
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+
+    std::string body;
+    return perform(curl, headerList, body);
+}
+
+HttpResponse HttpClient::post(const std::string& url, const std::string& body, const std::vector<std::string>& headers) {
+    CURL* curl = acquireHandle();
+    if (!curl) {
+        HttpResponse failed;
+        failed.result = CURLE_FAILED_INIT;
+        return failed;
+    }
+
+    struct curl_slist* headerList = nullptr;
+    for (const auto& header : headers) {
+        headerList = curl_slist_append(headerList, header.c_str());
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+
+    std::string responseBody;
+    return perform(curl, headerList, responseBody);
+}
+
+bool HttpClient::downloadToMemory(const std::string& url, ByteBuffer& data) {
+    CURL* curl = acquireHandle();
+    if (!curl) {
+        return false;
+    }
+
+    data.clear();
+    DownloadSink sink{ curl, &data };
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, BufferWriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    applyStallTimeout(curl);
+
+    CURLcode res = curl_easy_perform(curl);
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    releaseHandle(curl);
+
+    return res == CURLE_OK && status >= 200 && status < 300 && !data.empty();
+}
+
+void HttpClient::setTimeouts(long connectMs, long requestMs) {
+    connectTimeoutMs = std::max(0L, connectMs);
+    requestTimeoutMs = std::max(0L, requestMs);
+}
+
+void HttpClient::applyStallTimeout(CURL* curl, long stallSeconds) {
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, stallSeconds);
+}
+
+size_t HttpClient::WriteCallback(void* contents, size_t size, size_t nmemb, std::string* data) {
+    size_t totalSize = size * nmemb;
+    data->append((char*)contents, totalSize);
+    return totalSize;
+}
+
+size_t HttpClient::BufferWriteCallback(char* contents, size_t size, size_t nmemb, void* userp) {
+    DownloadSink* sink = static_cast<DownloadSink*>(userp);
+    size_t totalSize = size * nmemb;
+
+    if (sink->buffer->empty()) {
+        // Allocate once for the whole image instead of growing chunk by chunk
+        curl_off_t expected = -1;
+        if (curl_easy_getinfo(sink->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &expected) == CURLE_OK &&
+            expected > 0 && expected <= MAX_RESERVE_BYTES) {
+            sink->buffer->reserve(static_cast<size_t>(expected));
+        }
+    }
+
+    sink->buffer->insert(sink->buffer->end(), contents, contents + totalSize);
+    return totalSize;
+}
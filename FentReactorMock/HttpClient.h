@@ -0,0 +1,92 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Raw downloaded bytes (encoded images)
+using ByteBuffer = std::vector<unsigned char>;
+
+struct HttpResponse {
+    CURLcode result = CURLE_OK;
+    long status = 0;
+    std::string body;
+
+    bool ok() const { return result == CURLE_OK && status >= 200 && status < 300; }
+};
+
+// Long-lived HTTP client used for all fal.ai traffic. DNS results and TLS sessions
+// are shared through a CURLSH handle, and easy handles are recycled instead of being
+// created per request. Each recycled handle keeps its open connection (or the multi
+// handle driving it keeps the pool), so a poll every couple of seconds reuses a warm
+// connection to queue.fal.run. The connection cache itself is not shared: libcurl
+// doesn't support sharing it between threads.
+class HttpClient {
+private:
+    CURLSH* share;
+    bool pooling;
+    bool verifyPeer;
+
+    // One lock per shared data type so DNS lookups don't serialize TLS session reuse
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+
+    // Idle easy handles ready for reuse
+    std::mutex poolMutex;
+    std::vector<CURL*> idleHandles;
+    static const size_t MAX_IDLE_HANDLES = 16;
+
+    // Don't trust a Content-Length beyond this when pre-sizing download buffers
+    static constexpr curl_off_t MAX_RESERVE_BYTES = 64 * 1024 * 1024;
+
+    // Without these a dead host or a stalled response blocks the caller indefinitely
+    long connectTimeoutMs;
+    long requestTimeoutMs;
+
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+
+    HttpResponse perform(CURL* curl, struct curl_slist* headers, std::string& body);
+
+public:
+    // enablePooling = false gives the old behaviour (fresh handle, no sharing) for comparison
+    explicit HttpClient(bool enablePooling = true);
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    // Borrow a configured easy handle (attached to the share) and hand it back when done
+    CURL* acquireHandle();
+    void releaseHandle(CURL* curl);
+
+    HttpResponse get(const std::string& url, const std::vector<std::string>& headers = {});
+    HttpResponse post(const std::string& url, const std::string& body, const std::vector<std::string>& headers = {});
+    bool downloadToMemory(const std::string& url, ByteBuffer& data);
+
+    // Connect timeout applies to every handle; the request timeout to get/post
+    // (downloads instead abort when the transfer stalls, see applyStallTimeout)
+    void setTimeouts(long connectMs, long requestMs);
+    long getRequestTimeoutMs() const { return requestTimeoutMs; }
+
+    // Abort a transfer that moves less than 1 KB/s for this long, without capping
+    // the total time of a large but healthy download
+    static void applyStallTimeout(CURL* curl, long stallSeconds = DOWNLOAD_STALL_SECONDS);
+
+    static constexpr long DEFAULT_CONNECT_TIMEOUT_MS = 10000;
+    static constexpr long DEFAULT_REQUEST_TIMEOUT_MS = 30000;
+    static constexpr long DOWNLOAD_STALL_SECONDS = 15;
+
+    // Allows benchmarking against a local stand-in with a self-signed certificate
+    void setVerifyPeer(bool verify) { verifyPeer = verify; }
+    bool isPooling() const { return pooling; }
+
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* data);
+
+    // Write target for BufferWriteCallback; the handle is used to size the buffer from Content-Length
+    struct DownloadSink {
+        CURL* curl = nullptr;
+        ByteBuffer* buffer = nullptr;
+    };
+    static size_t BufferWriteCallback(char* contents, size_t size, size_t nmemb, void* userp);
+};
@@ -0,0 +1,289 @@
+#include "HttpServer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        size_t start = text.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(start, end - start + 1);
+    }
+
+    std::string urlDecode(const std::string& text) {
+        std::string decoded;
+        decoded.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '%' && i + 2 < text.size() &&
+                std::isxdigit(static_cast<unsigned char>(text[i + 1])) &&
+                std::isxdigit(static_cast<unsigned char>(text[i + 2]))) {
+                decoded += static_cast<char>(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else if (text[i] == '+') {
+                decoded += ' ';
+            }
+            else {
+                decoded += text[i];
+            }
+        }
+        return decoded;
+    }
+}
+
+std::string HttpServerRequest::header(const std::string& name) const {
+    auto it = headers.find(toLower(name));
+    return it != headers.end() ? it->second : "";
+}
+
+std::string HttpServerRequest::queryParam(const std::string& name) const {
+    std::stringstream ss(query);
+    std::string pair;
+    while (std::getline(ss, pair, '&')) {
+        size_t eq = pair.find('=');
+        std::string key = urlDecode(pair.substr(0, eq));
+        if (key == name) {
+            return eq == std::string::npos ? "" : urlDecode(pair.substr(eq + 1));
+        }
+    }
+    return "";
+}
+
+HttpServerResponse HttpServerResponse::json(int status, const std::string& body) {
+    HttpServerResponse response;
+    response.status = status;
+    response.contentType = "application/json";
+    response.body = body;
+    return response;
+}
+
+HttpServerResponse HttpServerResponse::text(int status, const std::string& body) {
+    HttpServerResponse response;
+    response.status = status;
+    response.contentType = "text/plain";
+    response.body = body;
+    return response;
+}
+
+HttpServer::HttpServer(HttpRequestHandler requestHandler, size_t workerThreads) :
+    handler(std::move(requestHandler)),
+    workerCount(workerThreads > 0 ? workerThreads : 1),
+    running(false),
+    port(0) {
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+bool HttpServer::start(unsigned short listenPort, const sf::IpAddress& address) {
+    if (running) {
+        return true;
+    }
+
+    if (listener.listen(listenPort, address) != sf::Socket::Status::Done) {
+        std::cout << "HTTP server: could not listen on " << address.toString() << ":" << listenPort << std::endl;
+        return false;
+    }
+
+    port = listener.getLocalPort();
+    running = true;
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&HttpServer::workerLoop, this);
+    }
+    acceptThread = std::thread(&HttpServer::acceptLoop, this);
+
+    std::cout << "HTTP server listening on port " << port << std::endl;
+    return true;
+}
+
+void HttpServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+
+    queueCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        connections.clear();
+    }
+    listener.close();
+}
+
+void HttpServer::acceptLoop() {
+    sf::SocketSelector selector;
+    selector.add(listener);
+
+    while (running) {
+        // Wake up regularly so stop() doesn't hang in accept()
+        if (!selector.wait(sf::milliseconds(200))) {
+            continue;
+        }
+
+        auto socket = std::make_unique<sf::TcpSocket>();
+        if (listener.accept(*socket) != sf::Socket::Status::Done) {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (connections.size() < MAX_QUEUED_CONNECTIONS) {
+                connections.push_back(std::move(socket));
+            }
+        }
+
+        if (socket) {
+            // Every worker is busy and the backlog is full - shed load
+            writeResponse(*socket, HttpServerResponse::text(503, "Service Unavailable"));
+            socket->disconnect();
+            continue;
+        }
+        queueCondition.notify_one();
+    }
+}
+
+void HttpServer::workerLoop() {
+    while (true) {
+        std::unique_ptr<sf::TcpSocket> socket;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return !running || !connections.empty(); });
+            if (!running) {
+                return;
+            }
+            socket = std::move(connections.front());
+            connections.pop_front();
+        }
+
+        handleConnection(*socket);
+        socket->disconnect();
+    }
+}
+
+void HttpServer::handleConnection(sf::TcpSocket& socket) {
+    HttpServerRequest request;
+    if (!readRequest(socket, request)) {
+        writeResponse(socket, HttpServerResponse::text(400, "Bad Request"));
+        return;
+    }
+
+    HttpServerResponse response;
+    try {
+        response = handler(request);
+    }
+    catch (const std::exception& e) {
+        std::cout << "HTTP server: handler error for " << request.path << ": " << e.what() << std::endl;
+        response = HttpServerResponse::text(500, "Internal Server Error");
+    }
+
+    writeResponse(socket, response);
+}
+
+bool HttpServer::readRequest(sf::TcpSocket& socket, HttpServerRequest& request) {
+    std::string data;
+    char buffer[8192];
+    size_t headerEnd = std::string::npos;
+    size_t contentLength = 0;
+
+    sf::SocketSelector selector;
+    selector.add(socket);
+
+    while (true) {
+        if (headerEnd == std::string::npos) {
+            headerEnd = data.find("\r\n\r\n");
+
+            if (headerEnd != std::string::npos) {
+                std::stringstream head(data.substr(0, headerEnd));
+                std::string line;
+
+                // Request line: METHOD target HTTP/1.1
+                std::getline(head, line);
+                std::stringstream requestLine(line);
+                std::string target;
+                requestLine >> request.method >> target;
+
+                size_t queryStart = target.find('?');
+                request.path = target.substr(0, queryStart);
+                request.query = queryStart == std::string::npos ? "" : target.substr(queryStart + 1);
+
+                while (std::getline(head, line)) {
+                    size_t colon = line.find(':');
+                    if (colon == std::string::npos) continue;
+                    request.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+                }
+
+                std::string lengthHeader = request.header("content-length");
+                contentLength = static_cast<size_t>(std::strtoull(lengthHeader.c_str(), nullptr, 10));
+                if (contentLength > MAX_REQUEST_BYTES) {
+                    return false;
+                }
+            }
+        }
+
+        if (headerEnd != std::string::npos && data.size() >= headerEnd + 4 + contentLength) {
+            break;
+        }
+
+        if (data.size() > MAX_REQUEST_BYTES || !selector.wait(sf::seconds(5))) {
+            return false;
+        }
+
+        size_t received = 0;
+        if (socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Status::Done) {
+            return false;
+        }
+        data.append(buffer, received);
+    }
+
+    request.body = data.substr(headerEnd + 4, contentLength);
+    return !request.method.empty();
+}
+
+void HttpServer::writeResponse(sf::TcpSocket& socket, const HttpServerResponse& response) {
+    std::string head = "HTTP/1.1 " + std::to_string(response.status) + " " + statusText(response.status) + "\r\n" +
+        "Content-Type: " + response.contentType + "\r\n" +
+        "Content-Length: " + std::to_string(response.body.size()) + "\r\n" +
+        "Connection: close\r\n\r\n";
+
+    socket.send(head.data(), head.size());
+    if (!response.body.empty()) {
+        socket.send(response.body.data(), response.body.size());
+    }
+}
+
+std::string HttpServer::statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct HttpServerRequest {
+    std::string method;
+    std::string path;       // Without the query string
+    std::string query;      // Raw text after '?'
+    std::map<std::string, std::string> headers;     // Lower-cased names
+    std::string body;
+
+    std::string header(const std::string& name) const;
+    std::string queryParam(const std::string& name) const;
+};
+
+struct HttpServerResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+
+    static HttpServerResponse json(int status, const std::string& body);
+    static HttpServerResponse text(int status, const std::string& body);
+};
+
+using HttpRequestHandler = std::function<HttpServerResponse(const HttpServerRequest&)>;
+
+// Minimal blocking HTTP/1.1 server on sf::TcpListener for local endpoints
+// (webhook receiver, mock API, service mode). One request per connection;
+// accepted connections are handed to a fixed pool of worker threads.
+class HttpServer {
+private:
+    sf::TcpListener listener;
+    HttpRequestHandler handler;
+    std::thread acceptThread;
+    std::vector<std::thread> workers;
+    size_t workerCount;
+    std::atomic<bool> running;
+    unsigned short port;
+
+    // Accepted connections waiting for a worker
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<std::unique_ptr<sf::TcpSocket>> connections;
+
+    static constexpr size_t MAX_REQUEST_BYTES = 16 * 1024 * 1024;
+    static constexpr size_t MAX_QUEUED_CONNECTIONS = 1024;
+
+    void acceptLoop();
+    void workerLoop();
+    void handleConnection(sf::TcpSocket& socket);
+    bool readRequest(sf::TcpSocket& socket, HttpServerRequest& request);
+    void writeResponse(sf::TcpSocket& socket, const HttpServerResponse& response);
+
+public:
+    explicit HttpServer(HttpRequestHandler requestHandler, size_t workerThreads = 1);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Binds and starts serving on a background thread; port 0 picks a free port.
+    // Listens on every interface unless given one.
+    bool start(unsigned short listenPort, const sf::IpAddress& address = sf::IpAddress::Any);
+    void stop();
+    unsigned short getPort() const { return port; }
+
+    static std::string statusText(int status);
+};
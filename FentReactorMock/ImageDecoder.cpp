@@ -0,0 +1,77 @@
+#include "ImageDecoder.h"
+#include <algorithm>
+#include <iostream>
+
+ImageDecoder::ImageDecoder(size_t workerThreads) :
+    running(true) {
+    for (size_t i = 0; i < std::max<size_t>(1, workerThreads); i++) {
+        workers.emplace_back(&ImageDecoder::workerLoop, this);
+    }
+}
+
+ImageDecoder::~ImageDecoder() {
+    stop();
+}
+
+void ImageDecoder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+
+    condition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ImageDecoder::submit(const GenerationResult& result) {
+    if (!result.success || !result.imageData) {
+        decoded.push(Decoded{ result, nullptr, {} });
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(result);
+    }
+    condition.notify_one();
+}
+
+void ImageDecoder::workerLoop() {
+    while (true) {
+        GenerationResult result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return !running || !pending.empty(); });
+            if (!running) {
+                return;
+            }
+            result = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        // CPU-only decode into an sf::Image; no GL context needed
+        auto image = std::make_unique<sf::Image>();
+        if (!image->loadFromMemory(result.imageData->data(), result.imageData->size())) {
+            std::cout << "Failed to decode image for job " << result.jobId << std::endl;
+            image.reset();
+        }
+
+        std::vector<std::unique_ptr<sf::Image>> moreImages;
+        for (size_t i = 1; i < result.images.size(); i++) {
+            auto candidate = std::make_unique<sf::Image>();
+            if (!candidate->loadFromMemory(result.images[i]->data(), result.images[i]->size())) {
+                std::cout << "Failed to decode candidate " << i + 1 << " for job " << result.jobId << std::endl;
+                candidate.reset();
+            }
+            moreImages.push_back(std::move(candidate));
+        }
+
+        decoded.push(Decoded{ std::move(result), std::move(image), std::move(moreImages) });
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "GenerationEngine.h"
+#include "MpscQueue.h"
+
+// Decodes finished generations on worker threads so the UI thread never runs a
+// JPEG decode. Results come back through a lock-free queue that the render loop
+// drains once per frame; all that is left for it is the texture upload.
+class ImageDecoder {
+public:
+    struct Decoded {
+        GenerationResult result;
+        std::unique_ptr<sf::Image> image;   // Null if the job failed or the bytes didn't decode
+        // Further candidates of a multi-image result, matching result.images[1..];
+        // one that didn't decode is null
+        std::vector<std::unique_ptr<sf::Image>> moreImages;
+    };
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<GenerationResult> pending;
+    bool running;
+
+    MpscQueue<Decoded> decoded;
+
+    void workerLoop();
+
+public:
+    explicit ImageDecoder(size_t workerThreads = 2);
+    ~ImageDecoder();
+
+    ImageDecoder(const ImageDecoder&) = delete;
+    ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+    // Thread-safe; safe to call from a completion callback. Failed results skip
+    // the workers and are handed straight back.
+    void submit(const GenerationResult& result);
+
+    // UI thread only. Calls f(Decoded&) for everything finished since the last call.
+    template <typename F>
+    size_t drain(F&& f) {
+        return decoded.drain(std::forward<F>(f));
+    }
+
+    void stop();
+};
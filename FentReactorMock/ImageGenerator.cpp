@@ -1,4 +1,5 @@
 #include "ImageGenerator.h"
+#include "StyleCatalog.h"
 #include <chrono>
 #include <fstream>
 
@@ -6,6 +7,7 @@ using json = nlohmann::json;
 
 ImageGenerator::ImageGenerator() : window(sf::VideoMode({ 1024, 768 }), "AI Image Generator", sf::Style::Default),
 currentState(AppState::INPUT_SCREEN),
+generationEngine(httpClient),
 selectedStyle(StyleMode::NONE),
 selectedModel(APIModel::REALISM),
 promptActive(false),
@@ -20,7 +22,6 @@ ghibliLabel(font),
 photorealisticLabel(font),
 generateLabel(font),
 newImageLabel(font),
-loadingText(font),
 artisticGroupLabel(font),
 interiorGroupLabel(font),
 stylesGroupLabel(font),
@@ -32,9 +33,13 @@ saveImageLabel(font),
 backToMainLabel(font),
 portraitTabLabel(font),
 landscapeTabLabel(font),
+sweepsTabLabel(font),
+sweepLabel(font),
 galleryHeaderLabel(font),
 galleryInfoLabel(font),
 showingPortraitGallery(true),
+showingSweeps(false),
+sweepPage(0),
 galleryScrollOffset(0),
 viewingFromGallery(false),
 artisticScrollOffset(0),
@@ -52,7 +57,21 @@ backToGalleryLabel(font),
 imageSavedIndicator(font),
 showImageSavedIndicator(false),
 imageAlreadySavedCache(false),
-imageAlreadySavedCacheValid(false) {
+imageAlreadySavedCacheValid(false),
+hasPinnedBackend(false),
+pinnedBackend(BackendId::FLUX_SCHNELL),
+draftPreviews(false),
+draftMode(DraftMode::ALONGSIDE),
+viewingDraftOf(0),
+candidatesPerRequest(1),
+pickingCandidate(false),
+candidatesLabel(font),
+speculationBudget(0),
+speculationsStarted(0),
+speculationHits(0),
+speculationsDropped(0),
+nextSweepCell(0),
+sweepInFlight(0) {
 
     if (!font.openFromFile("Yrsa-Regular.ttf")) {
         // Try to load a system font as fallback
@@ -68,6 +87,69 @@ imageAlreadySavedCacheValid(false) {
     // Setup view for proper aspect ratio handling
     setupView();
 
+    // Allow the number of simultaneous generations to be tuned
+    if (const char* maxJobs = std::getenv("FAL_MAX_CONCURRENT_JOBS")) {
+        int limit = std::atoi(maxJobs);
+        if (limit > 0) {
+            generationEngine.setMaxConcurrentJobs(static_cast<size_t>(limit));
+        }
+    }
+
+    // Learned completion times survive restarts so the first poll is well placed immediately
+    generationEngine.getPollScheduler().setStatsFile("poll_stats.json");
+
+    // Repeat requests come back from disk instead of paying for a new generation
+    generationEngine.getResultCache().openFromEnvironment();
+
+    // Pick up generations a previous run paid for but never downloaded. They are
+    // written to recovered/ (and land in the result cache for an instant re-generate).
+    if (generationEngine.getJournal().open("jobs.journal")) {
+        for (const JobJournal::Entry& entry : generationEngine.getJournal().getUnfinished()) {
+            std::string outputFile = entry.outputFile;
+            if (outputFile.empty()) {
+                std::filesystem::create_directories("recovered");
+                outputFile = "recovered/" + entry.requestId + ".jpg";
+            }
+
+            generationEngine.resume(entry, outputFile, [](const GenerationResult& result) {
+                if (result.success) {
+                    std::cout << "Recovered image from an interrupted generation: " << result.filename << std::endl;
+                }
+            });
+        }
+    }
+
+    // Route every category to one backend, e.g. FAL_BACKEND=offline to run without the API
+    std::string backendName;
+    bool knownBackend = Backends::pinFromEnvironment(backendName, hasPinnedBackend, pinnedBackend);
+    if (!backendName.empty()) {
+        std::cout << (knownBackend ? "Using backend: " : "Unknown FAL_BACKEND, ignoring: ") << backendName << std::endl;
+    }
+
+    // Show a draft within a second or two while the full render runs. "ahead" only
+    // starts the full render once the draft is in, so rejecting it costs less.
+    if (const char* draft = std::getenv("FAL_DRAFT")) {
+        std::string mode = draft;
+        draftPreviews = mode == "alongside" || mode == "ahead";
+        draftMode = mode == "ahead" ? DraftMode::AHEAD : DraftMode::ALONGSIDE;
+        std::cout << (draftPreviews ? "Draft previews: " : "Unknown FAL_DRAFT, ignoring: ") << mode << std::endl;
+    }
+
+    // Several candidates per generation for the price of one queue wait
+    if (const char* candidates = std::getenv("FAL_CANDIDATES")) {
+        candidatesPerRequest = std::max(1, std::min(std::atoi(candidates), FalApi::MAX_IMAGES));
+        std::cout << "Candidates per generation: " << candidatesPerRequest << std::endl;
+    }
+
+    // Render the other orientation in the background too, up to n times
+    if (const char* speculate = std::getenv("FAL_SPECULATE")) {
+        speculationBudget = std::max(0, std::atoi(speculate));
+        std::cout << "Speculative orientation renders: up to " << speculationBudget << std::endl;
+    }
+
+    // Let fal.ai push completions instead of being polled, when a reachable port is configured
+    webhookListener = WebhookListener::startFromEnvironment(generationEngine);
+
     // Initialize all category models - 8 total categories
     modelNames = { "Realism", "Aesthetic", "Artistic", "Gaming & Tech", "Entertainment", "Professional", "Specialty Rooms", "Landscapes" };
 
@@ -211,8 +293,12 @@ void ImageGenerator::initializeArtisticStyles() {
 void ImageGenerator::run() {
     while (window.isOpen()) {
         handleEvents();
+        dropStaleSpeculation();
+        processCompletedJobs();
+        processSweepResults();
         render();
     }
+    printSpeculationStats();
 }
 
 void ImageGenerator::runCommandLine(const std::string& prompt, const std::string& style) {
@@ -222,87 +308,60 @@ void ImageGenerator::runCommandLine(const std::string& prompt, const std::string
     // Set the prompt and style
     userPrompt = prompt;
 
-    // Convert style string to enum
-    if (style == "studio_ghibli") selectedStyle = StyleMode::STUDIO_GHIBLI;
-    else if (style == "photorealistic") selectedStyle = StyleMode::PHOTOREALISTIC;
-    else selectedStyle = StyleMode::NONE;
+    // Convert style string to enum; the category follows the style as in the UI
+    if (!StyleCatalog::styleFromKey(style, selectedStyle)) {
+        std::cout << "Unknown style, generating without one (see --list-styles)" << std::endl;
+        selectedStyle = StyleMode::NONE;
+    }
+    selectedModel = StyleCatalog::defaultCategory(selectedStyle);
 
     // Generate and display image
     generateImage();
 
     // Wait for generation to complete
-    while (currentState == AppState::LOADING) {
+    while (!trayJobs.empty() && !trayJobs.back().finished) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        processCompletedJobs();
     }
 
-    currentState = AppState::IMAGE_DISPLAY;
+    generationEngine.getPollScheduler().printStats();
+    generationEngine.getResultCache().printStats();
+    generationEngine.getRouter().printStats();
+    if (webhookListener) {
+        std::cout << "Webhook completions: " << generationEngine.getWebhookCompletions()
+            << ", polling fallbacks: " << generationEngine.getPollingFallbacks() << std::endl;
+    }
+
+    if (!trayJobs.empty() && trayJobs.back().success) {
+        openTrayJob(trayJobs.size() - 1);
+    }
     run(); // Show GUI with generated image
 }
 
 std::string ImageGenerator::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&time_t);
-
-    std::stringstream ss;
-    ss << std::put_time(&tm, "%Y-%m-%d_%H-%M-%S");
-    return ss.str();
+    return Gallery::timestamp();
 }
 
 std::string ImageGenerator::getCategoryName(APIModel model) {
-    switch (model) {
-    case APIModel::REALISM: return "Realism";
-    case APIModel::AESTHETIC: return "Aesthetic";
-    case APIModel::ARTISTIC: return "Artistic";
-    case APIModel::GAMING_TECH: return "Gaming & Tech";
-    case APIModel::ENTERTAINMENT: return "Entertainment";
-    case APIModel::PROFESSIONAL: return "Professional";
-    case APIModel::SPECIALTY_ROOMS: return "Specialty Rooms";
-    case APIModel::LANDSCAPES: return "Landscapes";
-    default: return "Unknown";
-    }
+    return StyleCatalog::categoryName(model);
 }
 
 std::string ImageGenerator::getStyleName(StyleMode style) {
-    switch (style) {
-    case StyleMode::STUDIO_GHIBLI: return "Studio Ghibli";
-    case StyleMode::PHOTOREALISTIC: return "Photorealistic";
-    case StyleMode::IMPRESSIONISM: return "Impressionism";
-    case StyleMode::ABSTRACT_EXPRESSIONISM: return "Abstract Expressionism";
-    case StyleMode::CUBISM: return "Cubism";
-    case StyleMode::CYBERPUNK: return "Cyberpunk";
-    case StyleMode::SYNTHWAVE: return "Synthwave";
-    case StyleMode::PIXEL_ART: return "Pixel Art";
-    case StyleMode::ANIME_MANGA: return "Anime/Manga";
-    case StyleMode::SCI_FI_TECH: return "Sci-Fi Tech";
-    case StyleMode::RETRO_GAMING: return "Retro Gaming";
-    case StyleMode::MOVIE_POSTER: return "Movie Poster";
-    case StyleMode::FILM_NOIR: return "Film Noir";
-    case StyleMode::CONCERT_POSTER: return "Concert Poster";
-    case StyleMode::SPORTS_MEMORABILIA: return "Sports Memorabilia";
-    case StyleMode::VINTAGE_CINEMA: return "Vintage Cinema";
-    case StyleMode::CORPORATE_MODERN: return "Corporate Modern";
-    case StyleMode::ABSTRACT_CORPORATE: return "Abstract Corporate";
-    case StyleMode::NATURE_ZEN: return "Nature/Zen";
-    case StyleMode::CULINARY_KITCHEN: return "Culinary/Kitchen";
-    case StyleMode::LIBRARY_ACADEMIC: return "Library/Academic";
-    case StyleMode::FITNESS_GYM: return "Fitness/Gym";
-    case StyleMode::KIDS_CARTOON: return "Kids/Cartoon";
-    case StyleMode::PHOTOREALISTIC_LANDSCAPES: return "Photorealistic Landscapes";
-    case StyleMode::SEASONAL_LANDSCAPES: return "Seasonal Landscapes";
-    case StyleMode::WEATHER_MOODS: return "Weather Moods";
-    case StyleMode::TIME_OF_DAY: return "Time of Day";
-    case StyleMode::NONE: return "None";
-    default: return "Custom Style";
-    }
+    return StyleCatalog::styleName(style);
 }
 
 void ImageGenerator::saveCurrentImage() {
-    if (currentGeneratedImagePath.empty()) {
+    if (!currentImageData) {
         std::cout << "No image to save" << std::endl;
         return;
     }
 
+    // The low-res draft is not the image; the final takes its place when it lands
+    if (viewingDraftOf != 0) {
+        std::cout << "Draft previews can't be saved, wait for the final image" << std::endl;
+        return;
+    }
+
     // Check if already saved
     if (isImageAlreadySaved()) {
         std::cout << "Image already saved" << std::endl;
@@ -310,16 +369,16 @@ void ImageGenerator::saveCurrentImage() {
     }
 
     // Check if we need to remove old images
-    if (savedImages.size() >= MAX_SAVED_IMAGES) {
+    if (countSavedImages() >= MAX_SAVED_IMAGES) {
         cleanupOldestImages();
     }
-    if (currentGeneratedImagePath.empty()) {
+    if (!currentImageData) {
         std::cout << "No image to save" << std::endl;
         return;
     }
 
     // Check if we need to remove old images
-    if (savedImages.size() >= MAX_SAVED_IMAGES) {
+    if (countSavedImages() >= MAX_SAVED_IMAGES) {
         cleanupOldestImages();
     }
 
@@ -332,9 +391,14 @@ void ImageGenerator::saveCurrentImage() {
     std::string orientation = (globalOrientation == OrientationMode::PORTRAIT) ? "portrait" : "landscape";
     std::string savedFilename = "saved/" + orientation + "/" + orientation + "_" + timestamp + ".jpg";
 
-    // Copy the generated image to saved location
+    // Write the downloaded bytes straight to the saved location
     try {
-        std::filesystem::copy_file(currentGeneratedImagePath, savedFilename);
+        std::ofstream imageFile(savedFilename, std::ios::binary);
+        imageFile.write(reinterpret_cast<const char*>(currentImageData->data()), currentImageData->size());
+        imageFile.close();
+        if (!imageFile) {
+            throw std::runtime_error("could not write " + savedFilename);
+        }
         std::cout << "Image saved to: " << savedFilename << std::endl;
 
         // Create saved image metadata
@@ -347,8 +411,7 @@ void ImageGenerator::saveCurrentImage() {
             (globalOrientation == OrientationMode::LANDSCAPE)
         );
 
-        savedImages.push_back(savedImg);
-        saveSavedImagesMetadata();
+        saveSavedImagesMetadata({ savedImg });
 
         std::cout << "Saved image metadata. Total saved: " << savedImages.size() << std::endl;
     }
@@ -369,11 +432,13 @@ void ImageGenerator::saveCurrentImage() {
 void ImageGenerator::cleanupOldestImages() {
     if (savedImages.empty()) return;
 
-    // Find oldest image
-    auto oldest = std::min_element(savedImages.begin(), savedImages.end(),
-        [](const SavedImage& a, const SavedImage& b) {
-            return a.timestamp < b.timestamp;
-        });
+    // Find oldest image; sweeps are managed from their contact sheet and never evicted here
+    auto oldest = savedImages.end();
+    for (auto it = savedImages.begin(); it != savedImages.end(); ++it) {
+        if (it->sweepId.empty() && (oldest == savedImages.end() || it->timestamp < oldest->timestamp)) {
+            oldest = it;
+        }
+    }
 
     if (oldest != savedImages.end()) {
         // Delete the file
@@ -390,67 +455,58 @@ void ImageGenerator::cleanupOldestImages() {
     }
 }
 
-void ImageGenerator::loadSavedImages() {
-    savedImages.clear();
+size_t ImageGenerator::countSavedImages() const {
+    // Images saved by hand; sweep output does not count towards MAX_SAVED_IMAGES
+    return static_cast<size_t>(std::count_if(savedImages.begin(), savedImages.end(),
+        [](const SavedImage& img) { return img.sweepId.empty(); }));
+}
 
-    std::ifstream file("saved/saved_images.json");
-    if (!file.is_open()) {
-        std::cout << "No saved images metadata found, starting fresh" << std::endl;
+void ImageGenerator::loadSavedImages() {
+    std::string error;
+    if (!Gallery::load(savedImages, error)) {
+        std::cout << error << ", starting fresh" << std::endl;
         return;
     }
 
-    try {
-        json j;
-        file >> j;
-
-        for (const auto& item : j["saved_images"]) {
-            SavedImage img;
-            img.filename = item["filename"];
-            img.prompt = item["prompt"];
-            img.category = item["category"];
-            img.style = item["style"];
-            img.timestamp = item["timestamp"];
-            img.isLandscape = item["isLandscape"];
-
-            // Verify file still exists
-            if (std::filesystem::exists(img.filename)) {
-                savedImages.push_back(img);
-            }
-        }
+    std::cout << "Loaded " << savedImages.size() << " saved images" << std::endl;
+}
 
-        std::cout << "Loaded " << savedImages.size() << " saved images" << std::endl;
+void ImageGenerator::saveSavedImagesMetadata(const std::vector<SavedImage>& added) {
+    // Merged with the file rather than overwriting it: a headless sweep may have
+    // added images since it was read. Deleted images drop out with their files.
+    std::vector<SavedImage> merged;
+    if (Gallery::append(added, &merged)) {
+        savedImages = std::move(merged);
+        std::cout << "Saved images metadata updated" << std::endl;
     }
-    catch (const std::exception& e) {
-        std::cout << "Error loading saved images: " << e.what() << std::endl;
+    else {
+        savedImages.insert(savedImages.end(), added.begin(), added.end());
+        std::cout << "Could not write " << Gallery::METADATA_PATH << std::endl;
     }
 }
 
-void ImageGenerator::saveSavedImagesMetadata() {
-    std::filesystem::create_directories("saved");
-
-    json j;
-    j["saved_images"] = json::array();
-
-    for (const auto& img : savedImages) {
-        json imgJson;
-        imgJson["filename"] = img.filename;
-        imgJson["prompt"] = img.prompt;
-        imgJson["category"] = img.category;
-        imgJson["style"] = img.style;
-        imgJson["timestamp"] = img.timestamp;
-        imgJson["isLandscape"] = img.isLandscape;
-        j["saved_images"].push_back(imgJson);
-    }
-
-    std::ofstream file("saved/saved_images.json");
-    file << j.dump(4);
-    std::cout << "Saved images metadata updated" << std::endl;
-}
-
 std::vector<SavedImage> ImageGenerator::getCurrentGalleryImages() {
     std::vector<SavedImage> filtered;
 
+    if (showingSweeps) {
+        // One sweep in cell order (the index is part of the file name)
+        std::string sweepId = shownSweepId();
+        for (const auto& img : savedImages) {
+            if (!sweepId.empty() && img.sweepId == sweepId) {
+                filtered.push_back(img);
+            }
+        }
+        std::sort(filtered.begin(), filtered.end(),
+            [](const SavedImage& a, const SavedImage& b) {
+                return a.filename.substr(a.filename.rfind('/') + 1) < b.filename.substr(b.filename.rfind('/') + 1);
+            });
+        return filtered;
+    }
+
     for (const auto& img : savedImages) {
+        if (!img.sweepId.empty()) {
+            continue; // Shown on their sweep's contact sheet
+        }
         if (showingPortraitGallery && !img.isLandscape) {
             filtered.push_back(img);
         }
@@ -468,9 +524,26 @@ std::vector<SavedImage> ImageGenerator::getCurrentGalleryImages() {
     return filtered;
 }
 
+ImageGenerator::GalleryGrid ImageGenerator::galleryGrid() const {
+    if (showingSweeps) {
+        return { 6, 140.0f, 14.0f, 57.0f };
+    }
+    return { 4, 200.0f, 30.0f, 50.0f };
+}
+
 void ImageGenerator::updateGalleryDisplay() {
     auto currentImages = getCurrentGalleryImages();
 
+    if (showingSweeps) {
+        // The contact sheet loads its own small thumbnails a few per frame
+        galleryThumbnails.clear();
+        galleryThumbnailSprites.clear();
+        galleryInfoLabel.setString("No sweeps yet - enter a prompt, pick a category and press Sweep");
+        sf::FloatRect sweepInfoBounds = galleryInfoLabel.getLocalBounds();
+        galleryInfoLabel.setPosition({ (1024 - sweepInfoBounds.size.x) / 2, 300 });
+        return;
+    }
+
     std::string countText = std::to_string(currentImages.size()) + " saved " +
         (showingPortraitGallery ? "portrait" : "landscape") + " images";
 
@@ -532,22 +605,13 @@ void ImageGenerator::viewSavedImage(const SavedImage& savedImg) {
     if (imageTexture.loadFromFile(savedImg.filename)) {
         std::cout << "Viewing saved image: " << savedImg.filename << std::endl;
         imageSprite.setTexture(imageTexture, true);
-
-        // Scale image to fit screen while maintaining aspect ratio
-        float scaleX = 1024.0f / imageTexture.getSize().x;
-        float scaleY = 768.0f / imageTexture.getSize().y;
-        float scale = std::min(scaleX, scaleY);
-        imageSprite.setScale({ scale, scale });
-
-        // Center the image
-        sf::FloatRect spriteBounds = imageSprite.getGlobalBounds();
-        float posX = (1024 - spriteBounds.size.x) / 2;
-        float posY = (768 - spriteBounds.size.y) / 2;
-        imageSprite.setPosition({ posX, posY });
+        fitImageSprite();
 
         // Update button positions based on image orientation
         updateImageDisplayButtonPositions();
 
+        clearCandidates();
+
         // Store the current viewing image metadata
         currentViewingImage = savedImg;
         viewingFromGallery = true; // CRITICAL: Only set to true when viewing from gallery
@@ -679,12 +743,10 @@ void ImageGenerator::restoreImageMetadata(const SavedImage& savedImg) {
 }
 
 void ImageGenerator::updateLoadingSpinner() {
-    if (currentState == AppState::LOADING) {
-        // Rotate spinner based on elapsed time
-        float elapsed = spinnerClock.getElapsedTime().asSeconds();
-        spinnerRotation = elapsed * 360.0f; // One full rotation per second
-        loadingSpinner.setRotation(sf::degrees(spinnerRotation));
-    }
+    // Rotate spinner based on elapsed time; drawn on job tray cards that are still running
+    float elapsed = spinnerClock.getElapsedTime().asSeconds();
+    spinnerRotation = elapsed * 360.0f; // One full rotation per second
+    loadingSpinner.setRotation(sf::degrees(spinnerRotation));
 }
 
 bool ImageGenerator::isImageAlreadySaved() {
@@ -694,11 +756,11 @@ bool ImageGenerator::isImageAlreadySaved() {
     }
 
     // Add one-time debug output when cache is being calculated
-    std::cout << "Calculating isImageAlreadySaved - currentGeneratedImagePath: '"
-        << currentGeneratedImagePath << "'" << std::endl;
+    std::cout << "Calculating isImageAlreadySaved - have image data: "
+        << (currentImageData ? "yes" : "no") << std::endl;
 
-    if (currentGeneratedImagePath.empty()) {
-        std::cout << "Path is empty, returning false" << std::endl;
+    if (!currentImageData) {
+        std::cout << "No image data, returning false" << std::endl;
         imageAlreadySavedCache = false;
         imageAlreadySavedCacheValid = true;
         return false;
@@ -713,7 +775,8 @@ bool ImageGenerator::isImageAlreadySaved() {
         << "', Style='" << currentStyle << "', Landscape=" << currentIsLandscape << std::endl;
 
     for (const auto& img : savedImages) {
-        if (img.prompt == currentPrompt &&
+        if (img.sweepId.empty() &&
+            img.prompt == currentPrompt &&
             img.category == currentCategory &&
             img.style == currentStyle &&
             img.isLandscape == currentIsLandscape) {
@@ -770,7 +833,7 @@ void ImageGenerator::showImageSavedNotification() {
 }
 
 void ImageGenerator::checkGalleryFull() {
-    if (savedImages.size() >= MAX_SAVED_IMAGES - 2) { // Show warning at 48/50
+    if (countSavedImages() >= MAX_SAVED_IMAGES - 2) { // Show warning at 48/50
         showGalleryFullWarning = true;
         warningClock.restart();
     }
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <map>
 #include <sstream>
 #include <thread>
 #include <future>
@@ -12,123 +13,50 @@
 #include <fstream>
 #include <algorithm>
 #include <iomanip>
+#include <memory>
+#include <mutex>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
+#include "HttpClient.h"
+#include "Backends.h"
+#include "GenerationTypes.h"
+#include "GenerationEngine.h"
+#include "Gallery.h"
+#include "ImageDecoder.h"
+#include "MpscQueue.h"
+#include "SweepRunner.h"
+#include "WebhookListener.h"
 
 enum class AppState {
     INPUT_SCREEN,
-    LOADING,
     IMAGE_DISPLAY,
     GALLERY_SCREEN
 };
 
-enum class OrientationMode {
-    PORTRAIT,   // 9:16 (1296x2304)
-    LANDSCAPE   // 16:9 (2304x1296)
-};
-
-struct SavedImage {
-    std::string filename;
+// A generation running in the background, shown as a card in the job tray
+struct TrayJob {
+    uint64_t jobId = 0;
     std::string prompt;
-    std::string category;
-    std::string style;
-    std::string timestamp;
-    bool isLandscape;
-
-    // Constructor
-    SavedImage() = default;
-    SavedImage(const std::string& fname, const std::string& p, const std::string& cat,
-        const std::string& st, const std::string& ts, bool landscape)
-        : filename(fname), prompt(p), category(cat), style(st), timestamp(ts), isLandscape(landscape) {}
-};
-
-enum class StyleMode {
-    NONE,
-    // Legacy styles (for backward compatibility)
-    STUDIO_GHIBLI,
-    PHOTOREALISTIC,
-    // Artistic styles
-    IMPRESSIONISM,
-    ABSTRACT_EXPRESSIONISM,
-    CUBISM,
-    ART_DECO,
-    POP_ART,
-    REALISM_ART,
-    EXPRESSIONISM,
-    BAROQUE,
-    FAUVISM,
-    NEOCLASSICISM,
-    FUTURISM,
-    SURREALISM,
-    RENAISSANCE,
-    ACADEMIC_ART,
-    ANALYTICAL_ART,
-    BAUHAUS,
-    CONCEPTUAL_ART,
-    CONSTRUCTIVISM,
-    DADA,
-    GEOMETRIC_ABSTRACTION,
-    MINIMALISM_ART,
-    NEO_IMPRESSIONISM,
-    POST_IMPRESSIONISM,
-    // Interior design styles
-    MID_CENTURY_MODERN,
-    BOHEMIAN,
-    MINIMALISM_DESIGN,
-    SCANDINAVIAN,
-    ART_DECO_DESIGN,
-    FARMHOUSE,
-    INDUSTRIAL,
-    CONTEMPORARY,
-    TRADITIONAL,
-    RUSTIC,
-    TRANSITIONAL,
-    FRENCH_COUNTRY,
-    JAPANDI,
-    MEDITERRANEAN,
-    SHABBY_CHIC,
-    ECLECTIC,
-    REGENCY,
-    COASTAL,
-    MAXIMALISM,
-    // Gaming & Tech styles
-    CYBERPUNK,
-    SYNTHWAVE,
-    PIXEL_ART,
-    ANIME_MANGA,
-    SCI_FI_TECH,
-    RETRO_GAMING,
-    // Entertainment styles
-    MOVIE_POSTER,
-    FILM_NOIR,
-    CONCERT_POSTER,
-    SPORTS_MEMORABILIA,
-    VINTAGE_CINEMA,
-    // Professional styles
-    CORPORATE_MODERN,
-    ABSTRACT_CORPORATE,
-    NATURE_ZEN,
-    // Specialty Room styles
-    CULINARY_KITCHEN,
-    LIBRARY_ACADEMIC,
-    FITNESS_GYM,
-    KIDS_CARTOON,
-    // Landscape styles
-    PHOTOREALISTIC_LANDSCAPES,
-    SEASONAL_LANDSCAPES,
-    WEATHER_MOODS,
-    TIME_OF_DAY
-};
-
-enum class APIModel {
-    REALISM,        // FLUX schnell for photorealistic, fast generation
-    AESTHETIC,      // Playground v2.5 for artistic, aesthetic quality
-    ARTISTIC,       // FLUX LoRA for artistic styles with high quality
-    GAMING_TECH,    // FLUX LoRA for gaming and tech aesthetics
-    ENTERTAINMENT,  // FLUX LoRA for movie posters, film noir, etc.
-    PROFESSIONAL,   // FLUX schnell for corporate and professional themes
-    SPECIALTY_ROOMS,// FLUX LoRA for themed room content
-    LANDSCAPES      // FLUX schnell for photorealistic nature scenes
+    APIModel category = APIModel::REALISM;
+    StyleMode style = StyleMode::NONE;
+    OrientationMode orientation = OrientationMode::PORTRAIT;
+    sf::Clock elapsed;
+    bool finished = false;
+    bool success = false;
+    float totalSeconds = 0;
+    std::string error;
+    std::shared_ptr<const ByteBuffer> imageData;
+    std::unique_ptr<sf::Texture> texture;   // Decoded result; the card shows it scaled down
+
+    // The other candidates of a multi-image job (FAL_CANDIDATES), in the backend's order
+    std::vector<std::shared_ptr<const ByteBuffer>> moreImageData;
+    std::vector<std::unique_ptr<sf::Texture>> moreTextures;
+
+    // Draft preview (FAL_DRAFT), shown until the final image replaces it
+    uint64_t draftJobId = 0;
+    std::unique_ptr<sf::Texture> draftTexture;
+    std::shared_ptr<const ByteBuffer> draftData;
+    bool firstPixelLogged = false;
 };
 
 class ImageGenerator {
@@ -210,6 +138,71 @@ private:
     APIModel selectedModel;
     std::vector<std::string> modelNames;
 
+    // Shared HTTP client (pooled connections to fal.ai); the generation engine sends everything through it
+    HttpClient httpClient;
+
+    // Decodes finished images off the UI thread; declared before the engine so it
+    // outlives the engine's completion callbacks
+    ImageDecoder imageDecoder;
+
+    // Finished sweep cells, pushed from the engine's I/O thread and drained once
+    // per frame; declared before the engine for the same reason as imageDecoder
+    MpscQueue<GenerationResult> sweepResults;
+
+    // Async generation engine (single curl_multi I/O thread)
+    GenerationEngine generationEngine;
+
+    // FAL_BACKEND=<name> sends every category to one backend (e.g. "offline")
+    bool hasPinnedBackend;
+    BackendId pinnedBackend;
+
+    // FAL_DRAFT=alongside|ahead sends a quick low-resolution draft with each generation
+    bool draftPreviews;
+    DraftMode draftMode;
+    uint64_t viewingDraftOf;    // Tray job whose draft is on screen; its final replaces it
+
+    // FAL_CANDIDATES=n asks for n images per generation (one submission, one queue
+    // wait). The image display opens on a grid of them; picking one shows it as usual.
+    int candidatesPerRequest;
+    std::vector<sf::Texture> candidateTextures;     // Candidates of the job on screen; empty for a single image
+    std::vector<std::shared_ptr<const ByteBuffer>> candidateData;
+    bool pickingCandidate;
+    sf::RectangleShape candidatesButton;
+    sf::Text candidatesLabel;
+
+    // FAL_SPECULATE=n: each generation also renders the other orientation at batch
+    // priority, up to n times per session, so flipping the orientation and
+    // generating again is answered at once. The speculative job lives outside the
+    // tray until it is used, and is cancelled if the prompt, style or category changes.
+    int speculationBudget;          // Speculative renders left
+    TrayJob speculativeJob;         // jobId 0 when there is none
+    uint64_t speculationsStarted;
+    uint64_t speculationHits;       // Generations answered by the speculative render
+    uint64_t speculationsDropped;   // Cancelled or failed before being used
+
+    // Job tray (main thread only). Completion callbacks run on the engine's I/O
+    // thread and only hand the result to imageDecoder.
+    std::vector<TrayJob> trayJobs;
+    static const int MAX_TRAY_JOBS = 6;
+
+    // Sweep: the prompt across every style of the selected category in both
+    // orientations (main thread only). Cells are handed to the engine a few at a
+    // time so interactive generations are never stuck behind the whole sweep.
+    std::string activeSweepId;
+    std::string sweepPrompt;
+    std::vector<SweepRunner::Cell> sweepCells;
+    std::vector<BackendId> sweepBackends;
+    size_t nextSweepCell;
+    size_t sweepInFlight;
+    std::map<uint64_t, size_t> sweepJobs;   // Engine job id -> cell index
+    std::unique_ptr<SweepRunner::Progress> sweepProgress;
+    static const int SWEEP_CONCURRENCY = 4;
+    sf::RectangleShape sweepButton;
+    sf::Text sweepLabel;
+
+    // Optional fal.ai webhook receiver (FAL_WEBHOOK_PORT); declared after the engine so it stops first
+    std::unique_ptr<WebhookListener> webhookListener;
+
     // Generate button
     sf::RectangleShape generateButton;
     sf::Text generateLabel;
@@ -220,9 +213,6 @@ private:
     sf::RectangleShape newImageButton;
     sf::Text newImageLabel;
 
-    // Loading
-    sf::Text loadingText;
-
     // Scrolling for styles
     float artisticScrollOffset;
     bool artisticScrollActive;
@@ -236,7 +226,8 @@ private:
     // Saved images system
     std::vector<SavedImage> savedImages;
     static const int MAX_SAVED_IMAGES = 50;
-    std::string currentGeneratedImagePath;
+    // Encoded bytes of the image on screen; only written to disk when the user saves it
+    std::shared_ptr<const ByteBuffer> currentImageData;
 
     // Gallery UI elements
     sf::RectangleShape galleryButton;
@@ -249,17 +240,23 @@ private:
     sf::Text portraitTabLabel;
     sf::RectangleShape landscapeTabButton;
     sf::Text landscapeTabLabel;
+    sf::RectangleShape sweepsTabButton;
+    sf::Text sweepsTabLabel;
     sf::Text galleryHeaderLabel;
     sf::Text galleryInfoLabel;
 
     // Gallery navigation
     bool showingPortraitGallery;
+    bool showingSweeps;         // Sweeps tab: the contact sheet of one sweep
+    size_t sweepPage;           // Which sweep it shows, 0 = newest
     int galleryScrollOffset;
     sf::RectangleShape galleryScrollArea;
 
     // Gallery thumbnails
     std::vector<sf::Texture> galleryThumbnails;
     std::vector<sf::Sprite> galleryThumbnailSprites;
+    // Contact sheet cells, scaled down once on the GPU and kept by file name
+    std::map<std::string, sf::Texture> contactSheetThumbnails;
     SavedImage currentViewingImage;
     bool viewingFromGallery;
 
@@ -319,7 +316,6 @@ private:
     void updateCategoryStylePositions();
     void generateImage();
     void renderInputScreen();
-    void renderLoadingScreen();
     void renderImageDisplay();
     void renderGalleryScreen();
     void updateImageDisplayButtonPositions();
@@ -327,14 +323,49 @@ private:
     // Spinner methods
     void updateLoadingSpinner();
 
+    // Job tray methods
+    void processCompletedJobs();
+    void renderJobTray();
+    bool handleJobTrayClick(sf::Vector2f mousePos);
+    void openTrayJob(size_t index);
+    void openTrayDraft(size_t index);
+    void removeTrayJob(size_t index);
+    bool isTrayFull() const;
+    sf::FloatRect trayCardBounds(size_t index) const;
+    void fitImageSprite();
+
+    // Candidate picker methods
+    void clearCandidates();
+    sf::FloatRect candidateCellBounds(size_t index) const;
+    void showCandidate(size_t index);
+    void renderCandidatePicker();
+    bool handleCandidatePickerClick(sf::Vector2f mousePos);
+
+    // Speculation methods
+    void startSpeculation(const GenerationRequest& request);
+    bool adoptSpeculation();
+    void dropStaleSpeculation();
+    void dropSpeculation(const char* reason);
+    void printSpeculationStats() const;
+
+    // Sweep methods
+    void startSweep();
+    void processSweepResults();
+    void updateSweepLabel();
+    void renderContactSheet();
+    void loadContactSheetThumbnails(size_t maxToLoad);
+    std::vector<std::string> listSweeps();
+    std::string shownSweepId();
+
     // Saved images methods
     void saveCurrentImage();
     void loadSavedImages();
-    void saveSavedImagesMetadata();
+    void saveSavedImagesMetadata(const std::vector<SavedImage>& added = {});   // Merges with the file; refreshes savedImages
     std::string getCurrentTimestamp();
     std::string getCategoryName(APIModel model);
     std::string getStyleName(StyleMode style);
     void cleanupOldestImages();
+    size_t countSavedImages() const;
     void deleteCurrentViewingImage();
     void showImageSavedNotification();
     void checkGalleryFull();
@@ -342,6 +373,13 @@ private:
     void invalidateAlreadySavedCache();
 
     // Gallery methods
+    struct GalleryGrid {
+        int perRow;
+        float cellSize;
+        float spacing;
+        float startX;
+    };
+    GalleryGrid galleryGrid() const;
     void updateGalleryDisplay();
     std::vector<SavedImage> getCurrentGalleryImages();
     void loadGalleryThumbnails();
@@ -349,14 +387,7 @@ private:
     void restoreImageMetadata(const SavedImage& savedImg);
 
     // API methods
-    std::string makeAPIRequest(const std::string& prompt, const std::string& styleModifier, APIModel model);
-    std::string pollRequestStatus(const std::string& requestId, APIModel model);
-    bool downloadImage(const std::string& imageUrl, const std::string& filename);
     std::string getStylePromptModifier(StyleMode style);
-    APIModel getAPIForModel(APIModel selectedModel);
-
-    // HTTP callback for curl
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* data);
 
 public:
     ImageGenerator();
@@ -0,0 +1,89 @@
+#include "ImageGenerator.h"
+
+namespace {
+    // The grid fills the screen above the bottom button row
+    const float GRID_LEFT = 20.0f;
+    const float GRID_TOP = 50.0f;
+    const float GRID_WIDTH = 984.0f;
+    const float GRID_HEIGHT = 630.0f;
+    const float GRID_SPACING = 16.0f;
+}
+
+void ImageGenerator::clearCandidates() {
+    candidateTextures.clear();
+    candidateData.clear();
+    pickingCandidate = false;
+}
+
+sf::FloatRect ImageGenerator::candidateCellBounds(size_t index) const {
+    // Two side by side; three or four in a 2x2 grid
+    int rows = candidateTextures.size() > 2 ? 2 : 1;
+    float cellWidth = (GRID_WIDTH - GRID_SPACING) / 2;
+    float cellHeight = (GRID_HEIGHT - (rows - 1) * GRID_SPACING) / rows;
+    return sf::FloatRect({ GRID_LEFT + (index % 2) * (cellWidth + GRID_SPACING), GRID_TOP + (index / 2) * (cellHeight + GRID_SPACING) },
+        { cellWidth, cellHeight });
+}
+
+void ImageGenerator::showCandidate(size_t index) {
+    imageTexture = candidateTextures[index];
+    imageTexture.setSmooth(false);
+    imageSprite.setTexture(imageTexture, true);
+    fitImageSprite();
+
+    // Saving writes this candidate's bytes unchanged
+    currentImageData = candidateData[index];
+    pickingCandidate = false;
+    invalidateAlreadySavedCache();
+    std::cout << "Picked candidate " << index + 1 << " of " << candidateTextures.size() << std::endl;
+}
+
+void ImageGenerator::renderCandidatePicker() {
+    sf::Text headerText(font);
+    headerText.setString("Pick one of " + std::to_string(candidateTextures.size()) + " candidates");
+    headerText.setCharacterSize(18);
+    headerText.setFillColor(sf::Color(200, 200, 200));
+    sf::FloatRect headerBounds = headerText.getLocalBounds();
+    headerText.setPosition({ (1024 - headerBounds.size.x) / 2, 15 });
+    window.draw(headerText);
+
+    sf::Vector2f mousePos = getLogicalMousePosition(sf::Mouse::getPosition(window));
+
+    for (size_t i = 0; i < candidateTextures.size(); i++) {
+        sf::FloatRect cell = candidateCellBounds(i);
+
+        // Fitted into the cell, keeping the aspect ratio
+        sf::Sprite sprite(candidateTextures[i]);
+        sf::Vector2u size = candidateTextures[i].getSize();
+        float scale = std::min(cell.size.x / size.x, cell.size.y / size.y);
+        sprite.setScale({ scale, scale });
+        sprite.setPosition({ cell.position.x + (cell.size.x - size.x * scale) / 2,
+            cell.position.y + (cell.size.y - size.y * scale) / 2 });
+        window.draw(sprite);
+
+        sf::RectangleShape border(cell.size);
+        border.setPosition(cell.position);
+        border.setFillColor(sf::Color::Transparent);
+        border.setOutlineThickness(cell.contains(mousePos) ? 3 : 1);
+        border.setOutlineColor(cell.contains(mousePos) ? selectedButtonColor : sf::Color(100, 100, 100));
+        window.draw(border);
+
+        sf::Text numberText(font);
+        numberText.setString(std::to_string(i + 1));
+        numberText.setCharacterSize(16);
+        numberText.setFillColor(sf::Color::White);
+        numberText.setOutlineColor(sf::Color::Black);
+        numberText.setOutlineThickness(1);
+        numberText.setPosition({ cell.position.x + 8, cell.position.y + 4 });
+        window.draw(numberText);
+    }
+}
+
+bool ImageGenerator::handleCandidatePickerClick(sf::Vector2f mousePos) {
+    for (size_t i = 0; i < candidateTextures.size(); i++) {
+        if (candidateCellBounds(i).contains(mousePos)) {
+            showCandidate(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -102,6 +102,11 @@ void ImageGenerator::handleInputScreenEvents(sf::Event& event) {
     sf::Vector2f mousePos = getLogicalMousePosition(screenMousePos);
 
     if (const auto* mousePressed = event.getIf<sf::Event::MouseButtonPressed>()) {
+        // Job tray cards sit above everything else on this screen
+        if (handleJobTrayClick(mousePos)) {
+            return;
+        }
+
         // Check prompt box click
         if (promptBox.getGlobalBounds().contains(mousePos)) {
             promptActive = true;
@@ -229,10 +234,11 @@ void ImageGenerator::handleInputScreenEvents(sf::Event& event) {
 
         // Check generate button  
         if (generateButton.getGlobalBounds().contains(mousePos)) {
-            if (!userPrompt.empty()) {
-                viewingFromGallery = false; // Reset flag before generation
-                currentGeneratedImagePath = ""; // CRITICAL: Clear previous path
-                hasGeneratedImage = false; // Reset this flag too
+            if (!userPrompt.empty() && isTrayFull()) {
+                std::cout << "Job tray is full - open or dismiss a result first" << std::endl;
+            }
+            else if (!userPrompt.empty()) {
+                // Runs in the background; the image on screen (if any) stays available
                 generateImage();
             }
         }
@@ -250,6 +256,16 @@ void ImageGenerator::handleInputScreenEvents(sf::Event& event) {
                 (globalOrientation == OrientationMode::PORTRAIT ? "Portrait" : "Landscape") << std::endl;
         }
 
+        // Check sweep button
+        if (sweepButton.getGlobalBounds().contains(mousePos)) {
+            if (sweepProgress && !sweepProgress->isDone()) {
+                std::cout << "A sweep is already running: " << sweepProgress->describe() << std::endl;
+            }
+            else if (!userPrompt.empty()) {
+                startSweep();
+            }
+        }
+
         // Check gallery button
         if (galleryButton.getGlobalBounds().contains(mousePos)) {
             // DO NOT restore any metadata when going to gallery
@@ -313,6 +329,17 @@ void ImageGenerator::handleImageDisplayEvents(sf::Event& event) {
         sf::Vector2i screenMousePos = sf::Mouse::getPosition(window);
         sf::Vector2f mousePos = getLogicalMousePosition(screenMousePos);
 
+        if (pickingCandidate && handleCandidatePickerClick(mousePos)) {
+            return;
+        }
+
+        // Back to the grid of candidates
+        if (!pickingCandidate && !viewingFromGallery && candidateTextures.size() > 1 &&
+            candidatesButton.getGlobalBounds().contains(mousePos)) {
+            pickingCandidate = true;
+            return;
+        }
+
         // Only show gallery/delete buttons if viewing from gallery
         if (viewingFromGallery) {
             // Back to gallery button
@@ -340,8 +367,8 @@ void ImageGenerator::handleImageDisplayEvents(sf::Event& event) {
             currentState = AppState::INPUT_SCREEN;
         }
 
-        // Save Image button - ONLY when NOT viewing from gallery
-        if (!viewingFromGallery && saveImageButton.getGlobalBounds().contains(mousePos)) {
+        // Save Image button - ONLY when NOT viewing from gallery, and never for a draft
+        if (!viewingFromGallery && !pickingCandidate && viewingDraftOf == 0 && saveImageButton.getGlobalBounds().contains(mousePos)) {
             saveCurrentImage();
         }
     }
@@ -352,6 +379,10 @@ void ImageGenerator::handleGalleryScreenEvents(sf::Event& event) {
         sf::Vector2i screenMousePos = sf::Mouse::getPosition(window);
         sf::Vector2f mousePos = getLogicalMousePosition(screenMousePos);
 
+        if (handleJobTrayClick(mousePos)) {
+            return;
+        }
+
         // Back to main button
         if (backToMainButton.getGlobalBounds().contains(mousePos)) {
             // DO NOT restore metadata when going back to main from gallery
@@ -362,27 +393,52 @@ void ImageGenerator::handleGalleryScreenEvents(sf::Event& event) {
         // Portrait tab button
         if (portraitTabButton.getGlobalBounds().contains(mousePos)) {
             showingPortraitGallery = true;
+            showingSweeps = false;
             galleryScrollOffset = 0;
             portraitTabButton.setFillColor(selectedButtonColor);
             landscapeTabButton.setFillColor(buttonColor);
+            sweepsTabButton.setFillColor(buttonColor);
             updateGalleryDisplay();
         }
 
         // Landscape tab button
         if (landscapeTabButton.getGlobalBounds().contains(mousePos)) {
             showingPortraitGallery = false;
+            showingSweeps = false;
             galleryScrollOffset = 0;
             portraitTabButton.setFillColor(buttonColor);
             landscapeTabButton.setFillColor(selectedButtonColor);
+            sweepsTabButton.setFillColor(buttonColor);
+            updateGalleryDisplay();
+        }
+
+        // Sweeps tab: the newest sweep's contact sheet; clicking again steps to older ones
+        if (sweepsTabButton.getGlobalBounds().contains(mousePos)) {
+            if (showingSweeps) {
+                size_t sweeps = listSweeps().size();
+                sweepPage = sweeps > 0 ? (sweepPage + 1) % sweeps : 0;
+            }
+            else {
+                // Headless sweeps (--sweep) may have added images since startup
+                loadSavedImages();
+                showingSweeps = true;
+                sweepPage = 0;
+            }
+            galleryScrollOffset = 0;
+            portraitTabButton.setFillColor(buttonColor);
+            landscapeTabButton.setFillColor(buttonColor);
+            sweepsTabButton.setFillColor(selectedButtonColor);
             updateGalleryDisplay();
+            return;
         }
 
         // Check thumbnail clicks
         auto currentImages = getCurrentGalleryImages();
-        int imagesPerRow = 4;
-        float thumbnailSize = 200.0f;
-        float spacing = 30.0f;
-        float startX = 50.0f;
+        GalleryGrid grid = galleryGrid();
+        int imagesPerRow = grid.perRow;
+        float thumbnailSize = grid.cellSize;
+        float spacing = grid.spacing;
+        float startX = grid.startX;
         float startY = 200.0f - galleryScrollOffset;
 
         for (size_t i = 0; i < currentImages.size(); i++) {
@@ -410,9 +466,11 @@ void ImageGenerator::handleGalleryScreenEvents(sf::Event& event) {
 
         if (galleryScrollArea.getGlobalBounds().contains(logicalMousePos)) {
             auto currentImages = getCurrentGalleryImages();
-            int imagesPerRow = 4;
+            GalleryGrid grid = galleryGrid();
+            int imagesPerRow = grid.perRow;
             int rows = (currentImages.size() + imagesPerRow - 1) / imagesPerRow;
-            int maxScroll = std::max(0, (rows * 230) - static_cast<int>(galleryScrollArea.getSize().y));
+            int rowHeight = static_cast<int>(grid.cellSize + grid.spacing);
+            int maxScroll = std::max(0, (rows * rowHeight) - static_cast<int>(galleryScrollArea.getSize().y));
 
             galleryScrollOffset -= static_cast<int>(mouseWheel->delta * 30);
             galleryScrollOffset = std::max(0, std::min(maxScroll, galleryScrollOffset));
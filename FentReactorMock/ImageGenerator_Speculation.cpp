@@ -0,0 +1,108 @@
+#include "ImageGenerator.h"
+
+namespace {
+    OrientationMode flipped(OrientationMode orientation) {
+        return orientation == OrientationMode::PORTRAIT ? OrientationMode::LANDSCAPE : OrientationMode::PORTRAIT;
+    }
+
+    const char* orientationName(OrientationMode orientation) {
+        return orientation == OrientationMode::PORTRAIT ? "portrait" : "landscape";
+    }
+}
+
+void ImageGenerator::startSpeculation(const GenerationRequest& request) {
+    if (speculationBudget <= 0 && speculationsStarted == 0) {
+        return; // Not enabled
+    }
+
+    // Already rendering exactly what this one would ask for
+    OrientationMode other = flipped(request.orientation);
+    if (speculativeJob.jobId && speculativeJob.prompt == userPrompt && speculativeJob.style == selectedStyle &&
+        speculativeJob.category == selectedModel && speculativeJob.orientation == other) {
+        return;
+    }
+
+    if (speculativeJob.jobId) {
+        dropSpeculation("superseded");
+    }
+
+    if (speculationBudget <= 0) {
+        std::cout << "Speculation budget spent, not rendering " << orientationName(other) << " ahead" << std::endl;
+        return;
+    }
+
+    // Same prompt, style and backend; batch priority keeps it behind anything the user asked for
+    GenerationRequest speculative = request;
+    speculative.orientation = other;
+    speculative.priority = JobPriority::BATCH;
+
+    speculativeJob = TrayJob();
+    speculativeJob.prompt = userPrompt;
+    speculativeJob.category = selectedModel;
+    speculativeJob.style = selectedStyle;
+    speculativeJob.orientation = other;
+    speculativeJob.firstPixelLogged = true;     // Nobody is waiting on it (yet)
+    speculativeJob.jobId = generationEngine.submit(speculative, "", [this](const GenerationResult& result) {
+        imageDecoder.submit(result);
+    });
+
+    speculationBudget--;
+    speculationsStarted++;
+    std::cout << "Rendering " << orientationName(other) << " ahead (job " << speculativeJob.jobId << ", "
+        << speculationBudget << " speculative renders left)" << std::endl;
+}
+
+bool ImageGenerator::adoptSpeculation() {
+    if (!speculativeJob.jobId || speculativeJob.prompt != userPrompt || speculativeJob.style != selectedStyle ||
+        speculativeJob.category != selectedModel || speculativeJob.orientation != globalOrientation ||
+        (speculativeJob.finished && !speculativeJob.success)) {
+        return false;
+    }
+
+    // Into the tray as if it had just been submitted. A job still running keeps
+    // its batch priority; it has a head start either way.
+    speculationHits++;
+    bool ready = speculativeJob.finished;
+    std::cout << "Using the speculative " << orientationName(speculativeJob.orientation) << " render ("
+        << (ready ? "ready" : "still running") << "), hit " << speculationHits << " of " << speculationsStarted << std::endl;
+
+    trayJobs.push_back(std::move(speculativeJob));
+    speculativeJob = TrayJob();
+
+    if (ready) {
+        openTrayJob(trayJobs.size() - 1);
+    }
+    return true;
+}
+
+void ImageGenerator::dropStaleSpeculation() {
+    if (!speculativeJob.jobId) {
+        return;
+    }
+
+    if (speculativeJob.finished && !speculativeJob.success) {
+        dropSpeculation("failed");
+    }
+    else if (speculativeJob.prompt != userPrompt || speculativeJob.style != selectedStyle ||
+        speculativeJob.category != selectedModel) {
+        dropSpeculation("prompt changed");
+    }
+}
+
+void ImageGenerator::dropSpeculation(const char* reason) {
+    if (!speculativeJob.finished) {
+        generationEngine.cancel(speculativeJob.jobId);
+    }
+    speculationsDropped++;
+    std::cout << "Dropped speculative " << orientationName(speculativeJob.orientation) << " render (" << reason << ")" << std::endl;
+    speculativeJob = TrayJob();
+}
+
+void ImageGenerator::printSpeculationStats() const {
+    if (speculationsStarted == 0) {
+        return;
+    }
+    std::cout << "Speculation: " << speculationsStarted << " renders, " << speculationHits << " used ("
+        << static_cast<int>(100.0 * speculationHits / speculationsStarted + 0.5) << "% hit rate), "
+        << speculationsDropped << " dropped, " << speculationBudget << " left in budget" << std::endl;
+}
@@ -0,0 +1,262 @@
+#include "ImageGenerator.h"
+#include "StyleCatalog.h"
+
+namespace {
+    std::string shorten(const std::string& text, size_t maxChars) {
+        return text.size() > maxChars ? text.substr(0, maxChars - 3) + "..." : text;
+    }
+}
+
+void ImageGenerator::startSweep() {
+    // Every style offered under the selected category, in both orientations
+    SweepRunner::Options options;
+    options.prompt = userPrompt;
+    for (const StyleCatalog::StyleInfo& info : StyleCatalog::styles()) {
+        if (info.category == selectedModel) {
+            options.styles.push_back(info.style);
+        }
+    }
+    if (options.styles.empty()) {
+        options.styles.push_back(selectedStyle); // Aesthetic has no styles of its own
+    }
+    options.categories = { selectedModel };
+    options.orientations = { OrientationMode::PORTRAIT, OrientationMode::LANDSCAPE };
+
+    activeSweepId = SweepRunner::makeSweepId();
+    sweepPrompt = userPrompt;
+    sweepCells = SweepRunner::expand(options);
+    sweepBackends.clear();
+    for (const SweepRunner::Cell& cell : sweepCells) {
+        sweepBackends.push_back(hasPinnedBackend ? pinnedBackend : generationEngine.routeCategory(cell.category));
+    }
+    nextSweepCell = 0;
+    sweepInFlight = 0;
+    sweepJobs.clear();
+
+    sweepProgress = std::make_unique<SweepRunner::Progress>(sweepBackends, SWEEP_CONCURRENCY);
+    sweepProgress->loadPriors(generationEngine.getPollScheduler());
+
+    std::filesystem::create_directories("saved/portrait");
+    std::filesystem::create_directories("saved/landscape");
+
+    std::cout << "Sweep " << activeSweepId << ": " << sweepCells.size() << " images (" << options.styles.size()
+        << " " << getCategoryName(selectedModel) << " styles x 2 orientations), " << sweepProgress->describe() << std::endl;
+    updateSweepLabel();
+}
+
+void ImageGenerator::processSweepResults() {
+    if (!sweepProgress) {
+        return;
+    }
+
+    bool changed = false;
+    sweepResults.drain([this, &changed](GenerationResult& result) {
+        auto it = sweepJobs.find(result.jobId);
+        if (it == sweepJobs.end()) {
+            return;
+        }
+        size_t index = it->second;
+        sweepJobs.erase(it);
+        sweepInFlight--;
+        changed = true;
+
+        sweepProgress->recordFinished(sweepBackends[index], result.totalMs, result.success);
+        if (!result.success) {
+            std::cout << "Sweep: " << getStyleName(sweepCells[index].style) << " failed: " << result.error << std::endl;
+            return;
+        }
+
+        // The engine already wrote the file into the gallery folder
+        saveSavedImagesMetadata({ SweepRunner::galleryEntry(activeSweepId, sweepPrompt, sweepCells[index], result.filename) });
+        std::cout << "Sweep: " << sweepProgress->describe() << std::endl;
+    });
+
+    // Top the window back up; the rest of the sweep waits here rather than in the engine
+    while (nextSweepCell < sweepCells.size() && sweepInFlight < static_cast<size_t>(SWEEP_CONCURRENCY)) {
+        const SweepRunner::Cell& cell = sweepCells[nextSweepCell];
+
+        GenerationRequest request;
+        request.prompt = sweepPrompt;
+        request.styleModifier = getStylePromptModifier(cell.style);
+        request.backend = sweepBackends[nextSweepCell];
+        request.orientation = cell.orientation;
+        request.client = "sweep";
+        request.priority = JobPriority::BATCH;
+
+        uint64_t jobId = generationEngine.submit(request, SweepRunner::outputFile(activeSweepId, nextSweepCell, cell),
+            [this](const GenerationResult& result) {
+                sweepResults.push(result);
+            });
+        sweepJobs[jobId] = nextSweepCell++;
+        sweepInFlight++;
+        changed = true;
+    }
+
+    if (changed) {
+        updateSweepLabel();
+        if (sweepProgress->isDone()) {
+            std::cout << "Sweep " << activeSweepId << " finished: " << sweepProgress->getTotal() - sweepProgress->getFailed()
+                << "/" << sweepProgress->getTotal() << " images. Open the gallery's Sweeps tab for the contact sheet" << std::endl;
+        }
+    }
+
+    if (currentState == AppState::GALLERY_SCREEN && showingSweeps) {
+        loadContactSheetThumbnails(2);
+    }
+}
+
+void ImageGenerator::updateSweepLabel() {
+    if (sweepProgress && !sweepProgress->isDone()) {
+        sweepLabel.setCharacterSize(13);
+        sweepLabel.setString("Sweep " + std::to_string(sweepProgress->getFinished()) + "/" +
+            std::to_string(sweepProgress->getTotal()) + "\n" + sweepProgress->etaText() + " left");
+    }
+    else {
+        sweepLabel.setCharacterSize(16);
+        sweepLabel.setString("Sweep");
+    }
+
+    sf::FloatRect bounds = sweepLabel.getLocalBounds();
+    sweepLabel.setPosition({ 812 + (120 - bounds.size.x) / 2 - bounds.position.x,
+        700 + (50 - bounds.size.y) / 2 - bounds.position.y });
+}
+
+std::vector<std::string> ImageGenerator::listSweeps() {
+    std::vector<std::string> ids = Gallery::sweepIds(savedImages);
+
+    // The running sweep is the newest even before its first image lands
+    if (!activeSweepId.empty() && std::find(ids.begin(), ids.end(), activeSweepId) == ids.end()) {
+        ids.insert(ids.begin(), activeSweepId);
+    }
+    return ids;
+}
+
+std::string ImageGenerator::shownSweepId() {
+    std::vector<std::string> ids = listSweeps();
+    return ids.empty() ? "" : ids[std::min(sweepPage, ids.size() - 1)];
+}
+
+void ImageGenerator::loadContactSheetThumbnails(size_t maxToLoad) {
+    // A few per frame: decoding full-size images would otherwise stall the UI
+    float cellSize = galleryGrid().cellSize;
+    size_t loaded = 0;
+
+    for (const SavedImage& img : getCurrentGalleryImages()) {
+        if (loaded >= maxToLoad) {
+            break;
+        }
+        if (contactSheetThumbnails.count(img.filename)) {
+            continue;
+        }
+        loaded++;
+
+        sf::Texture full;
+        if (!full.loadFromFile(img.filename)) {
+            std::cout << "Failed to load thumbnail: " << img.filename << std::endl;
+            contactSheetThumbnails[img.filename] = sf::Texture(); // Don't retry every frame
+            continue;
+        }
+        full.setSmooth(true);
+        if (!full.generateMipmap()) {
+            std::cout << "Could not generate mipmaps for " << img.filename << std::endl;
+        }
+
+        // Scale down once into a small texture; the sheet redraws dozens of these every frame
+        sf::Vector2u size = full.getSize();
+        float scale = std::min(cellSize / size.x, cellSize / size.y);
+        sf::Vector2u thumbSize(std::max(1u, static_cast<unsigned>(size.x * scale)), std::max(1u, static_cast<unsigned>(size.y * scale)));
+
+        sf::RenderTexture target;
+        if (!target.resize(thumbSize)) {
+            contactSheetThumbnails[img.filename] = sf::Texture();
+            continue;
+        }
+        sf::Sprite sprite(full);
+        sprite.setScale({ static_cast<float>(thumbSize.x) / size.x, static_cast<float>(thumbSize.y) / size.y });
+        target.clear(sf::Color::Transparent);
+        target.draw(sprite);
+        target.display();
+        contactSheetThumbnails[img.filename] = target.getTexture();
+    }
+}
+
+void ImageGenerator::renderContactSheet() {
+    std::string sweepId = shownSweepId();
+    if (sweepId.empty()) {
+        window.draw(galleryInfoLabel);
+        return;
+    }
+
+    auto currentImages = getCurrentGalleryImages();
+    bool running = sweepId == activeSweepId && sweepProgress && !sweepProgress->isDone();
+
+    // Prompt and progress (ETA from the latency seen so far while it runs)
+    std::string prompt = sweepId == activeSweepId ? sweepPrompt : (currentImages.empty() ? "" : currentImages[0].prompt);
+    std::string status = running ? sweepProgress->describe() : std::to_string(currentImages.size()) + " images";
+    size_t sweeps = listSweeps().size();
+
+    sf::Text headerText(font);
+    headerText.setString("\"" + shorten(prompt, 60) + "\" - " + status +
+        (sweeps > 1 ? "   (" + std::to_string(std::min(sweepPage, sweeps - 1) + 1) + "/" + std::to_string(sweeps) +
+            ", click Sweeps for the next)" : ""));
+    headerText.setCharacterSize(14);
+    headerText.setFillColor(sf::Color(150, 150, 150));
+    sf::FloatRect headerBounds = headerText.getLocalBounds();
+    headerText.setPosition({ (1024 - headerBounds.size.x) / 2, 165 });
+    window.draw(headerText);
+
+    GalleryGrid grid = galleryGrid();
+    float startY = 200.0f - galleryScrollOffset;
+
+    for (size_t i = 0; i < currentImages.size(); i++) {
+        int row = i / grid.perRow;
+        int col = i % grid.perRow;
+        float x = grid.startX + col * (grid.cellSize + grid.spacing);
+        float y = startY + row * (grid.cellSize + grid.spacing);
+
+        // Only draw if visible in scroll area
+        if (y + grid.cellSize < 180 || y > 580) {
+            continue;
+        }
+
+        sf::RectangleShape cell({ grid.cellSize, grid.cellSize });
+        cell.setPosition({ x, y });
+        cell.setFillColor(sf::Color(60, 60, 60));
+        window.draw(cell);
+
+        auto thumbnail = contactSheetThumbnails.find(currentImages[i].filename);
+        if (thumbnail != contactSheetThumbnails.end() && thumbnail->second.getSize().x > 0) {
+            sf::Sprite sprite(thumbnail->second);
+            sf::Vector2u size = thumbnail->second.getSize();
+            sprite.setPosition({ x + (grid.cellSize - size.x) / 2, y + (grid.cellSize - size.y) / 2 });
+            window.draw(sprite);
+        }
+
+        // Style, then category and orientation
+        sf::RectangleShape overlay({ grid.cellSize, 32 });
+        overlay.setPosition({ x, y + grid.cellSize - 32 });
+        overlay.setFillColor(sf::Color(0, 0, 0, 150));
+        window.draw(overlay);
+
+        sf::Text styleText(font);
+        styleText.setString(shorten(currentImages[i].style, 22));
+        styleText.setCharacterSize(11);
+        styleText.setFillColor(sf::Color::White);
+        styleText.setPosition({ x + 4, y + grid.cellSize - 31 });
+        window.draw(styleText);
+
+        sf::Text detailText(font);
+        detailText.setString(shorten(currentImages[i].category, 16) + (currentImages[i].isLandscape ? " / landscape" : " / portrait"));
+        detailText.setCharacterSize(10);
+        detailText.setFillColor(sf::Color(200, 200, 200));
+        detailText.setPosition({ x + 4, y + grid.cellSize - 16 });
+        window.draw(detailText);
+
+        sf::RectangleShape border({ grid.cellSize, grid.cellSize });
+        border.setPosition({ x, y });
+        border.setFillColor(sf::Color::Transparent);
+        border.setOutlineThickness(1);
+        border.setOutlineColor(sf::Color(100, 150, 200, 100));
+        window.draw(border);
+    }
+}
@@ -0,0 +1,329 @@
+#include "ImageGenerator.h"
+
+namespace {
+    // Tray strip between the style area and the bottom buttons
+    const float TRAY_X = 50.0f;
+    const float TRAY_Y = 630.0f;
+    const float CARD_WIDTH = 140.0f;
+    const float CARD_HEIGHT = 56.0f;
+    const float CARD_SPACING = 150.0f;
+    const float CLOSE_SIZE = 16.0f;
+
+    std::string phaseText(JobPhase phase) {
+        switch (phase) {
+        case JobPhase::PENDING: return "Queued";
+        case JobPhase::SUBMITTING: return "Submitting";
+        case JobPhase::POLLING: return "Running";
+        case JobPhase::DOWNLOADING: return "Downloading";
+        default: return "Finishing";
+        }
+    }
+
+    std::string secondsText(float seconds) {
+        return std::to_string(static_cast<int>(seconds)) + "s";
+    }
+
+    std::string shorten(const std::string& text, size_t maxChars) {
+        return text.size() > maxChars ? text.substr(0, maxChars - 3) + "..." : text;
+    }
+}
+
+void ImageGenerator::processCompletedJobs() {
+    // Called once per frame; decoding already happened on the decoder's workers
+    imageDecoder.drain([this](ImageDecoder::Decoded& decoded) {
+        const GenerationResult& result = decoded.result;
+        auto it = std::find_if(trayJobs.begin(), trayJobs.end(), [&result](const TrayJob& job) {
+            return job.jobId == result.jobId || (result.draft && job.draftJobId == result.jobId);
+        });
+        bool speculative = it == trayJobs.end() && speculativeJob.jobId != 0 && speculativeJob.jobId == result.jobId;
+        if (it == trayJobs.end() && !speculative) {
+            return; // Dismissed from the tray while it was running
+        }
+
+        TrayJob& job = speculative ? speculativeJob : *it;
+        if (result.draft) {
+            // A draft is only worth showing until the final is in
+            if (!result.success || !decoded.image || job.finished) {
+                if (!result.success && !result.cancelled) {
+                    std::cout << "Draft failed: " << result.error << std::endl;
+                }
+                return;
+            }
+
+            auto texture = std::make_unique<sf::Texture>();
+            if (!texture->loadFromImage(*decoded.image)) {
+                return;
+            }
+            texture->setSmooth(true);
+            job.draftTexture = std::move(texture);
+            job.draftData = result.imageData;
+            if (!job.firstPixelLogged) {
+                std::cout << "Time to first pixel: " << static_cast<int>(result.totalMs) << " ms (draft)" << std::endl;
+                job.firstPixelLogged = true;
+            }
+            return;
+        }
+
+        job.finished = true;
+        job.totalSeconds = job.elapsed.getElapsedTime().asSeconds();
+
+        if (!result.success) {
+            std::cout << "Generation failed: " << result.error << std::endl;
+            job.error = result.error;
+            return;
+        }
+
+        std::cout << "Image URL received: " << result.imageUrl << std::endl;
+        std::cout << "Generation took " << result.totalMs << " ms (" << result.pollCount << " polls)" << std::endl;
+        if (!job.firstPixelLogged) {
+            std::cout << "Time to first pixel: " << static_cast<int>(result.totalMs) << " ms (final)" << std::endl;
+            job.firstPixelLogged = true;
+        }
+
+        if (!decoded.image) {
+            job.error = "Failed to decode image";
+            return;
+        }
+
+        // Only the GPU upload is left for the UI thread
+        auto texture = std::make_unique<sf::Texture>();
+        if (!texture->loadFromImage(*decoded.image)) {
+            std::cout << "Failed to upload image texture" << std::endl;
+            job.error = "Failed to load image";
+            return;
+        }
+
+        // The card draws it at a few percent of its size
+        texture->setSmooth(true);
+        if (!texture->generateMipmap()) {
+            std::cout << "Could not generate mipmaps for tray thumbnail" << std::endl;
+        }
+
+        job.imageData = result.imageData;
+        job.texture = std::move(texture);
+        job.success = true;
+
+        // The rest of a multi-image job's candidates, for the picker
+        for (size_t i = 0; i < decoded.moreImages.size(); i++) {
+            auto candidate = std::make_unique<sf::Texture>();
+            if (!decoded.moreImages[i] || !candidate->loadFromImage(*decoded.moreImages[i])) {
+                continue;
+            }
+            candidate->setSmooth(true);
+            job.moreTextures.push_back(std::move(candidate));
+            job.moreImageData.push_back(result.images[i + 1]);
+        }
+        job.draftTexture.reset();
+        job.draftData.reset();
+
+        // The draft of this job is on screen: swap the final in
+        if (!speculative && viewingDraftOf == job.jobId && currentState == AppState::IMAGE_DISPLAY && !viewingFromGallery) {
+            openTrayJob(static_cast<size_t>(it - trayJobs.begin()));
+        }
+    });
+}
+
+sf::FloatRect ImageGenerator::trayCardBounds(size_t index) const {
+    return sf::FloatRect({ TRAY_X + index * CARD_SPACING, TRAY_Y }, { CARD_WIDTH, CARD_HEIGHT });
+}
+
+bool ImageGenerator::isTrayFull() const {
+    return trayJobs.size() >= static_cast<size_t>(MAX_TRAY_JOBS);
+}
+
+void ImageGenerator::renderJobTray() {
+    for (size_t i = 0; i < trayJobs.size(); i++) {
+        const TrayJob& job = trayJobs[i];
+        sf::FloatRect bounds = trayCardBounds(i);
+        float x = bounds.position.x;
+        float y = bounds.position.y;
+
+        // Card, outlined by state
+        sf::RectangleShape card(bounds.size);
+        card.setPosition(bounds.position);
+        card.setFillColor(buttonColor);
+        card.setOutlineThickness(2);
+        if (!job.finished) {
+            card.setOutlineColor(selectedButtonColor);
+        }
+        else if (job.success) {
+            card.setOutlineColor(sf::Color(50, 150, 50));
+        }
+        else {
+            card.setOutlineColor(sf::Color(180, 50, 50));
+        }
+        window.draw(card);
+
+        std::string status;
+        if (!job.finished && job.draftTexture) {
+            // Draft while the final renders
+            sf::Sprite thumbnail(*job.draftTexture);
+            sf::Vector2u size = job.draftTexture->getSize();
+            float scale = std::min(40.0f / size.x, (CARD_HEIGHT - 8) / size.y);
+            thumbnail.setScale({ scale, scale });
+            thumbnail.setPosition({ x + 4 + (40 - size.x * scale) / 2, y + 4 + (CARD_HEIGHT - 8 - size.y * scale) / 2 });
+            thumbnail.setColor(sf::Color(255, 255, 255, 160));
+            window.draw(thumbnail);
+            status = "Draft " + secondsText(job.elapsed.getElapsedTime().asSeconds());
+        }
+        else if (!job.finished) {
+            // Spinner while the job is in flight
+            loadingSpinner.setPosition({ x + 24, y + CARD_HEIGHT / 2 });
+            window.draw(loadingSpinner);
+            status = phaseText(generationEngine.getJobPhase(job.jobId)) + " " +
+                secondsText(job.elapsed.getElapsedTime().asSeconds());
+        }
+        else if (job.success) {
+            // Thumbnail fitted into the left of the card
+            sf::Sprite thumbnail(*job.texture);
+            sf::Vector2u size = job.texture->getSize();
+            float scale = std::min(40.0f / size.x, (CARD_HEIGHT - 8) / size.y);
+            thumbnail.setScale({ scale, scale });
+            thumbnail.setPosition({ x + 4 + (40 - size.x * scale) / 2, y + 4 + (CARD_HEIGHT - 8 - size.y * scale) / 2 });
+            window.draw(thumbnail);
+            status = "Done " + secondsText(job.totalSeconds) +
+                (job.moreTextures.empty() ? "" : " x" + std::to_string(job.moreTextures.size() + 1));
+        }
+        else {
+            status = "Failed";
+        }
+
+        sf::Text statusText(font);
+        statusText.setString(status);
+        statusText.setCharacterSize(14);
+        statusText.setFillColor(sf::Color::White);
+        statusText.setPosition({ x + 50, y + 6 });
+        window.draw(statusText);
+
+        sf::Text detailText(font);
+        detailText.setString(shorten(job.finished && !job.success ? job.error : job.prompt, 14));
+        detailText.setCharacterSize(12);
+        detailText.setFillColor(sf::Color(150, 150, 150));
+        detailText.setPosition({ x + 50, y + 30 });
+        window.draw(detailText);
+
+        // Cancel (running) or dismiss (finished)
+        sf::Text closeText(font);
+        closeText.setString("x");
+        closeText.setCharacterSize(14);
+        closeText.setFillColor(sf::Color(200, 200, 200));
+        closeText.setPosition({ x + CARD_WIDTH - CLOSE_SIZE + 3, y - 2 });
+        window.draw(closeText);
+    }
+}
+
+bool ImageGenerator::handleJobTrayClick(sf::Vector2f mousePos) {
+    for (size_t i = 0; i < trayJobs.size(); i++) {
+        sf::FloatRect bounds = trayCardBounds(i);
+        if (!bounds.contains(mousePos)) {
+            continue;
+        }
+
+        TrayJob& job = trayJobs[i];
+        sf::FloatRect closeBounds({ bounds.position.x + CARD_WIDTH - CLOSE_SIZE, bounds.position.y }, { CLOSE_SIZE, CLOSE_SIZE });
+
+        if (closeBounds.contains(mousePos) || (job.finished && !job.success)) {
+            if (!job.finished) {
+                // Aborts its transfers and frees the engine slot; the result never arrives.
+                // With a draft on the card this is rejecting it: the final is skipped.
+                generationEngine.cancel(job.jobId);
+                if (job.draftJobId && !job.draftTexture) {
+                    generationEngine.cancel(job.draftJobId);
+                }
+            }
+            removeTrayJob(i);
+        }
+        else if (job.finished) {
+            openTrayJob(i);
+        }
+        else if (job.draftTexture) {
+            openTrayDraft(i);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void ImageGenerator::openTrayJob(size_t index) {
+    TrayJob job = std::move(trayJobs[index]);
+    removeTrayJob(index);
+    viewingDraftOf = 0;
+
+    imageTexture = *job.texture;
+    imageTexture.setSmooth(false);
+    std::cout << "Image resolution: " << imageTexture.getSize().x << "x" << imageTexture.getSize().y << std::endl;
+    imageSprite.setTexture(imageTexture, true);
+    fitImageSprite();
+
+    // CRITICAL: Keep the downloaded bytes - saving writes them out unchanged
+    currentImageData = job.imageData;
+
+    // Saving records the current prompt, category, style and orientation, so
+    // bring back the ones this job was generated with
+    restoreImageMetadata(SavedImage("", job.prompt, getCategoryName(job.category), getStyleName(job.style), "",
+        job.orientation == OrientationMode::LANDSCAPE));
+
+    // Update button positions based on image orientation
+    updateImageDisplayButtonPositions();
+    hasGeneratedImage = true;
+
+    // Several candidates: open on the grid; the first stays behind it until one is picked
+    clearCandidates();
+    if (!job.moreTextures.empty()) {
+        candidateTextures.push_back(*job.texture);
+        candidateData.push_back(job.imageData);
+        for (size_t i = 0; i < job.moreTextures.size(); i++) {
+            candidateTextures.push_back(*job.moreTextures[i]);
+            candidateData.push_back(job.moreImageData[i]);
+        }
+        pickingCandidate = true;
+    }
+
+    // CRITICAL: Invalidate cache AFTER everything is set up properly
+    invalidateAlreadySavedCache();
+
+    currentState = AppState::IMAGE_DISPLAY;
+    viewingFromGallery = false; // CRITICAL: Not in gallery viewing mode for a fresh generation
+}
+
+void ImageGenerator::openTrayDraft(size_t index) {
+    // The job stays in the tray; its final replaces the draft when it lands
+    const TrayJob& job = trayJobs[index];
+    imageTexture = *job.draftTexture;
+    imageTexture.setSmooth(true);
+    imageSprite.setTexture(imageTexture, true);
+    fitImageSprite();
+
+    currentImageData = job.draftData;
+    clearCandidates();
+    restoreImageMetadata(SavedImage("", job.prompt, getCategoryName(job.category), getStyleName(job.style), "",
+        job.orientation == OrientationMode::LANDSCAPE));
+    updateImageDisplayButtonPositions();
+    hasGeneratedImage = true;
+    invalidateAlreadySavedCache();
+
+    viewingDraftOf = job.jobId;
+    currentState = AppState::IMAGE_DISPLAY;
+    viewingFromGallery = false;
+}
+
+void ImageGenerator::removeTrayJob(size_t index) {
+    if (index < trayJobs.size()) {
+        trayJobs.erase(trayJobs.begin() + index);
+    }
+}
+
+void ImageGenerator::fitImageSprite() {
+    // Scale image to fit screen while maintaining aspect ratio
+    float scaleX = 1024.0f / imageTexture.getSize().x;
+    float scaleY = 768.0f / imageTexture.getSize().y;
+    float scale = std::min(scaleX, scaleY);
+    imageSprite.setScale({ scale, scale });
+
+    // Center the image
+    sf::FloatRect spriteBounds = imageSprite.getGlobalBounds();
+    float posX = (1024 - spriteBounds.size.x) / 2;
+    float posY = (768 - spriteBounds.size.y) / 2;
+    imageSprite.setPosition({ posX, posY });
+}
@@ -237,6 +237,16 @@ void ImageGenerator::initializeUI() {
     sf::FloatRect gallBounds = galleryLabel.getLocalBounds();
     galleryLabel.setPosition({ 672 + (120 - gallBounds.size.x) / 2, 715 });
 
+    // Sweep button: the prompt across every style of the selected category
+    sweepButton.setSize({ 120, 50 });
+    sweepButton.setPosition({ 812, 700 }); // Next to gallery button
+    sweepButton.setFillColor(sf::Color(120, 80, 140));
+
+    sweepLabel.setFont(font);
+    sweepLabel.setCharacterSize(16);
+    sweepLabel.setFillColor(sf::Color::White);
+    updateSweepLabel();
+
     // Save image button (for image display screen)
     saveImageButton.setSize({ 150, 50 });
     saveImageButton.setPosition({ 600, 648 });
@@ -261,6 +271,18 @@ void ImageGenerator::initializeUI() {
     sf::FloatRect newBounds = newImageLabel.getLocalBounds();
     newImageLabel.setPosition({ 774 + (150 - newBounds.size.x) / 2, 665 });
 
+    // Back to the candidate grid (multi-image generations), left of New Image
+    candidatesButton.setSize({ 150, 50 });
+    candidatesButton.setPosition({ 684, 698 });
+    candidatesButton.setFillColor(sf::Color(120, 80, 140));
+
+    candidatesLabel.setFont(font);
+    candidatesLabel.setString("Candidates");
+    candidatesLabel.setCharacterSize(16);
+    candidatesLabel.setFillColor(sf::Color::White);
+    sf::FloatRect candidatesBounds = candidatesLabel.getLocalBounds();
+    candidatesLabel.setPosition({ 684 + (150 - candidatesBounds.size.x) / 2, 715 });
+
     // Gallery screen UI elements
     backToMainButton.setSize({ 120, 40 });
     backToMainButton.setPosition({ 50, 50 });
@@ -283,7 +305,7 @@ void ImageGenerator::initializeUI() {
 
     // Gallery orientation tabs
     portraitTabButton.setSize({ 100, 40 });
-    portraitTabButton.setPosition({ 400, 120 });
+    portraitTabButton.setPosition({ 338, 120 });
     portraitTabButton.setFillColor(selectedButtonColor);
 
     portraitTabLabel.setFont(font);
@@ -291,10 +313,10 @@ void ImageGenerator::initializeUI() {
     portraitTabLabel.setCharacterSize(14);
     portraitTabLabel.setFillColor(sf::Color::White);
     sf::FloatRect portBounds = portraitTabLabel.getLocalBounds();
-    portraitTabLabel.setPosition({ 400 + (100 - portBounds.size.x) / 2, 130 });
+    portraitTabLabel.setPosition({ 338 + (100 - portBounds.size.x) / 2, 130 });
 
     landscapeTabButton.setSize({ 100, 40 });
-    landscapeTabButton.setPosition({ 524, 120 });
+    landscapeTabButton.setPosition({ 462, 120 });
     landscapeTabButton.setFillColor(buttonColor);
 
     landscapeTabLabel.setFont(font);
@@ -302,7 +324,18 @@ void ImageGenerator::initializeUI() {
     landscapeTabLabel.setCharacterSize(14);
     landscapeTabLabel.setFillColor(sf::Color::White);
     sf::FloatRect landBounds = landscapeTabLabel.getLocalBounds();
-    landscapeTabLabel.setPosition({ 524 + (100 - landBounds.size.x) / 2, 130 });
+    landscapeTabLabel.setPosition({ 462 + (100 - landBounds.size.x) / 2, 130 });
+
+    sweepsTabButton.setSize({ 100, 40 });
+    sweepsTabButton.setPosition({ 586, 120 });
+    sweepsTabButton.setFillColor(buttonColor);
+
+    sweepsTabLabel.setFont(font);
+    sweepsTabLabel.setString("Sweeps");
+    sweepsTabLabel.setCharacterSize(14);
+    sweepsTabLabel.setFillColor(sf::Color::White);
+    sf::FloatRect sweepsBounds = sweepsTabLabel.getLocalBounds();
+    sweepsTabLabel.setPosition({ 586 + (100 - sweepsBounds.size.x) / 2, 130 });
 
     // Gallery info label
     galleryInfoLabel.setFont(font);
@@ -316,14 +349,6 @@ void ImageGenerator::initializeUI() {
     galleryScrollArea.setSize({ 924, 400 });
     galleryScrollArea.setPosition({ 50, 180 });
 
-    // Loading text - positioned below spinner
-    loadingText.setFont(font);
-    loadingText.setString("Generating image...");
-    loadingText.setCharacterSize(32);
-    loadingText.setFillColor(sf::Color::White);
-    sf::FloatRect loadBounds = loadingText.getLocalBounds();
-    loadingText.setPosition({ (1024 - loadBounds.size.x) / 2, 380 }); // Moved down from center
-
     // Initialize current category styles as empty
     currentCategoryStyles.clear();
     currentCategoryStyleNames.clear();
@@ -473,8 +498,11 @@ void ImageGenerator::updateModelButtons() {
 }
 
 void ImageGenerator::updateButtonHovers(sf::Vector2f mousePos) {
-    // Generate button hover
-    if (generateButton.getGlobalBounds().contains(mousePos)) {
+    // Generate button hover (greyed out while the job tray is full)
+    if (isTrayFull()) {
+        generateButton.setFillColor(disabledButtonColor);
+    }
+    else if (generateButton.getGlobalBounds().contains(mousePos)) {
         generateButton.setFillColor(sf::Color(70, 170, 70));
     }
     else {
@@ -497,6 +525,17 @@ void ImageGenerator::updateButtonHovers(sf::Vector2f mousePos) {
         galleryButton.setFillColor(sf::Color(100, 100, 150));
     }
 
+    // Sweep button hover (greyed out while a sweep runs)
+    if (sweepProgress && !sweepProgress->isDone()) {
+        sweepButton.setFillColor(disabledButtonColor);
+    }
+    else if (sweepButton.getGlobalBounds().contains(mousePos)) {
+        sweepButton.setFillColor(sf::Color(140, 100, 160));
+    }
+    else {
+        sweepButton.setFillColor(sf::Color(120, 80, 140));
+    }
+
     // Back to image button hover
     if (hasGeneratedImage && backToImageButton.getGlobalBounds().contains(mousePos)) {
         backToImageButton.setFillColor(sf::Color(90, 120, 170));
@@ -668,9 +707,6 @@ void ImageGenerator::render() {
     case AppState::INPUT_SCREEN:
         renderInputScreen();
         break;
-    case AppState::LOADING:
-        renderLoadingScreen();
-        break;
     case AppState::IMAGE_DISPLAY:
         renderImageDisplay();
         break;
@@ -679,6 +715,12 @@ void ImageGenerator::render() {
         break;
     }
 
+    // On top of every screen whose events go through handleJobTrayClick (the
+    // Sweeps tab included), so no card takes a click without being drawn
+    if (currentState == AppState::INPUT_SCREEN || currentState == AppState::GALLERY_SCREEN) {
+        renderJobTray();
+    }
+
     window.display();
 }
 
@@ -760,6 +802,8 @@ void ImageGenerator::renderInputScreen() {
     window.draw(orientationLabel);
     window.draw(galleryButton);
     window.draw(galleryLabel);
+    window.draw(sweepButton);
+    window.draw(sweepLabel);
 
     // Back to image button
     if (hasGeneratedImage) {
@@ -773,12 +817,14 @@ void ImageGenerator::renderInputScreen() {
     }
 }
 
-void ImageGenerator::renderLoadingScreen() {
-    window.draw(loadingText);
-    window.draw(loadingSpinner);
-}
-
 void ImageGenerator::renderImageDisplay() {
+    if (pickingCandidate) {
+        renderCandidatePicker();
+        window.draw(newImageButton);
+        window.draw(newImageLabel);
+        return;
+    }
+
     window.draw(imageSprite);
 
     if (viewingFromGallery) {
@@ -789,8 +835,21 @@ void ImageGenerator::renderImageDisplay() {
         window.draw(deleteImageLabel);
     }
     else {
-        // Fresh generation - show save button (unless already saved)
-        if (!isImageAlreadySaved()) {
+        // Fresh generation - show save button (unless already saved). A draft
+        // can't be saved: the final replaces it on screen when it lands.
+        if (viewingDraftOf != 0) {
+            sf::Text draftText(font);
+            draftText.setString("Draft preview");
+            draftText.setCharacterSize(16);
+            draftText.setFillColor(sf::Color(150, 150, 150));
+
+            sf::Vector2f saveButtonPos = saveImageButton.getPosition();
+            sf::FloatRect draftBounds = draftText.getLocalBounds();
+            draftText.setPosition({ saveButtonPos.x + (150 - draftBounds.size.x) / 2,
+                                  saveButtonPos.y + 17 });
+            window.draw(draftText);
+        }
+        else if (!isImageAlreadySaved()) {
             window.draw(saveImageButton);
             window.draw(saveImageLabel);
         }
@@ -814,6 +873,11 @@ void ImageGenerator::renderImageDisplay() {
     window.draw(newImageButton);
     window.draw(newImageLabel);
 
+    if (!viewingFromGallery && candidateTextures.size() > 1) {
+        window.draw(candidatesButton);
+        window.draw(candidatesLabel);
+    }
+
     // Show saved notification if active
     if (showImageSavedIndicator) {
         window.draw(imageSavedIndicator);
@@ -831,6 +895,13 @@ void ImageGenerator::renderGalleryScreen() {
     window.draw(portraitTabLabel);
     window.draw(landscapeTabButton);
     window.draw(landscapeTabLabel);
+    window.draw(sweepsTabButton);
+    window.draw(sweepsTabLabel);
+
+    if (showingSweeps) {
+        renderContactSheet();
+        return;
+    }
 
     // Get current images
     auto currentImages = getCurrentGalleryImages();
@@ -841,10 +912,11 @@ void ImageGenerator::renderGalleryScreen() {
     }
 
     // Draw image thumbnails in a grid
-    int imagesPerRow = 4;
-    float thumbnailSize = 200.0f;
-    float spacing = 30.0f;
-    float startX = 50.0f;
+    GalleryGrid grid = galleryGrid();
+    int imagesPerRow = grid.perRow;
+    float thumbnailSize = grid.cellSize;
+    float spacing = grid.spacing;
+    float startX = grid.startX;
     float startY = 200.0f - galleryScrollOffset;
 
     for (size_t i = 0; i < currentImages.size(); i++) {
@@ -0,0 +1,236 @@
+#include "JobJournal.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+    json entryToJson(const JobJournal::Entry& entry) {
+        return {
+            {"op", "submitted"},
+            {"request_id", entry.requestId},
+            {"backend", entry.backend},
+            {"key", entry.cacheKey},
+            {"credential", entry.credential},
+            {"prompt", entry.prompt},
+            {"style", entry.styleModifier},
+            {"orientation", entry.orientation},
+            {"output", entry.outputFile},
+            {"images", entry.numImages},
+            {"submitted_at", entry.submittedAt}
+        };
+    }
+
+    JobJournal::Entry entryFromJson(const json& record) {
+        JobJournal::Entry entry;
+        entry.requestId = record.value("request_id", "");
+        entry.backend = record.value("backend", "");
+        entry.cacheKey = record.value("key", "");
+        entry.credential = record.value("credential", "");
+        entry.prompt = record.value("prompt", "");
+        entry.styleModifier = record.value("style", "");
+        entry.orientation = record.value("orientation", "portrait");
+        entry.outputFile = record.value("output", "");
+        entry.numImages = record.value("images", 1);
+        entry.submittedAt = record.value("submitted_at", static_cast<int64_t>(0));
+        return entry;
+    }
+}
+
+JobJournal::JobJournal() :
+    file(nullptr),
+    deadRecords(0),
+    stopping(false) {
+}
+
+JobJournal::~JobJournal() {
+    close();
+}
+
+bool JobJournal::open(const std::string& journalPath) {
+    close();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    path = journalPath;
+    live.clear();
+    deadRecords = 0;
+
+    // Replay; a torn last line from a crash mid-append is simply skipped
+    std::ifstream existing(path);
+    std::string line;
+    while (std::getline(existing, line)) {
+        try {
+            json record = json::parse(line);
+            std::string op = record.value("op", "");
+            std::string requestId = record.value("request_id", "");
+
+            if (op == "submitted" && !requestId.empty()) {
+                live[requestId] = entryFromJson(record);
+            }
+            else if (op == "finished") {
+                live.erase(requestId);
+                deadRecords += 2;
+            }
+        }
+        catch (const std::exception&) {
+            deadRecords++;
+        }
+    }
+    existing.close();
+
+    unfinishedAtOpen.clear();
+    for (const auto& entry : live) {
+        unfinishedAtOpen.push_back(entry.second);
+    }
+
+    // Start from a compact file so it never grows across restarts
+    if (!rewriteLocked()) {
+        std::cout << "Job journal disabled: could not write " << path << std::endl;
+        return false;
+    }
+
+    stopping = false;
+    compactThread = std::thread(&JobJournal::compactLoop, this);
+
+    if (!unfinishedAtOpen.empty()) {
+        std::cout << "Job journal: " << unfinishedAtOpen.size() << " unfinished job(s) from a previous run" << std::endl;
+    }
+    return true;
+}
+
+bool JobJournal::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file != nullptr;
+}
+
+void JobJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    compactCondition.notify_all();
+    if (compactThread.joinable()) {
+        compactThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+std::vector<JobJournal::Entry> JobJournal::getUnfinished() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return unfinishedAtOpen;
+}
+
+void JobJournal::recordSubmitted(const Entry& entry) {
+    Entry stamped = entry;
+    if (stamped.submittedAt == 0) {
+        stamped.submittedAt = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) return;
+
+    live[stamped.requestId] = stamped;
+    appendLocked(entryToJson(stamped).dump());
+}
+
+void JobJournal::recordFinished(const std::string& requestId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file || live.erase(requestId) == 0) return;
+
+    appendLocked(json{ {"op", "finished"}, {"request_id", requestId} }.dump());
+
+    deadRecords += 2;
+    if (deadRecords >= COMPACT_AFTER_DEAD_RECORDS) {
+        compactCondition.notify_one();
+    }
+}
+
+void JobJournal::appendLocked(const std::string& line) {
+    fputs(line.c_str(), file);
+    fputc('\n', file);
+
+    // Durable before we act on it: a job we can't find again costs money
+    if (!syncFile(file)) {
+        std::cout << "Job journal: sync failed for " << path << std::endl;
+    }
+}
+
+bool JobJournal::rewriteLocked() {
+    std::string tempPath = path + ".tmp";
+    FILE* temp = fopen(tempPath.c_str(), "wb");
+    if (!temp) {
+        return false;
+    }
+
+    for (const auto& entry : live) {
+        std::string line = entryToJson(entry.second).dump();
+        fputs(line.c_str(), temp);
+        fputc('\n', temp);
+    }
+
+    bool synced = syncFile(temp);
+    fclose(temp);
+    if (!synced) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::remove(tempPath.c_str());
+    }
+
+    // Keep appending either way; on a failed rename the old file is still valid
+    file = fopen(path.c_str(), "ab");
+    deadRecords = ec ? deadRecords : 0;
+    return file != nullptr;
+}
+
+void JobJournal::compactLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        compactCondition.wait(lock, [this]() {
+            return stopping || deadRecords >= COMPACT_AFTER_DEAD_RECORDS;
+        });
+        if (stopping) {
+            break;
+        }
+
+        if (!rewriteLocked()) {
+            std::cout << "Job journal: compaction failed for " << path << std::endl;
+            deadRecords = 0; // Don't spin; try again after the next batch
+        }
+    }
+}
+
+bool JobJournal::syncFile(FILE* handle) {
+    if (fflush(handle) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(handle)) == 0;
+#else
+    return fsync(fileno(handle)) == 0;
+#endif
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Append-only, fsync'd record of jobs the queue has accepted (one JSON object per
+// line). If the process dies mid-generation the request_id survives, so the next
+// start resumes polling/downloading instead of paying for the job again.
+//
+//   {"op":"submitted","request_id":...,"backend":...,"key":...,"credential":...,"prompt":...,...}
+//   {"op":"finished","request_id":...}
+//
+// Finished entries are dropped by a background compaction that rewrites the file.
+class JobJournal {
+public:
+    struct Entry {
+        std::string requestId;
+        std::string backend;        // BackendOps::name
+        std::string cacheKey;       // Hash of backend + payload
+        std::string credential;     // Fingerprint of the API key it was submitted with
+        std::string prompt;
+        std::string styleModifier;
+        std::string orientation;    // "portrait" or "landscape"
+        std::string outputFile;     // Empty for in-memory (GUI) jobs
+        int numImages = 1;          // Candidates requested (num_images)
+        int64_t submittedAt = 0;    // Unix time, ms
+    };
+
+    JobJournal();
+    ~JobJournal();
+
+    JobJournal(const JobJournal&) = delete;
+    JobJournal& operator=(const JobJournal&) = delete;
+
+    // Replays the file (creating it if needed) and starts appending to it
+    bool open(const std::string& path);
+    bool isOpen() const;
+    void close();
+
+    // Jobs that were submitted but never finished, as of open()
+    std::vector<Entry> getUnfinished() const;
+
+    void recordSubmitted(const Entry& entry);
+    void recordFinished(const std::string& requestId);
+
+private:
+    mutable std::mutex mutex;
+    std::string path;
+    FILE* file;
+    std::map<std::string, Entry> live;      // Submitted and not yet finished
+    std::vector<Entry> unfinishedAtOpen;
+    size_t deadRecords;                     // Lines compaction would drop
+
+    std::thread compactThread;
+    std::condition_variable compactCondition;
+    bool stopping;
+
+    static constexpr size_t COMPACT_AFTER_DEAD_RECORDS = 64;
+
+    void appendLocked(const std::string& line);
+    bool rewriteLocked();
+    void compactLoop();
+    static bool syncFile(FILE* file);
+};
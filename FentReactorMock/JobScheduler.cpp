@@ -0,0 +1,256 @@
+#include "JobScheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include "Backends.h"
+
+namespace {
+    // Calls apply(name, value) for each "name=value" in a comma-separated list
+    template <typename Apply>
+    void parsePairs(const std::string& spec, const char* what, Apply apply) {
+        std::stringstream ss(spec);
+        std::string pair;
+        while (std::getline(ss, pair, ',')) {
+            size_t eq = pair.find('=');
+            char* end = nullptr;
+            double value = eq == std::string::npos ? 0 : std::strtod(pair.c_str() + eq + 1, &end);
+            if (eq == std::string::npos || end == pair.c_str() + eq + 1 || value < 0 || !apply(pair.substr(0, eq), value)) {
+                std::cout << "Ignoring " << what << " entry: " << pair << std::endl;
+            }
+        }
+    }
+}
+
+JobScheduler::JobScheduler(NowFunction nowFunction) :
+    now(std::move(nowFunction)),
+    globalLimit(4),
+    running(0),
+    queued(0) {
+}
+
+void JobScheduler::setGlobalLimit(size_t limit) {
+    globalLimit = std::max<size_t>(1, limit);
+}
+
+void JobScheduler::setBackendLimit(BackendId backend, size_t limit) {
+    size_t index = static_cast<size_t>(backend);
+    if (index < BACKEND_COUNT) {
+        backendLimits[index] = limit;
+    }
+}
+
+void JobScheduler::setClientWeight(const std::string& client, double weight) {
+    weights[client] = weight > 0 ? weight : 1.0;
+}
+
+double JobScheduler::weightOf(const std::string& client) const {
+    auto it = weights.find(client);
+    return it != weights.end() ? it->second : 1.0;
+}
+
+bool JobScheduler::backendHasRoom(size_t backend) const {
+    return backendLimits[backend] == 0 || runningByBackend[backend] < backendLimits[backend];
+}
+
+void JobScheduler::enqueue(uint64_t id, const std::string& client, JobPriority priority, BackendId backend) {
+    size_t cls = std::min(static_cast<size_t>(priority), CLASS_COUNT - 1);
+    size_t index = std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1);
+
+    // A client that was idle starts at the current virtual time rather than
+    // cashing in the share it didn't use
+    ClientQueue& queue = queues[cls][client];
+    double startTag = std::max(virtualTime[cls], queue.finishTag);
+    queue.finishTag = startTag + 1.0 / weightOf(client);
+
+    queue.byBackend[index].push_back(Entry{ id, startTag, now() });
+    queue.size++;
+    queued++;
+    locations[id] = Location{ static_cast<JobPriority>(cls), client, static_cast<BackendId>(index) };
+}
+
+void JobScheduler::pruneIdleClients() {
+    for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+        // A class with nothing waiting is idle: like any fair queue it moves its
+        // virtual time past everything it has served, so every queue is done
+        size_t waiting = 0;
+        double lastFinish = virtualTime[cls];
+        for (const auto& entry : queues[cls]) {
+            waiting += entry.second.size;
+            lastFinish = std::max(lastFinish, entry.second.finishTag);
+        }
+        if (waiting == 0) {
+            virtualTime[cls] = lastFinish;
+        }
+
+        // An empty queue whose finish tag the virtual time has passed would restart
+        // at the virtual time anyway, so dropping it loses nothing. One still ahead
+        // of it is kept: its finish tag is what holds a low-weight client to its share.
+        for (auto it = queues[cls].begin(); it != queues[cls].end();) {
+            if (it->second.size == 0 && it->second.finishTag <= virtualTime[cls]) {
+                it = queues[cls].erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool JobScheduler::next(uint64_t& id) {
+    pruneIdleClients();
+    if (running >= globalLimit || queued == 0) {
+        return false;
+    }
+
+    for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+        // Smallest start tag among heads whose backend has room
+        std::deque<Entry>* best = nullptr;
+        std::map<std::string, ClientQueue>::iterator bestClient;
+        size_t bestBackend = 0;
+
+        for (auto it = queues[cls].begin(); it != queues[cls].end(); ++it) {
+            ClientQueue& queue = it->second;
+            for (size_t b = 0; b < BACKEND_COUNT; b++) {
+                std::deque<Entry>& waiting = queue.byBackend[b];
+                if (waiting.empty() || !backendHasRoom(b)) {
+                    continue;
+                }
+                if (!best || waiting.front().startTag < best->front().startTag) {
+                    best = &waiting;
+                    bestClient = it;
+                    bestBackend = b;
+                }
+            }
+        }
+
+        if (!best) {
+            continue;
+        }
+
+        Entry entry = best->front();
+        best->pop_front();
+        queued--;
+        locations.erase(entry.id);
+        bestClient->second.size--;
+
+        virtualTime[cls] = std::max(virtualTime[cls], entry.startTag);
+        runningByBackend[bestBackend]++;
+        running++;
+
+        double waitMs = std::chrono::duration<double, std::milli>(now() - entry.enqueuedAt).count();
+        WaitTotals& totals = waits[cls];
+        totals.started++;
+        totals.totalWaitMs += waitMs;
+        totals.maxWaitMs = std::max(totals.maxWaitMs, waitMs);
+
+        id = entry.id;
+        return true;
+    }
+
+    return false;
+}
+
+void JobScheduler::release(BackendId backend) {
+    size_t index = std::min(static_cast<size_t>(backend), BACKEND_COUNT - 1);
+    if (runningByBackend[index] > 0) runningByBackend[index]--;
+    if (running > 0) running--;
+}
+
+bool JobScheduler::transfer(BackendId from, BackendId to) {
+    size_t source = std::min(static_cast<size_t>(from), BACKEND_COUNT - 1);
+    size_t target = std::min(static_cast<size_t>(to), BACKEND_COUNT - 1);
+    if (source == target) {
+        return true;
+    }
+    if (backendLimits[target] > 0 && runningByBackend[target] >= backendLimits[target]) {
+        return false;
+    }
+
+    if (runningByBackend[source] > 0) runningByBackend[source]--;
+    runningByBackend[target]++;
+    return true;
+}
+
+bool JobScheduler::remove(uint64_t id) {
+    auto it = locations.find(id);
+    if (it == locations.end()) {
+        return false;
+    }
+
+    const Location& location = it->second;
+    std::map<std::string, ClientQueue>& byClient = queues[static_cast<size_t>(location.priority)];
+    auto queue = byClient.find(location.client);
+    if (queue != byClient.end()) {
+        std::deque<Entry>& waiting = queue->second.byBackend[static_cast<size_t>(location.backend)];
+        waiting.erase(std::remove_if(waiting.begin(), waiting.end(), [id](const Entry& entry) { return entry.id == id; }),
+            waiting.end());
+        queue->second.size--;
+    }
+    queued--;
+    locations.erase(it);
+    return true;
+}
+
+void JobScheduler::clear() {
+    for (auto& byClient : queues) {
+        byClient.clear();
+    }
+    locations.clear();
+    queued = 0;
+    running = 0;
+    runningByBackend.fill(0);
+}
+
+JobScheduler::Stats JobScheduler::getStats() const {
+    Stats stats;
+    stats.running = running;
+    stats.runningByBackend = runningByBackend;
+    Clock::time_point current = now();
+
+    for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+        ClassStats& classStats = stats.classes[cls];
+        const WaitTotals& totals = waits[cls];
+        classStats.started = totals.started;
+        classStats.meanWaitMs = totals.started ? totals.totalWaitMs / totals.started : 0;
+        classStats.maxWaitMs = totals.maxWaitMs;
+
+        for (const auto& entry : queues[cls]) {
+            classStats.queued += entry.second.size;
+            if (entry.second.size > 0) {
+                stats.queuedByClient[entry.first] += entry.second.size;
+            }
+
+            // Each deque is oldest-first
+            for (const std::deque<Entry>& waiting : entry.second.byBackend) {
+                if (!waiting.empty()) {
+                    double waitMs = std::chrono::duration<double, std::milli>(current - waiting.front().enqueuedAt).count();
+                    classStats.oldestWaitMs = std::max(classStats.oldestWaitMs, waitMs);
+                }
+            }
+        }
+    }
+
+    return stats;
+}
+
+void JobScheduler::applyBackendLimits(const std::string& spec) {
+    parsePairs(spec, "backend limit", [this](const std::string& name, double value) {
+        BackendId backend;
+        if (!Backends::fromName(name, backend)) {
+            return false;
+        }
+        setBackendLimit(backend, static_cast<size_t>(value));
+        return true;
+    });
+}
+
+void JobScheduler::applyClientWeights(const std::string& spec) {
+    parsePairs(spec, "client weight", [this](const std::string& name, double value) {
+        if (name.empty() || value <= 0) {
+            return false;
+        }
+        setClientWeight(name, value);
+        return true;
+    });
+}
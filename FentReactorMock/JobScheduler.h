@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GenerationTypes.h"
+
+// Decides which waiting job gets the next free generation slot.
+//
+// Interactive jobs always start before batch jobs. Within a class, clients share
+// slots in proportion to their weight (start-time fair queueing: each job gets a
+// virtual start tag, and the smallest admissible tag goes next), so one client's
+// 5,000-prompt manifest can't starve another's. A global limit and optional
+// per-backend limits cap what runs at once; a job whose backend is at its cap
+// waits without holding up jobs for other backends.
+//
+// Not thread-safe (the engine guards it with its own mutex). Time comes from an
+// injectable clock so it can be driven by a simulated one.
+class JobScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using NowFunction = std::function<Clock::time_point()>;
+
+    struct ClassStats {
+        size_t queued = 0;
+        uint64_t started = 0;
+        double meanWaitMs = 0;      // Over jobs started so far
+        double maxWaitMs = 0;
+        double oldestWaitMs = 0;    // Longest wait among jobs still queued
+    };
+
+    struct Stats {
+        std::array<ClassStats, static_cast<size_t>(JobPriority::COUNT)> classes;
+        size_t running = 0;
+        std::array<size_t, static_cast<size_t>(BackendId::COUNT)> runningByBackend{};
+        std::map<std::string, size_t> queuedByClient;
+    };
+
+    explicit JobScheduler(NowFunction now = Clock::now);
+
+    void setGlobalLimit(size_t limit);
+    size_t getGlobalLimit() const { return globalLimit; }
+
+    // 0 leaves the backend bounded only by the global limit
+    void setBackendLimit(BackendId backend, size_t limit);
+
+    // Relative share of slots; clients default to 1
+    void setClientWeight(const std::string& client, double weight);
+
+    void enqueue(uint64_t id, const std::string& client, JobPriority priority, BackendId backend);
+
+    // Picks the next job allowed to start and counts it as running; false if none may start now
+    bool next(uint64_t& id);
+
+    // A started job gave its slot back
+    void release(BackendId backend);
+
+    // A started job was rerouted: its slot moves from one backend to the other.
+    // False (and nothing changes) if the new backend is at its limit.
+    bool transfer(BackendId from, BackendId to);
+
+    // Drops a queued job (cancelled before it started); false if it isn't queued
+    bool remove(uint64_t id);
+
+    void clear();
+
+    size_t queuedCount() const { return queued; }
+    size_t runningCount() const { return running; }
+    Stats getStats() const;
+
+    // Parses "name=value,name=value" (e.g. FAL_BACKEND_LIMITS="playground-v25=2").
+    // Unknown backends and bad values are reported and skipped.
+    void applyBackendLimits(const std::string& spec);
+    void applyClientWeights(const std::string& spec);
+
+private:
+    struct Entry {
+        uint64_t id;
+        double startTag;
+        Clock::time_point enqueuedAt;
+    };
+
+    // One client's waiting jobs in one class, split by backend so a capped
+    // backend never blocks the client's other work. Client names come from
+    // request headers, so an empty queue is dropped once the class's virtual
+    // time has caught up with its finish tag (pruneIdleClients).
+    struct ClientQueue {
+        std::array<std::deque<Entry>, static_cast<size_t>(BackendId::COUNT)> byBackend;
+        double finishTag = 0;
+        size_t size = 0;
+    };
+
+    struct Location {
+        JobPriority priority;
+        std::string client;
+        BackendId backend;
+    };
+
+    struct WaitTotals {
+        uint64_t started = 0;
+        double totalWaitMs = 0;
+        double maxWaitMs = 0;
+    };
+
+    static constexpr size_t CLASS_COUNT = static_cast<size_t>(JobPriority::COUNT);
+    static constexpr size_t BACKEND_COUNT = static_cast<size_t>(BackendId::COUNT);
+
+    NowFunction now;
+    size_t globalLimit;
+    std::array<size_t, BACKEND_COUNT> backendLimits{};
+    std::array<size_t, BACKEND_COUNT> runningByBackend{};
+    size_t running;
+    size_t queued;
+
+    std::array<std::map<std::string, ClientQueue>, CLASS_COUNT> queues;
+    std::array<double, CLASS_COUNT> virtualTime{};
+    std::array<WaitTotals, CLASS_COUNT> waits;
+    std::unordered_map<std::string, double> weights;
+    std::unordered_map<uint64_t, Location> locations;     // Queued job -> its queue
+
+    double weightOf(const std::string& client) const;
+    bool backendHasRoom(size_t backend) const;
+    void pruneIdleClients();
+};
@@ -0,0 +1,370 @@
+#include "MockFalServer.h"
+#include "Backends.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+MockFalServer::MockFalServer(const Options& serverOptions) :
+    options(serverOptions),
+    server([this](const HttpServerRequest& request) { return handleRequest(request); }, serverOptions.workerThreads),
+    rng(std::random_device{}()),
+    nextId(1),
+    running(false) {
+}
+
+MockFalServer::~MockFalServer() {
+    stop();
+}
+
+bool MockFalServer::start(unsigned short port) {
+    if (!loadImages() || !server.start(port)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        outageEndsAt = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(options.outageMs));
+    }
+
+    running = true;
+    webhookThread = std::thread(&MockFalServer::webhookLoop, this);
+
+    std::cout << "Mock fal queue at " << getBaseUrl()
+        << " (queue " << options.queueDelayMs << " ms, processing " << options.processingMs
+        << " ms, failure rate " << options.failureRate << ", " << images.size() << " images)" << std::endl;
+    if (options.outageMs > 0) {
+        std::cout << "Mock fal: queue unavailable (503) for the first " << options.outageMs << " ms" << std::endl;
+    }
+    return true;
+}
+
+void MockFalServer::stop() {
+    if (running.exchange(false)) {
+        webhookCondition.notify_all();
+        webhookThread.join();
+    }
+    server.stop();
+}
+
+std::string MockFalServer::getBaseUrl() const {
+    return "http://127.0.0.1:" + std::to_string(server.getPort());
+}
+
+bool MockFalServer::loadImages() {
+    images.clear();
+
+    if (!options.imageDir.empty()) {
+        std::error_code ec;
+        for (const auto& item : std::filesystem::directory_iterator(options.imageDir, ec)) {
+            std::string extension = item.path().extension().string();
+            if (!item.is_regular_file(ec) || (extension != ".jpg" && extension != ".jpeg" && extension != ".png")) {
+                continue;
+            }
+
+            std::ifstream file(item.path(), std::ios::binary);
+            Image image;
+            image.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            image.contentType = extension == ".png" ? "image/png" : "image/jpeg";
+            if (!image.bytes.empty()) {
+                images.push_back(std::move(image));
+            }
+        }
+
+        if (images.empty()) {
+            std::cout << "Mock fal: no .jpg/.png images in " << options.imageDir << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Square procedural BMP of roughly the requested size, generated once
+    int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(options.imageBytes) / 3.0)));
+    ByteBuffer bitmap;
+    if (!Backends::get(BackendId::OFFLINE).generateLocal("mock fal", side, side, bitmap)) {
+        return false;
+    }
+
+    Image image;
+    image.bytes.assign(bitmap.begin(), bitmap.end());
+    image.contentType = "image/bmp";
+    images.push_back(std::move(image));
+    return true;
+}
+
+HttpServerResponse MockFalServer::handleRequest(const HttpServerRequest& request) {
+    const std::string& path = request.path;
+
+    if (path.rfind("/images/", 0) == 0) {
+        return image(path.substr(8));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Clock::now() < outageEndsAt) {
+            stats.unavailable++;
+            return HttpServerResponse::json(503, "{\"detail\":\"Service temporarily unavailable\"}");
+        }
+    }
+
+    size_t requestsAt = path.find("/requests/");
+    if (requestsAt == std::string::npos) {
+        return request.method == "POST" ? submit(request) : HttpServerResponse::text(405, "Method Not Allowed");
+    }
+
+    // .../requests/{id}[/status|/cancel]
+    std::string rest = path.substr(requestsAt + 10);
+    size_t slash = rest.find('/');
+    std::string id = rest.substr(0, slash);
+    std::string action = slash == std::string::npos ? "" : rest.substr(slash + 1);
+
+    std::string authorization = request.header("authorization");
+    if (action == "cancel" && request.method == "PUT") {
+        return cancel(id, authorization);
+    }
+    if (request.method != "GET") {
+        return HttpServerResponse::text(405, "Method Not Allowed");
+    }
+    if (action == "status") {
+        return status(id, false, authorization);
+    }
+    if (action.empty()) {
+        return status(id, true, authorization);
+    }
+    return HttpServerResponse::text(404, "Not Found");
+}
+
+HttpServerResponse MockFalServer::submit(const HttpServerRequest& request) {
+    double processingMs = options.processingMs;
+    int numImages = 1;
+    try {
+        json body = json::parse(request.body);
+        if (options.msPerMegapixelStep > 0) {
+            // Bigger and longer renders take proportionally longer, so drafts finish first
+            json size = body.value("image_size", json::object());
+            double megapixels = size.value("width", 1296) * size.value("height", 2304) / 1e6;
+            processingMs = options.msPerMegapixelStep * megapixels * body.value("num_inference_steps", 28);
+        }
+        numImages = std::max(1, std::min(body.value("num_images", 1), 4));
+        processingMs *= 1.0 + options.extraImageCost * (numImages - 1);
+    }
+    catch (const json::exception&) {
+        return HttpServerResponse::json(422, "{\"detail\":\"Invalid JSON body\"}");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string authorization = request.header("authorization");
+
+    if (options.perKeyConcurrency > 0) {
+        Clock::time_point now = Clock::now();
+        size_t unfinished = 0;
+        for (const auto& entry : jobs) {
+            std::string state = statusName(entry.second, now);
+            if (entry.second.authorization == authorization && (state == "IN_QUEUE" || state == "IN_PROGRESS")) {
+                unfinished++;
+            }
+        }
+        if (unfinished >= options.perKeyConcurrency) {
+            stats.throttled++;
+            return HttpServerResponse::json(429, "{\"detail\":\"Concurrency limit reached for this key\"}");
+        }
+    }
+
+    std::uniform_real_distribution<double> jitter(1.0 - options.jitter, 1.0 + options.jitter);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto ms = [](double value) { return std::chrono::microseconds(static_cast<long long>(value * 1000.0)); };
+
+    char id[40];
+    snprintf(id, sizeof(id), "mock-%08llx-%04llx", static_cast<unsigned long long>(nextId++),
+        static_cast<unsigned long long>(rng() & 0xFFFF));
+
+    MockJob job;
+    job.startsAt = Clock::now() + ms(options.queueDelayMs * jitter(rng));
+    job.finishesAt = job.startsAt + ms(processingMs * jitter(rng));
+    job.fails = unit(rng) < options.failureRate;
+    job.imageIndex = (nextId - 1) % images.size();
+    job.numImages = numImages;
+    job.webhookUrl = request.queryParam("fal_webhook");
+    job.authorization = authorization;
+
+    jobs[id] = job;
+    stats.submits++;
+    if (job.fails) stats.failedJobs++;
+
+    if (!job.webhookUrl.empty()) {
+        webhookCondition.notify_one();
+    }
+
+    json response = {
+        {"request_id", id},
+        {"status", "IN_QUEUE"},
+        {"queue_position", 0}
+    };
+    return HttpServerResponse::json(200, response.dump());
+}
+
+std::string MockFalServer::statusName(const MockJob& job, Clock::time_point now) const {
+    if (job.cancelled) return "CANCELLED";
+    if (now < job.startsAt) return "IN_QUEUE";
+    if (now < job.finishesAt) return "IN_PROGRESS";
+    return job.fails ? "FAILED" : "COMPLETED";
+}
+
+std::string MockFalServer::resultJson(const std::string& id, const MockJob& job) const {
+    json urls = json::array();
+    json nsfw = json::array();
+    for (int n = 1; n <= job.numImages; n++) {
+        urls.push_back({
+            {"url", getBaseUrl() + "/images/" + id + (n > 1 ? "/" + std::to_string(n) : "")},
+            {"content_type", images[(job.imageIndex + n - 1) % images.size()].contentType}
+        });
+        nsfw.push_back(false);
+    }
+
+    json result = {
+        {"images", urls},
+        {"seed", 42},
+        {"has_nsfw_concepts", nsfw}
+    };
+    return result.dump();
+}
+
+HttpServerResponse MockFalServer::status(const std::string& id, bool fullResult, const std::string& authorization) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fullResult ? stats.resultRequests++ : stats.statusRequests++;
+
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return HttpServerResponse::text(404, "Not Found");
+    }
+    if (it->second.authorization != authorization) {
+        stats.wrongKey++;
+        return HttpServerResponse::json(403, "{\"detail\":\"Request belongs to another key\"}");
+    }
+
+    std::string state = statusName(it->second, Clock::now());
+    if (fullResult && state == "COMPLETED") {
+        return HttpServerResponse::json(200, resultJson(id, it->second));
+    }
+
+    json response = { {"status", state} };
+    if (state == "FAILED") {
+        response["error"] = "Mock failure";
+    }
+    return HttpServerResponse::json(fullResult && state != "FAILED" ? 202 : 200, response.dump());
+}
+
+HttpServerResponse MockFalServer::cancel(const std::string& id, const std::string& authorization) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return HttpServerResponse::text(404, "Not Found");
+    }
+    if (it->second.authorization != authorization) {
+        stats.wrongKey++;
+        return HttpServerResponse::json(403, "{\"detail\":\"Request belongs to another key\"}");
+    }
+
+    if (statusName(it->second, Clock::now()) == "COMPLETED") {
+        return HttpServerResponse::json(400, "{\"status\":\"ALREADY_COMPLETED\"}");
+    }
+
+    it->second.cancelled = true;
+    stats.cancels++;
+    return HttpServerResponse::json(202, "{\"status\":\"CANCELLATION_REQUESTED\"}");
+}
+
+HttpServerResponse MockFalServer::image(const std::string& path) {
+    // {id} or {id}/{n}
+    size_t slash = path.find('/');
+    std::string id = path.substr(0, slash);
+    int n = slash == std::string::npos ? 1 : std::atoi(path.c_str() + slash + 1);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = jobs.find(id);
+    if (it == jobs.end() || statusName(it->second, Clock::now()) != "COMPLETED" || n < 1 || n > it->second.numImages) {
+        return HttpServerResponse::text(404, "Not Found");
+    }
+
+    stats.downloads++;
+    const Image& image = images[(it->second.imageIndex + n - 1) % images.size()];
+    HttpServerResponse response;
+    response.contentType = image.contentType;
+    response.body = image.bytes;
+    return response;
+}
+
+void MockFalServer::webhookLoop() {
+    while (running) {
+        std::vector<std::pair<std::string, std::string>> due; // url, body
+        Clock::time_point nextDue = Clock::now() + std::chrono::seconds(1);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            Clock::time_point now = Clock::now();
+
+            for (auto& entry : jobs) {
+                MockJob& job = entry.second;
+                if (job.webhookUrl.empty() || job.webhookSent || job.cancelled) {
+                    continue;
+                }
+
+                if (job.finishesAt > now) {
+                    nextDue = std::min(nextDue, job.finishesAt);
+                    continue;
+                }
+
+                json body = { {"request_id", entry.first} };
+                if (job.fails) {
+                    body["status"] = "ERROR";
+                    body["error"] = "Mock failure";
+                }
+                else {
+                    body["status"] = "OK";
+                    body["payload"] = json::parse(resultJson(entry.first, job));
+                }
+
+                due.emplace_back(job.webhookUrl, body.dump());
+                job.webhookSent = true;
+                stats.webhooksSent++;
+            }
+
+            if (due.empty()) {
+                webhookCondition.wait_until(lock, nextDue);
+                continue;
+            }
+        }
+
+        for (const auto& webhook : due) {
+            webhookClient.post(webhook.first, webhook.second, { "Content-Type: application/json" });
+        }
+    }
+}
+
+MockFalServer::Stats MockFalServer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void MockFalServer::printStats() const {
+    Stats s = getStats();
+    std::cout << "Mock fal: " << s.submits << " submits, " << s.statusRequests << " status + "
+        << s.resultRequests << " result polls, " << s.downloads << " downloads, "
+        << s.webhooksSent << " webhooks, " << s.cancels << " cancels, "
+        << s.failedJobs << " failed jobs";
+    if (s.throttled > 0 || s.wrongKey > 0) {
+        std::cout << ", " << s.throttled << " throttled, " << s.wrongKey << " wrong-key requests";
+    }
+    if (s.unavailable > 0) {
+        std::cout << ", " << s.unavailable << " answered 503";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HttpClient.h"
+#include "HttpServer.h"
+
+// Local stand-in for the fal.ai queue API, for load tests without network or credit.
+// Speaks the same endpoints the client uses:
+//   POST /<app>                          -> {"request_id": ...} (honours ?fal_webhook=)
+//   GET  /<app>/requests/{id}/status     -> {"status": "IN_QUEUE" | "IN_PROGRESS" | "COMPLETED" | "FAILED"}
+//   GET  /<app>/requests/{id}            -> result with images[] once done, status otherwise
+//   PUT  /<app>/requests/{id}/cancel
+// Requests are tied to the key that submitted them (403 for any other), and with
+// perKeyConcurrency set a key over its limit gets 429, like a real account.
+// With outageMs set, every queue request is answered 503 for that long after start.
+//   GET  /images/{id}[/{n}]              -> image bytes (files from imageDir, or a generated BMP);
+//                                           n = 2.. for the extra images of a num_images > 1 request
+class MockFalServer {
+public:
+    struct Options {
+        double queueDelayMs = 200.0;    // Time a job sits IN_QUEUE
+        double processingMs = 1500.0;   // Time a job spends IN_PROGRESS
+        double msPerMegapixelStep = 0;  // If set, IN_PROGRESS time is this x megapixels x num_inference_steps
+                                        // from the request instead of processingMs (~95 matches fal's flux)
+        double extraImageCost = 0.35;   // Each image past the first (num_images) adds this share of the
+                                        // IN_PROGRESS time; a batch shares one queue slot and model load
+        double jitter = 0.2;            // +/- fraction applied to both times
+        double failureRate = 0.0;       // Share of jobs that end FAILED
+        size_t imageBytes = 512 * 1024; // Approximate size of generated images
+        std::string imageDir;           // Serve these files (round robin) instead of generating
+        size_t perKeyConcurrency = 0;   // Unfinished jobs per API key before submits get 429; 0 = no limit
+        double outageMs = 0.0;          // Queue answers 503 for this long after start (image downloads still work)
+        size_t workerThreads = 8;
+    };
+
+    struct Stats {
+        uint64_t submits = 0;
+        uint64_t statusRequests = 0;
+        uint64_t resultRequests = 0;
+        uint64_t downloads = 0;
+        uint64_t cancels = 0;
+        uint64_t webhooksSent = 0;
+        uint64_t failedJobs = 0;
+        uint64_t throttled = 0;     // Submits answered 429
+        uint64_t wrongKey = 0;      // Polls/cancels with a key other than the submitter's
+        uint64_t unavailable = 0;   // Requests answered 503 during the outage
+    };
+
+    explicit MockFalServer(const Options& options);
+    ~MockFalServer();
+
+    MockFalServer(const MockFalServer&) = delete;
+    MockFalServer& operator=(const MockFalServer&) = delete;
+
+    bool start(unsigned short port);
+    void stop();
+
+    unsigned short getPort() const { return server.getPort(); }
+    std::string getBaseUrl() const;
+    Stats getStats() const;
+    void printStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct MockJob {
+        Clock::time_point startsAt;     // Leaves the queue
+        Clock::time_point finishesAt;
+        bool fails = false;
+        bool cancelled = false;
+        std::string authorization;      // Key that submitted it
+        size_t imageIndex = 0;
+        int numImages = 1;
+        std::string webhookUrl;
+        bool webhookSent = false;
+    };
+
+    struct Image {
+        std::string bytes;
+        std::string contentType;
+    };
+
+    Options options;
+    HttpServer server;
+
+    mutable std::mutex mutex;
+    std::map<std::string, MockJob> jobs;
+    std::vector<Image> images;
+    std::mt19937_64 rng;
+    uint64_t nextId;
+    Stats stats;
+    Clock::time_point outageEndsAt;
+
+    // Posts webhooks as jobs finish
+    std::thread webhookThread;
+    std::condition_variable webhookCondition;
+    std::atomic<bool> running;
+    HttpClient webhookClient;
+
+    HttpServerResponse handleRequest(const HttpServerRequest& request);
+    HttpServerResponse submit(const HttpServerRequest& request);
+    HttpServerResponse status(const std::string& id, bool fullResult, const std::string& authorization);
+    HttpServerResponse cancel(const std::string& id, const std::string& authorization);
+    HttpServerResponse image(const std::string& path);
+
+    bool loadImages();
+    std::string statusName(const MockJob& job, Clock::time_point now) const;
+    std::string resultJson(const std::string& id, const MockJob& job) const;
+    void webhookLoop();
+};
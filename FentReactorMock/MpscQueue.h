@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Multi-producer, single-consumer queue. push() is lock-free and may be called
+// from any thread; the consumer takes everything queued so far with a single
+// exchange, so draining it once per frame never blocks or waits on a producer.
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head;    // Most recently pushed
+
+public:
+    MpscQueue() : head(nullptr) {}
+
+    ~MpscQueue() {
+        drain([](T&) {});
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node{ std::move(value), head.load(std::memory_order_relaxed) };
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Consumer only. Calls f on each queued item in push order and returns how many there were.
+    template <typename F>
+    size_t drain(F&& f) {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+        // The list is newest first; reverse it so items come out in order
+        Node* oldest = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = oldest;
+            oldest = node;
+            node = next;
+        }
+
+        size_t count = 0;
+        while (oldest) {
+            Node* next = oldest->next;
+            f(oldest->value);
+            delete oldest;
+            oldest = next;
+            count++;
+        }
+        return count;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == nullptr;
+    }
+};
@@ -0,0 +1,156 @@
+#include "PayloadTemplate.h"
+#include "Backends.h"
+#include "FalApi.h"
+#include <array>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+namespace {
+    // Serializes to "{{prompt}}" - no escaping involved, and no other field can contain it
+    const char* const PROMPT_SLOT = "{{prompt}}";
+
+    size_t escapedLength(const std::string& text) {
+        size_t length = text.size();
+        for (unsigned char c : text) {
+            if (c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') {
+                length += 1;
+            }
+            else if (c < 0x20) {
+                length += 5;    // \u00XX
+            }
+        }
+        return length;
+    }
+
+    // Well-formed UTF-8 as json::dump() accepts it: no overlong forms,
+    // surrogates or code points past U+10FFFF
+    bool isValidUtf8(const std::string& text) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+        const unsigned char* end = p + text.size();
+        while (p < end) {
+            unsigned char c = *p++;
+            if (c < 0x80) {
+                continue;
+            }
+
+            int continuation;
+            unsigned char low = 0x80, high = 0xBF;     // Allowed range of the first continuation byte
+            if (c >= 0xC2 && c <= 0xDF) continuation = 1;
+            else if (c == 0xE0) { continuation = 2; low = 0xA0; }
+            else if (c == 0xED) { continuation = 2; high = 0x9F; }
+            else if (c >= 0xE1 && c <= 0xEF) continuation = 2;
+            else if (c == 0xF0) { continuation = 3; low = 0x90; }
+            else if (c == 0xF4) { continuation = 3; high = 0x8F; }
+            else if (c >= 0xF1 && c <= 0xF3) continuation = 3;
+            else return false;
+
+            if (end - p < continuation || *p < low || *p > high) {
+                return false;
+            }
+            for (int i = 1; i < continuation; i++) {
+                if (p[i] < 0x80 || p[i] > 0xBF) {
+                    return false;
+                }
+            }
+            p += continuation;
+        }
+        return true;
+    }
+}
+
+PayloadTemplate::PayloadTemplate(BackendId backend, OrientationMode orientation) {
+    int width, height;
+    FalApi::imageDimensions(orientation, width, height);
+
+    std::string body = Backends::get(backend).buildPayload(PROMPT_SLOT, width, height, 1);
+    std::string slot = std::string("\"") + PROMPT_SLOT + "\"";
+    size_t at = body.find(slot);
+    if (at == std::string::npos) {
+        std::cout << "Payload template: no prompt slot for " << Backends::get(backend).name << std::endl;
+        return;
+    }
+
+    prefix = body.substr(0, at + 1);
+    suffix = body.substr(at + slot.size() - 1);
+
+    // Keys are serialized in sorted order, so num_images comes before prompt
+    const std::string numImagesKey = "\"num_images\":1";
+    size_t key = prefix.find(numImagesKey);
+    if (key != std::string::npos) {
+        numImagesAt = key + numImagesKey.size() - 1;
+    }
+}
+
+std::string PayloadTemplate::render(const std::string& prompt, const std::string& styleModifier, int numImages) const {
+    std::string out;
+    renderInto(prompt, styleModifier, out, numImages);
+    return out;
+}
+
+void PayloadTemplate::renderInto(const std::string& prompt, const std::string& styleModifier, std::string& out, int numImages) const {
+    out.clear();
+    out.reserve(prefix.size() + 10 + escapedLength(prompt) + escapedLength(styleModifier) + suffix.size());
+    if (numImages == 1 || numImagesAt == std::string::npos) {
+        out += prefix;
+    }
+    else {
+        out.append(prefix, 0, numImagesAt);
+        out += std::to_string(numImages);
+        out.append(prefix, numImagesAt + 1, std::string::npos);
+    }
+    appendEscaped(out, prompt);
+    appendEscaped(out, styleModifier);
+    out += suffix;
+}
+
+void PayloadTemplate::appendEscaped(std::string& out, const std::string& text) {
+    static const char* hex = "0123456789abcdef";
+
+    // Let the json serializer reject it, so the error is the one buildPayload used to throw
+    if (!isValidUtf8(text)) {
+        nlohmann::json(text).dump();
+    }
+
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        // Copy the plain run before this character in one go
+        out.append(text, runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 0x0F];
+            break;
+        }
+    }
+    out.append(text, runStart, std::string::npos);
+}
+
+const PayloadTemplate& PayloadTemplates::get(BackendId backend, OrientationMode orientation) {
+    // Indexed by [BackendId][orientation]; built once, read-only afterwards
+    static const auto templates = []() {
+        std::array<std::array<PayloadTemplate, 2>, Backends::count()> built;
+        for (size_t i = 0; i < Backends::count(); i++) {
+            built[i][0] = PayloadTemplate(static_cast<BackendId>(i), OrientationMode::PORTRAIT);
+            built[i][1] = PayloadTemplate(static_cast<BackendId>(i), OrientationMode::LANDSCAPE);
+        }
+        return built;
+    }();
+
+    size_t index = static_cast<size_t>(backend);
+    return templates[index < Backends::count() ? index : 0][orientation == OrientationMode::LANDSCAPE ? 1 : 0];
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include "GenerationTypes.h"
+
+// A submission body serialized once per (backend, orientation) with a slot where
+// the prompt goes. Everything but the prompt and the candidate count - size,
+// steps, guidance, format and safety fields - is fixed for the pair, so a request
+// only costs one escaped copy of the prompt instead of building and dumping a json tree.
+//
+// Output is byte-for-byte what the backend's buildPayload produces, so result
+// cache keys are unchanged.
+class PayloadTemplate {
+private:
+    std::string prefix;     // Up to and including the prompt's opening quote
+    std::string suffix;     // From the closing quote on
+    size_t numImagesAt = std::string::npos;     // Offset of num_images' value (1) in prefix
+
+public:
+    PayloadTemplate() = default;
+    PayloadTemplate(BackendId backend, OrientationMode orientation);
+
+    // Body for prompt + styleModifier asking for numImages candidates (one
+    // allocation, sized up front)
+    std::string render(const std::string& prompt, const std::string& styleModifier, int numImages = 1) const;
+
+    // Same, into a caller-owned buffer; reusing it across a batch allocates nothing
+    // once the buffer has grown to the largest prompt
+    void renderInto(const std::string& prompt, const std::string& styleModifier, std::string& out, int numImages = 1) const;
+
+    // JSON string escaping, matching nlohmann::json::dump(). Invalid UTF-8 throws
+    // the same json::type_error dump() does.
+    static void appendEscaped(std::string& out, const std::string& text);
+};
+
+namespace PayloadTemplates {
+    // Built for every backend and orientation on first use
+    const PayloadTemplate& get(BackendId backend, OrientationMode orientation);
+}
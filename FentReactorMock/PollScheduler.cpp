@@ -0,0 +1,204 @@
+#include "PollScheduler.h"
+#include "Backends.h"
+#include "FalApi.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+PollScheduler::PollScheduler() : rng(std::random_device{}()) {
+}
+
+std::string PollScheduler::makeKey(BackendId backend, int width, int height) {
+    return FalApi::backendName(backend) + "@" + std::to_string(width) + "x" + std::to_string(height);
+}
+
+double PollScheduler::priorMs(BackendId backend) {
+    // Starting guess until real samples arrive, roughly proportional to step count
+    return Backends::get(backend).typicalMs;
+}
+
+double PollScheduler::quantile(std::vector<double> values, double q) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(q * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+void PollScheduler::estimate(const std::string& key, BackendId backend, double& expectedMs, double& p90Ms) {
+    const Distribution& dist = distributions[key];
+
+    if (dist.samples.size() < MIN_SAMPLES) {
+        // Blend the prior with whatever we have so far
+        double prior = priorMs(backend);
+        double sum = prior;
+        for (double s : dist.samples) sum += s;
+        expectedMs = sum / (dist.samples.size() + 1);
+        p90Ms = expectedMs * 1.5;
+        return;
+    }
+
+    expectedMs = quantile(dist.samples, 0.5);
+    p90Ms = std::max(quantile(dist.samples, 0.9), expectedMs * 1.1);
+}
+
+double PollScheduler::applyJitter(double delayMs) {
+    std::uniform_real_distribution<double> jitter(1.0 - JITTER, 1.0 + JITTER);
+    return delayMs * jitter(rng);
+}
+
+std::chrono::milliseconds PollScheduler::firstPollDelay(BackendId backend, int width, int height) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    double expectedMs, p90Ms;
+    estimate(makeKey(backend, width, height), backend, expectedMs, p90Ms);
+
+    // Aim for the expected completion time; jitter spreads batch polls apart
+    double delay = std::max(MIN_DELAY_MS, applyJitter(expectedMs));
+    return std::chrono::milliseconds(static_cast<long long>(delay));
+}
+
+std::chrono::milliseconds PollScheduler::afterMissedPoll(BackendId backend, int width, int height, double elapsedMs, int missedPolls) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::string key = makeKey(backend, width, height);
+    distributions[key].totalPolls++;
+    distributions[key].wastedPolls++;
+
+    double expectedMs, p90Ms;
+    estimate(key, backend, expectedMs, p90Ms);
+
+    double delay;
+    if (elapsedMs < expectedMs) {
+        // Still ahead of the typical finish (e.g. the job sat in the queue) - jump to it
+        delay = expectedMs - elapsedMs;
+    }
+    else {
+        // Past the expected time: start tight around the spread and back off
+        double base = std::max(MIN_DELAY_MS, (p90Ms - expectedMs) / 3.0);
+        int backoffSteps = std::max(0, missedPolls - 1);
+        delay = base * std::pow(BACKOFF_FACTOR, std::min(backoffSteps, 10));
+    }
+
+    delay = std::min(MAX_DELAY_MS, std::max(MIN_DELAY_MS, applyJitter(delay)));
+    return std::chrono::milliseconds(static_cast<long long>(delay));
+}
+
+void PollScheduler::recordCompletion(BackendId backend, int width, int height, double lastMissMs, double completedMs, bool viaPoll) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Distribution& dist = distributions[makeKey(backend, width, height)];
+
+    // The job finished somewhere between the last miss and this poll
+    double sample = (lastMissMs + completedMs) / 2.0;
+    if (dist.samples.size() < MAX_SAMPLES) {
+        dist.samples.push_back(sample);
+    }
+    else {
+        dist.samples[dist.nextSlot] = sample;
+    }
+    dist.nextSlot = (dist.nextSlot + 1) % MAX_SAMPLES;
+
+    dist.completions++;
+    if (viaPoll) {
+        dist.totalPolls++; // The successful poll (misses were counted as they happened)
+    }
+    dist.totalDetectionLagMs += completedMs - sample;
+
+    saveLocked();
+}
+
+std::vector<PollScheduler::Stats> PollScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<Stats> result;
+    for (const auto& entry : distributions) {
+        const Distribution& dist = entry.second;
+
+        Stats stats;
+        stats.key = entry.first;
+        stats.samples = dist.samples.size();
+        stats.expectedMs = quantile(dist.samples, 0.5);
+        stats.p90Ms = quantile(dist.samples, 0.9);
+        stats.completions = dist.completions;
+        stats.totalPolls = dist.totalPolls;
+        stats.wastedPolls = dist.wastedPolls;
+        stats.meanDetectionLagMs = dist.completions ? dist.totalDetectionLagMs / dist.completions : 0;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+uint64_t PollScheduler::getTotalPolls() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    for (const auto& entry : distributions) total += entry.second.totalPolls;
+    return total;
+}
+
+uint64_t PollScheduler::getWastedPolls() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t wasted = 0;
+    for (const auto& entry : distributions) wasted += entry.second.wastedPolls;
+    return wasted;
+}
+
+void PollScheduler::printStats() const {
+    std::cout << "Poll scheduler statistics:" << std::endl;
+    for (const Stats& stats : getStats()) {
+        std::cout << std::fixed << std::setprecision(0)
+            << "  " << stats.key
+            << ": expected " << stats.expectedMs << " ms, p90 " << stats.p90Ms << " ms"
+            << ", " << stats.completions << " done"
+            << ", polls " << stats.totalPolls << " (" << stats.wastedPolls << " wasted)"
+            << ", detection lag " << stats.meanDetectionLagMs << " ms" << std::endl;
+    }
+}
+
+void PollScheduler::setStatsFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    statsFile = path;
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return;
+    }
+
+    try {
+        json j;
+        file >> j;
+
+        for (const auto& item : j["distributions"].items()) {
+            Distribution& dist = distributions[item.key()];
+            dist.samples = item.value()["samples"].get<std::vector<double>>();
+            if (dist.samples.size() > MAX_SAMPLES) {
+                dist.samples.resize(MAX_SAMPLES);
+            }
+            dist.nextSlot = dist.samples.size() % MAX_SAMPLES;
+        }
+
+        std::cout << "Loaded poll timing history for " << distributions.size() << " backends" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Error loading poll stats: " << e.what() << std::endl;
+    }
+}
+
+void PollScheduler::saveLocked() const {
+    if (statsFile.empty()) {
+        return;
+    }
+
+    json j;
+    j["distributions"] = json::object();
+    for (const auto& entry : distributions) {
+        j["distributions"][entry.first]["samples"] = entry.second.samples;
+    }
+
+    std::ofstream file(statsFile);
+    file << j.dump(2);
+}
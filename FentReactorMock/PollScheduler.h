@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "GenerationTypes.h"
+
+// Learns how long each backend takes at each resolution and schedules status
+// polls around the expected completion time instead of a fixed 2 s sleep.
+//
+// Completion is only observed when a poll succeeds, so each sample is the
+// midpoint of the bracket [last unsuccessful poll, successful poll]. Early hits
+// pull the estimate down and misses push it up, so it settles near the true time.
+class PollScheduler {
+public:
+    struct Stats {
+        std::string key;
+        size_t samples = 0;
+        double expectedMs = 0;      // Median of recent completion times
+        double p90Ms = 0;
+        uint64_t completions = 0;
+        uint64_t totalPolls = 0;
+        uint64_t wastedPolls = 0;   // Polls that came back without a result
+        double meanDetectionLagMs = 0; // Average time between completion and noticing it
+    };
+
+    PollScheduler();
+
+    // Delay from submission to the first status poll
+    std::chrono::milliseconds firstPollDelay(BackendId backend, int width, int height);
+
+    // Call after a poll that came back without a result: counts it as wasted and
+    // returns the delay before the next one (jittered, backing off past the expected time)
+    std::chrono::milliseconds afterMissedPoll(BackendId backend, int width, int height, double elapsedMs, int missedPolls);
+
+    // Records a finished job. lastMissMs is the elapsed time of the last unsuccessful poll (0 if none).
+    // viaPoll is false when completion was pushed to us (webhook) rather than found by polling.
+    void recordCompletion(BackendId backend, int width, int height, double lastMissMs, double completedMs, bool viaPoll = true);
+
+    std::vector<Stats> getStats() const;
+    uint64_t getTotalPolls() const;
+    uint64_t getWastedPolls() const;
+    void printStats() const;
+
+    // Loads learned samples from disk and keeps the file updated as jobs finish
+    void setStatsFile(const std::string& path);
+
+private:
+    struct Distribution {
+        std::vector<double> samples;    // Ring buffer of recent completion estimates
+        size_t nextSlot = 0;
+        uint64_t completions = 0;
+        uint64_t totalPolls = 0;
+        uint64_t wastedPolls = 0;
+        double totalDetectionLagMs = 0;
+    };
+
+    static constexpr size_t MAX_SAMPLES = 32;
+    static constexpr size_t MIN_SAMPLES = 3;
+    static constexpr double MIN_DELAY_MS = 250.0;
+    static constexpr double MAX_DELAY_MS = 4000.0;
+    static constexpr double BACKOFF_FACTOR = 1.6;
+    static constexpr double JITTER = 0.2;
+
+    mutable std::mutex mutex;
+    std::map<std::string, Distribution> distributions;
+    std::mt19937 rng;
+    std::string statsFile;
+
+    static std::string makeKey(BackendId backend, int width, int height);
+    static double priorMs(BackendId backend);
+    static double quantile(std::vector<double> values, double q);
+
+    // Expected completion time and spread; caller holds the mutex
+    void estimate(const std::string& key, BackendId backend, double& expectedMs, double& p90Ms);
+    double applyJitter(double delayMs);
+    void saveLocked() const;
+};
@@ -0,0 +1,213 @@
+#include "ResultCache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+ResultCache::ResultCache() :
+    enabled(false),
+    budgetBytes(0),
+    totalBytes(0),
+    hits(0),
+    misses(0),
+    coalesced(0),
+    evictions(0) {
+}
+
+bool ResultCache::open(const std::string& path, uint64_t budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    lru.clear();
+    index.clear();
+    totalBytes = 0;
+    budgetBytes = budget;
+    enabled = false;
+
+    if (budget == 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    directory = path;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cout << "Result cache disabled: " << ec.message() << std::endl;
+        return false;
+    }
+
+    // Rebuild the LRU list from what's on disk, oldest use first
+    struct Found {
+        std::string key;
+        uint64_t size;
+        std::filesystem::file_time_type used;
+    };
+    std::vector<Found> found;
+
+    for (const auto& item : std::filesystem::directory_iterator(directory, ec)) {
+        if (!item.is_regular_file(ec) || item.path().extension() != ".img") {
+            continue;
+        }
+        found.push_back({ item.path().stem().string(), item.file_size(ec), item.last_write_time(ec) });
+    }
+
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.used < b.used; });
+    for (const Found& f : found) {
+        lru.push_front({ f.key, f.size });
+        index[f.key] = lru.begin();
+        totalBytes += f.size;
+    }
+
+    enabled = true;
+    evictLocked();
+
+    std::cout << "Result cache: " << lru.size() << " entries, " << totalBytes / 1024 << " KB of "
+        << budgetBytes / 1024 << " KB" << std::endl;
+    return true;
+}
+
+bool ResultCache::openFromEnvironment() {
+    uint64_t megabytes = 256;
+    if (const char* cacheSize = std::getenv("FAL_CACHE_MB")) {
+        megabytes = std::strtoull(cacheSize, nullptr, 10);
+    }
+    return open("cache", megabytes * 1024 * 1024);
+}
+
+bool ResultCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return enabled;
+}
+
+std::string ResultCache::makeKey(const std::string& backend, const std::string& payload) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const std::string& text) {
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(backend);
+    mix(std::string(1, '\0')); // Keep "ab"+"c" distinct from "a"+"bc"
+    mix(payload);
+
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+std::shared_ptr<const ByteBuffer> ResultCache::lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) {
+        return nullptr;
+    }
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    std::filesystem::path path = pathFor(key);
+    std::ifstream file(path, std::ios::binary);
+    auto data = std::make_shared<ByteBuffer>(it->second->size);
+    if (!file.read(reinterpret_cast<char*>(data->data()), data->size())) {
+        // Deleted or truncated behind our back
+        removeLocked(it->second);
+        misses++;
+        return nullptr;
+    }
+
+    // Mark as most recently used, in memory and on disk
+    lru.splice(lru.begin(), lru, it->second);
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    hits++;
+    return data;
+}
+
+void ResultCache::store(const std::string& key, const ByteBuffer& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled || data.empty() || data.size() > budgetBytes) {
+        return;
+    }
+
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        removeLocked(existing->second);
+    }
+
+    // Write to a temp name first so a crash never leaves a truncated entry
+    std::filesystem::path path = pathFor(key);
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file) {
+            std::cout << "Result cache: could not write " << tempPath.string() << std::endl;
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    lru.push_front({ key, data.size() });
+    index[key] = lru.begin();
+    totalBytes += data.size();
+    evictLocked();
+}
+
+void ResultCache::recordCoalesced() {
+    std::lock_guard<std::mutex> lock(mutex);
+    coalesced++;
+}
+
+ResultCache::Stats ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.coalesced = coalesced;
+    stats.evictions = evictions;
+    stats.entries = lru.size();
+    stats.bytes = totalBytes;
+    stats.budgetBytes = budgetBytes;
+    return stats;
+}
+
+void ResultCache::printStats() const {
+    Stats stats = getStats();
+    std::cout << "Result cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+        << stats.coalesced << " coalesced, " << stats.evictions << " evictions, "
+        << stats.entries << " entries (" << stats.bytes / 1024 << " KB)" << std::endl;
+}
+
+std::filesystem::path ResultCache::pathFor(const std::string& key) const {
+    return directory / (key + ".img");
+}
+
+void ResultCache::removeLocked(std::list<Entry>::iterator entry) {
+    std::error_code ec;
+    std::filesystem::remove(pathFor(entry->key), ec);
+    totalBytes -= entry->size;
+    index.erase(entry->key);
+    lru.erase(entry);
+}
+
+void ResultCache::evictLocked() {
+    while (totalBytes > budgetBytes && !lru.empty()) {
+        removeLocked(std::prev(lru.end()));
+        evictions++;
+    }
+}
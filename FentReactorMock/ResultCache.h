@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "HttpClient.h"
+
+// On-disk cache of finished generations, keyed by a hash of the backend and the
+// exact JSON payload sent to fal.ai (prompt + style modifier, image_size, steps,
+// guidance...). Entries are evicted least-recently-used once the byte budget is
+// exceeded; file modification times carry the LRU order across restarts.
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t coalesced = 0;     // Submissions that joined an identical job already in flight
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        uint64_t bytes = 0;
+        uint64_t budgetBytes = 0;
+    };
+
+    ResultCache();
+
+    // Enables the cache in directory; a zero budget leaves it disabled
+    bool open(const std::string& directory, uint64_t budgetBytes);
+
+    // open() as every mode does it: cache/ with FAL_CACHE_MB megabytes (256 if unset)
+    bool openFromEnvironment();
+    bool isEnabled() const;
+
+    // Canonical key: FNV-1a 64 over backend and payload, as 16 hex digits
+    static std::string makeKey(const std::string& backend, const std::string& payload);
+
+    // Returns null (and counts a miss) if the key isn't cached
+    std::shared_ptr<const ByteBuffer> lookup(const std::string& key);
+    void store(const std::string& key, const ByteBuffer& data);
+    void recordCoalesced();
+
+    Stats getStats() const;
+    void printStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t size = 0;
+    };
+
+    mutable std::mutex mutex;
+    std::filesystem::path directory;
+    bool enabled;
+    uint64_t budgetBytes;
+    uint64_t totalBytes;
+
+    // Front is most recently used
+    std::list<Entry> lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t coalesced;
+    uint64_t evictions;
+
+    std::filesystem::path pathFor(const std::string& key) const;
+    void removeLocked(std::list<Entry>::iterator entry);
+    void evictLocked();
+};
@@ -0,0 +1,353 @@
+#include "StyleCatalog.h"
+#include <cctype>
+
+namespace {
+    const std::vector<StyleCatalog::StyleInfo> styleTable = {
+        { StyleMode::STUDIO_GHIBLI, "studio_ghibli", APIModel::REALISM },
+        { StyleMode::PHOTOREALISTIC, "photorealistic", APIModel::REALISM },
+        { StyleMode::IMPRESSIONISM, "impressionism", APIModel::ARTISTIC },
+        { StyleMode::ABSTRACT_EXPRESSIONISM, "abstract_expressionism", APIModel::ARTISTIC },
+        { StyleMode::CUBISM, "cubism", APIModel::ARTISTIC },
+        { StyleMode::ART_DECO, "art_deco", APIModel::ARTISTIC },
+        { StyleMode::POP_ART, "pop_art", APIModel::ARTISTIC },
+        { StyleMode::REALISM_ART, "realism_art", APIModel::ARTISTIC },
+        { StyleMode::EXPRESSIONISM, "expressionism", APIModel::ARTISTIC },
+        { StyleMode::BAROQUE, "baroque", APIModel::ARTISTIC },
+        { StyleMode::FAUVISM, "fauvism", APIModel::ARTISTIC },
+        { StyleMode::NEOCLASSICISM, "neoclassicism", APIModel::ARTISTIC },
+        { StyleMode::FUTURISM, "futurism", APIModel::ARTISTIC },
+        { StyleMode::SURREALISM, "surrealism", APIModel::ARTISTIC },
+        { StyleMode::RENAISSANCE, "renaissance", APIModel::ARTISTIC },
+        { StyleMode::ACADEMIC_ART, "academic_art", APIModel::ARTISTIC },
+        { StyleMode::ANALYTICAL_ART, "analytical_art", APIModel::ARTISTIC },
+        { StyleMode::BAUHAUS, "bauhaus", APIModel::ARTISTIC },
+        { StyleMode::CONCEPTUAL_ART, "conceptual_art", APIModel::ARTISTIC },
+        { StyleMode::CONSTRUCTIVISM, "constructivism", APIModel::ARTISTIC },
+        { StyleMode::DADA, "dada", APIModel::ARTISTIC },
+        { StyleMode::GEOMETRIC_ABSTRACTION, "geometric_abstraction", APIModel::ARTISTIC },
+        { StyleMode::MINIMALISM_ART, "minimalism_art", APIModel::ARTISTIC },
+        { StyleMode::NEO_IMPRESSIONISM, "neo_impressionism", APIModel::ARTISTIC },
+        { StyleMode::POST_IMPRESSIONISM, "post_impressionism", APIModel::ARTISTIC },
+        { StyleMode::MID_CENTURY_MODERN, "mid_century_modern", APIModel::ARTISTIC },
+        { StyleMode::BOHEMIAN, "bohemian", APIModel::ARTISTIC },
+        { StyleMode::MINIMALISM_DESIGN, "minimalism_design", APIModel::ARTISTIC },
+        { StyleMode::SCANDINAVIAN, "scandinavian", APIModel::ARTISTIC },
+        { StyleMode::ART_DECO_DESIGN, "art_deco_design", APIModel::ARTISTIC },
+        { StyleMode::FARMHOUSE, "farmhouse", APIModel::ARTISTIC },
+        { StyleMode::INDUSTRIAL, "industrial", APIModel::ARTISTIC },
+        { StyleMode::CONTEMPORARY, "contemporary", APIModel::ARTISTIC },
+        { StyleMode::TRADITIONAL, "traditional", APIModel::ARTISTIC },
+        { StyleMode::RUSTIC, "rustic", APIModel::ARTISTIC },
+        { StyleMode::TRANSITIONAL, "transitional", APIModel::ARTISTIC },
+        { StyleMode::FRENCH_COUNTRY, "french_country", APIModel::ARTISTIC },
+        { StyleMode::JAPANDI, "japandi", APIModel::ARTISTIC },
+        { StyleMode::MEDITERRANEAN, "mediterranean", APIModel::ARTISTIC },
+        { StyleMode::SHABBY_CHIC, "shabby_chic", APIModel::ARTISTIC },
+        { StyleMode::ECLECTIC, "eclectic", APIModel::ARTISTIC },
+        { StyleMode::REGENCY, "regency", APIModel::ARTISTIC },
+        { StyleMode::COASTAL, "coastal", APIModel::ARTISTIC },
+        { StyleMode::MAXIMALISM, "maximalism", APIModel::ARTISTIC },
+        { StyleMode::CYBERPUNK, "cyberpunk", APIModel::GAMING_TECH },
+        { StyleMode::SYNTHWAVE, "synthwave", APIModel::GAMING_TECH },
+        { StyleMode::PIXEL_ART, "pixel_art", APIModel::GAMING_TECH },
+        { StyleMode::ANIME_MANGA, "anime_manga", APIModel::GAMING_TECH },
+        { StyleMode::SCI_FI_TECH, "sci_fi_tech", APIModel::GAMING_TECH },
+        { StyleMode::RETRO_GAMING, "retro_gaming", APIModel::GAMING_TECH },
+        { StyleMode::MOVIE_POSTER, "movie_poster", APIModel::ENTERTAINMENT },
+        { StyleMode::FILM_NOIR, "film_noir", APIModel::ENTERTAINMENT },
+        { StyleMode::CONCERT_POSTER, "concert_poster", APIModel::ENTERTAINMENT },
+        { StyleMode::SPORTS_MEMORABILIA, "sports_memorabilia", APIModel::ENTERTAINMENT },
+        { StyleMode::VINTAGE_CINEMA, "vintage_cinema", APIModel::ENTERTAINMENT },
+        { StyleMode::CORPORATE_MODERN, "corporate_modern", APIModel::PROFESSIONAL },
+        { StyleMode::ABSTRACT_CORPORATE, "abstract_corporate", APIModel::PROFESSIONAL },
+        { StyleMode::NATURE_ZEN, "nature_zen", APIModel::PROFESSIONAL },
+        { StyleMode::CULINARY_KITCHEN, "culinary_kitchen", APIModel::SPECIALTY_ROOMS },
+        { StyleMode::LIBRARY_ACADEMIC, "library_academic", APIModel::SPECIALTY_ROOMS },
+        { StyleMode::FITNESS_GYM, "fitness_gym", APIModel::SPECIALTY_ROOMS },
+        { StyleMode::KIDS_CARTOON, "kids_cartoon", APIModel::SPECIALTY_ROOMS },
+        { StyleMode::PHOTOREALISTIC_LANDSCAPES, "photorealistic_landscapes", APIModel::LANDSCAPES },
+        { StyleMode::SEASONAL_LANDSCAPES, "seasonal_landscapes", APIModel::LANDSCAPES },
+        { StyleMode::WEATHER_MOODS, "weather_moods", APIModel::LANDSCAPES },
+        { StyleMode::TIME_OF_DAY, "time_of_day", APIModel::LANDSCAPES },
+    };
+
+    // Indexed by APIModel
+    const std::vector<StyleCatalog::CategoryInfo> categoryTable = {
+        { APIModel::REALISM, "realism", "Realism" },
+        { APIModel::AESTHETIC, "aesthetic", "Aesthetic" },
+        { APIModel::ARTISTIC, "artistic", "Artistic" },
+        { APIModel::GAMING_TECH, "gaming_tech", "Gaming & Tech" },
+        { APIModel::ENTERTAINMENT, "entertainment", "Entertainment" },
+        { APIModel::PROFESSIONAL, "professional", "Professional" },
+        { APIModel::SPECIALTY_ROOMS, "specialty_rooms", "Specialty Rooms" },
+        { APIModel::LANDSCAPES, "landscapes", "Landscapes" },
+    };
+
+    // "Gaming & Tech" / "gaming-tech" -> "gaming_tech"
+    std::string normalizeKey(const std::string& text) {
+        std::string key;
+        for (unsigned char c : text) {
+            if (std::isalnum(c)) {
+                key += static_cast<char>(std::tolower(c));
+            }
+            else if (!key.empty() && key.back() != '_') {
+                key += '_';
+            }
+        }
+        while (!key.empty() && key.back() == '_') {
+            key.pop_back();
+        }
+        return key;
+    }
+
+    const StyleCatalog::StyleInfo* findStyle(StyleMode style) {
+        for (const StyleCatalog::StyleInfo& info : styleTable) {
+            if (info.style == style) return &info;
+        }
+        return nullptr;
+    }
+}
+
+const std::vector<StyleCatalog::StyleInfo>& StyleCatalog::styles() {
+    return styleTable;
+}
+
+const std::vector<StyleCatalog::CategoryInfo>& StyleCatalog::categories() {
+    return categoryTable;
+}
+
+bool StyleCatalog::styleFromKey(const std::string& key, StyleMode& style) {
+    std::string normalized = normalizeKey(key);
+    if (normalized.empty() || normalized == "none") {
+        style = StyleMode::NONE;
+        return true;
+    }
+
+    for (const StyleInfo& info : styleTable) {
+        if (normalized == info.key) {
+            style = info.style;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StyleCatalog::categoryFromKey(const std::string& key, APIModel& category) {
+    std::string normalized = normalizeKey(key);
+    for (const CategoryInfo& info : categoryTable) {
+        if (normalized == info.key) {
+            category = info.category;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* StyleCatalog::styleKey(StyleMode style) {
+    const StyleInfo* info = findStyle(style);
+    return info ? info->key : "none";
+}
+
+const char* StyleCatalog::categoryKey(APIModel category) {
+    size_t index = static_cast<size_t>(category);
+    return index < categoryTable.size() ? categoryTable[index].key : "unknown";
+}
+
+std::string StyleCatalog::categoryName(APIModel category) {
+    size_t index = static_cast<size_t>(category);
+    return index < categoryTable.size() ? categoryTable[index].name : "Unknown";
+}
+
+std::string StyleCatalog::styleName(StyleMode style) {
+    switch (style) {
+    case StyleMode::STUDIO_GHIBLI: return "Studio Ghibli";
+    case StyleMode::PHOTOREALISTIC: return "Photorealistic";
+    case StyleMode::IMPRESSIONISM: return "Impressionism";
+    case StyleMode::ABSTRACT_EXPRESSIONISM: return "Abstract Expressionism";
+    case StyleMode::CUBISM: return "Cubism";
+    case StyleMode::CYBERPUNK: return "Cyberpunk";
+    case StyleMode::SYNTHWAVE: return "Synthwave";
+    case StyleMode::PIXEL_ART: return "Pixel Art";
+    case StyleMode::ANIME_MANGA: return "Anime/Manga";
+    case StyleMode::SCI_FI_TECH: return "Sci-Fi Tech";
+    case StyleMode::RETRO_GAMING: return "Retro Gaming";
+    case StyleMode::MOVIE_POSTER: return "Movie Poster";
+    case StyleMode::FILM_NOIR: return "Film Noir";
+    case StyleMode::CONCERT_POSTER: return "Concert Poster";
+    case StyleMode::SPORTS_MEMORABILIA: return "Sports Memorabilia";
+    case StyleMode::VINTAGE_CINEMA: return "Vintage Cinema";
+    case StyleMode::CORPORATE_MODERN: return "Corporate Modern";
+    case StyleMode::ABSTRACT_CORPORATE: return "Abstract Corporate";
+    case StyleMode::NATURE_ZEN: return "Nature/Zen";
+    case StyleMode::CULINARY_KITCHEN: return "Culinary/Kitchen";
+    case StyleMode::LIBRARY_ACADEMIC: return "Library/Academic";
+    case StyleMode::FITNESS_GYM: return "Fitness/Gym";
+    case StyleMode::KIDS_CARTOON: return "Kids/Cartoon";
+    case StyleMode::PHOTOREALISTIC_LANDSCAPES: return "Photorealistic Landscapes";
+    case StyleMode::SEASONAL_LANDSCAPES: return "Seasonal Landscapes";
+    case StyleMode::WEATHER_MOODS: return "Weather Moods";
+    case StyleMode::TIME_OF_DAY: return "Time of Day";
+    case StyleMode::NONE: return "None";
+    default: return "Custom Style";
+    }
+}
+
+APIModel StyleCatalog::defaultCategory(StyleMode style) {
+    const StyleInfo* info = findStyle(style);
+    return info ? info->category : APIModel::REALISM;
+}
+
+std::string StyleCatalog::promptModifier(StyleMode style) {
+    switch (style) {
+    case StyleMode::STUDIO_GHIBLI:
+        return ", in the style of Studio Ghibli";
+    case StyleMode::PHOTOREALISTIC:
+        return ", photorealistic photography, ultra realistic, highly detailed, 8k resolution, professional photography, sharp focus, real world";
+
+        // Artistic styles (existing)
+    case StyleMode::IMPRESSIONISM:
+        return ", impressionist painting style, loose brushwork, light and color emphasis, plein air technique";
+    case StyleMode::ABSTRACT_EXPRESSIONISM:
+        return ", abstract expressionist painting, bold colors, emotional intensity, non-representational";
+    case StyleMode::CUBISM:
+        return ", cubist painting style, geometric forms, multiple perspectives, fragmented composition";
+    case StyleMode::ART_DECO:
+        return ", Art Deco style painting, geometric patterns, bold lines, luxury aesthetic, 1920s design";
+    case StyleMode::POP_ART:
+        return ", pop art style, bright colors, commercial imagery, bold graphics, contemporary culture";
+    case StyleMode::REALISM_ART:
+        return ", photorealistic oil painting style, hyperrealistic digital art, detailed brush techniques, fine art realism";
+    case StyleMode::EXPRESSIONISM:
+        return ", expressionist painting, emotional intensity, distorted forms, vivid colors";
+    case StyleMode::BAROQUE:
+        return ", baroque painting style, dramatic lighting, rich colors, ornate details, classical composition";
+    case StyleMode::FAUVISM:
+        return ", fauvist painting style, wild colors, bold brushstrokes, expressive use of color";
+    case StyleMode::NEOCLASSICISM:
+        return ", neoclassical painting style, classical subjects, balanced composition, idealized forms";
+    case StyleMode::FUTURISM:
+        return ", futurist painting style, dynamic movement, mechanical forms, speed and technology";
+    case StyleMode::SURREALISM:
+        return ", surrealist painting, dreamlike imagery, unexpected juxtapositions, subconscious exploration";
+    case StyleMode::RENAISSANCE:
+        return ", Renaissance painting style, classical techniques, realistic proportions, religious or mythological themes";
+    case StyleMode::ACADEMIC_ART:
+        return ", academic art style, classical training, realistic representation, traditional techniques";
+    case StyleMode::ANALYTICAL_ART:
+        return ", analytical art approach, systematic study, geometric analysis, structural composition";
+    case StyleMode::BAUHAUS:
+        return ", Bauhaus art style, functional design, geometric forms, modernist aesthetic";
+    case StyleMode::CONCEPTUAL_ART:
+        return ", conceptual art style, idea-based artwork, minimal execution, thought-provoking";
+    case StyleMode::CONSTRUCTIVISM:
+        return ", constructivist art style, abstract geometric forms, revolutionary aesthetics, industrial materials";
+    case StyleMode::DADA:
+        return ", dadaist art style, anti-art movement, absurd imagery, collage techniques";
+    case StyleMode::GEOMETRIC_ABSTRACTION:
+        return ", geometric abstract painting, mathematical precision, clean lines, color relationships";
+    case StyleMode::MINIMALISM_ART:
+        return ", minimalist art style, simple forms, reduced elements, essential composition";
+    case StyleMode::NEO_IMPRESSIONISM:
+        return ", neo-impressionist painting, pointillist technique, scientific color theory, optical mixing";
+    case StyleMode::POST_IMPRESSIONISM:
+        return ", post-impressionist painting style, symbolic content, synthetic color, expressive brushwork";
+
+        // Interior design styles (existing)
+    case StyleMode::MID_CENTURY_MODERN:
+        return ", abstract art piece with mid-century modern aesthetic, clean geometric shapes, retro color palette, minimalist composition, wall art";
+    case StyleMode::BOHEMIAN:
+        return ", bohemian art piece, eclectic artistic composition, vibrant earth tones, free-spirited design, textile-inspired patterns, wall art";
+    case StyleMode::MINIMALISM_DESIGN:
+        return ", minimalist art piece, simple geometric forms, neutral color scheme, clean composition, negative space, wall art";
+    case StyleMode::SCANDINAVIAN:
+        return ", Scandinavian-inspired art piece, light natural colors, simple organic shapes, hygge aesthetic, wall art";
+    case StyleMode::ART_DECO_DESIGN:
+        return ", Art Deco art piece, geometric patterns, gold and black color scheme, luxury design elements, wall art";
+    case StyleMode::FARMHOUSE:
+        return ", farmhouse-style art piece, rustic textures, natural wood tones, vintage americana, cozy aesthetic, wall art";
+    case StyleMode::INDUSTRIAL:
+        return ", industrial-style art piece, metallic textures, exposed materials aesthetic, urban design, wall art";
+    case StyleMode::CONTEMPORARY:
+        return ", contemporary art piece, modern design elements, sophisticated color palette, current artistic trends, wall art";
+    case StyleMode::TRADITIONAL:
+        return ", traditional art piece, classic design motifs, refined color scheme, timeless composition, wall art";
+    case StyleMode::RUSTIC:
+        return ", rustic art piece, natural weathered textures, earth tone palette, countryside aesthetic, wall art";
+    case StyleMode::TRANSITIONAL:
+        return ", transitional art piece, balanced modern and classic elements, neutral sophisticated palette, wall art";
+    case StyleMode::FRENCH_COUNTRY:
+        return ", French country art piece, pastoral motifs, soft romantic colors, vintage charm, wall art";
+    case StyleMode::JAPANDI:
+        return ", Japandi art piece, zen minimalism, natural wood and stone textures, peaceful composition, wall art";
+    case StyleMode::MEDITERRANEAN:
+        return ", Mediterranean art piece, warm terracotta and blue colors, coastal-inspired design, relaxed elegance, wall art";
+    case StyleMode::SHABBY_CHIC:
+        return ", shabby chic art piece, vintage distressed textures, soft pastel colors, romantic feminine aesthetic, wall art";
+    case StyleMode::ECLECTIC:
+        return ", eclectic art piece, mixed artistic styles, bold creative composition, diverse design elements, wall art";
+    case StyleMode::REGENCY:
+        return ", Regency-style art piece, elegant classical motifs, sophisticated color palette, refined composition, wall art";
+    case StyleMode::COASTAL:
+        return ", coastal art piece, ocean-inspired colors, beach aesthetic, nautical design elements, wall art";
+    case StyleMode::MAXIMALISM:
+        return ", maximalist art piece, bold patterns and colors, rich decorative elements, abundant visual interest, wall art";
+
+        // Gaming & Tech styles (NEW)
+    case StyleMode::CYBERPUNK:
+        return ", cyberpunk art style, neon lights, dark urban atmosphere, futuristic technology, digital rain effects, purple and cyan color scheme, high-tech aesthetic";
+    case StyleMode::SYNTHWAVE:
+        return ", synthwave aesthetic, retro-futuristic, neon pink and blue gradients, geometric shapes, 1980s sci-fi atmosphere, grid patterns, outrun style";
+    case StyleMode::PIXEL_ART:
+        return ", pixel art style, 8-bit graphics, retro gaming aesthetic, blocky forms, limited color palette, digital art, pixelated composition";
+    case StyleMode::ANIME_MANGA:
+        return ", anime manga art style, cel-shaded illustration, vibrant colors, Japanese animation aesthetic, clean line art, expressive character design";
+    case StyleMode::SCI_FI_TECH:
+        return ", sci-fi technology art, futuristic interface design, holographic elements, circuit board patterns, advanced technology aesthetic, digital interfaces";
+    case StyleMode::RETRO_GAMING:
+        return ", retro gaming art style, arcade aesthetics, vintage video game graphics, nostalgic gaming atmosphere, classic console era design";
+
+        // Entertainment styles (NEW)
+    case StyleMode::MOVIE_POSTER:
+        return ", movie poster composition, dramatic lighting, cinematic framing, bold visual hierarchy, theatrical atmosphere, film marketing aesthetic, dynamic layout";
+    case StyleMode::FILM_NOIR:
+        return ", film noir style, high contrast black and white, dramatic shadows, venetian blind lighting, 1940s atmosphere, mysterious mood, chiaroscuro lighting";
+    case StyleMode::CONCERT_POSTER:
+        return ", concert poster design, music venue aesthetics, rock poster style, bold typography space, energetic composition, live music atmosphere";
+    case StyleMode::SPORTS_MEMORABILIA:
+        return ", sports memorabilia style, team colors, athletic imagery, stadium atmosphere, championship aesthetic, competitive sports design";
+    case StyleMode::VINTAGE_CINEMA:
+        return ", vintage cinema poster, classic Hollywood glamour, golden age of film, retro movie advertising, nostalgic film aesthetic";
+
+        // Professional styles (NEW)
+    case StyleMode::CORPORATE_MODERN:
+        return ", corporate modern art, clean professional aesthetic, sophisticated color palette, minimalist business environment, executive office style, contemporary corporate design";
+    case StyleMode::ABSTRACT_CORPORATE:
+        return ", abstract corporate art, professional artistic composition, sophisticated geometric forms, business-appropriate design, modern office aesthetic";
+    case StyleMode::NATURE_ZEN:
+        return ", zen nature art, calming natural themes, peaceful landscape elements, stress-relief aesthetic, meditative composition, serene natural beauty";
+
+        // Specialty Room styles (NEW)
+    case StyleMode::CULINARY_KITCHEN:
+        return ", culinary kitchen art, food photography style, cookbook aesthetic, kitchen design elements, culinary arts composition, cooking inspiration design";
+    case StyleMode::LIBRARY_ACADEMIC:
+        return ", library academic art, scholarly aesthetic, book-inspired design, educational themes, intellectual atmosphere, academic institution style";
+    case StyleMode::FITNESS_GYM:
+        return ", fitness gym art, motivational athletic themes, dynamic energy composition, workout inspiration design, sports performance aesthetic, active lifestyle imagery";
+    case StyleMode::KIDS_CARTOON:
+        return ", kids cartoon art style, bright playful colors, child-friendly design, animated cartoon aesthetic, whimsical illustration, fun children's room decor";
+
+        // Landscape styles (NEW)
+    case StyleMode::PHOTOREALISTIC_LANDSCAPES:
+        return ", photorealistic landscape photography, dramatic natural scenery, high detail nature scene, professional landscape photography, stunning wilderness vista";
+    case StyleMode::SEASONAL_LANDSCAPES:
+        return ", seasonal landscape photography, natural seasonal beauty, changing seasons atmosphere, weather-specific natural scenery, seasonal nature composition";
+    case StyleMode::WEATHER_MOODS:
+        return ", weather mood landscape, atmospheric weather conditions, dramatic sky formations, meteorological beauty, climate-inspired natural scenes";
+    case StyleMode::TIME_OF_DAY:
+        return ", time of day landscape, golden hour lighting, sunrise sunset scenery, natural lighting variations, diurnal beauty, time-specific atmosphere";
+
+    case StyleMode::NONE:
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "GenerationTypes.h"
+
+// Style and category tables shared by the UI and the headless modes. Keys are
+// the stable snake_case names used on the command line and in batch manifests.
+namespace StyleCatalog {
+    struct StyleInfo {
+        StyleMode style;
+        const char* key;
+        APIModel category;      // Category whose style list offers it in the UI
+    };
+
+    struct CategoryInfo {
+        APIModel category;
+        const char* key;
+        const char* name;       // As shown on the category buttons
+    };
+
+    // Every style except NONE, in StyleMode order
+    const std::vector<StyleInfo>& styles();
+    const std::vector<CategoryInfo>& categories();
+
+    // Text appended to the prompt for a style ("" for NONE)
+    std::string promptModifier(StyleMode style);
+
+    // Looks a style or category up by key. Display spellings such as
+    // "Pixel Art" or "Gaming & Tech" are accepted too. False if unknown.
+    bool styleFromKey(const std::string& key, StyleMode& style);
+    bool categoryFromKey(const std::string& key, APIModel& category);
+
+    const char* styleKey(StyleMode style);
+    const char* categoryKey(APIModel category);
+    std::string categoryName(APIModel category);
+
+    // Display name, as recorded in the gallery ("Pixel Art", "None")
+    std::string styleName(StyleMode style);
+
+    // Category a style belongs to, used when a manifest row names only the style
+    APIModel defaultCategory(StyleMode style);
+}
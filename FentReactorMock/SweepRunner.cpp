@@ -0,0 +1,370 @@
+#include "SweepRunner.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include "Backends.h"
+#include "GenerationEngine.h"
+#include "HttpClient.h"
+#include "PollScheduler.h"
+#include "StyleCatalog.h"
+
+namespace {
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    // "a, b,,c" -> {"a", "b", "c"}
+    std::vector<std::string> splitList(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            size_t start = item.find_first_not_of(" \t");
+            if (start == std::string::npos) continue;
+            size_t end = item.find_last_not_of(" \t");
+            items.push_back(item.substr(start, end - start + 1));
+        }
+        return items;
+    }
+
+    template <typename T>
+    void addUnique(std::vector<T>& values, T value) {
+        if (std::find(values.begin(), values.end(), value) == values.end()) {
+            values.push_back(value);
+        }
+    }
+
+    // 130000 -> "2m 10s"
+    std::string formatDuration(double ms) {
+        long long seconds = static_cast<long long>(ms / 1000.0 + 0.5);
+        std::stringstream text;
+        if (seconds >= 3600) {
+            text << seconds / 3600 << "h " << (seconds % 3600) / 60 << "m";
+        }
+        else if (seconds >= 60) {
+            text << seconds / 60 << "m " << seconds % 60 << "s";
+        }
+        else {
+            text << seconds << "s";
+        }
+        return text.str();
+    }
+
+    const char* orientationKey(OrientationMode orientation) {
+        return orientation == OrientationMode::LANDSCAPE ? "landscape" : "portrait";
+    }
+}
+
+std::vector<SweepRunner::Cell> SweepRunner::expand(const Options& options) {
+    std::vector<StyleMode> styles = options.styles;
+    if (styles.empty()) styles.push_back(StyleMode::NONE);
+    std::vector<OrientationMode> orientations = options.orientations;
+    if (orientations.empty()) orientations.push_back(OrientationMode::PORTRAIT);
+
+    std::vector<Cell> cells;
+    for (StyleMode style : styles) {
+        std::vector<APIModel> categories = options.categories;
+        if (categories.empty()) categories.push_back(StyleCatalog::defaultCategory(style));
+
+        for (APIModel category : categories) {
+            for (OrientationMode orientation : orientations) {
+                Cell cell;
+                cell.style = style;
+                cell.category = category;
+                cell.orientation = orientation;
+                cells.push_back(cell);
+            }
+        }
+    }
+    return cells;
+}
+
+bool SweepRunner::parseStyles(const std::string& list, std::vector<StyleMode>& styles, std::string& error) {
+    for (const std::string& item : splitList(list)) {
+        StyleMode style;
+        APIModel category;
+        if (toLower(item) == "all") {
+            for (const StyleCatalog::StyleInfo& info : StyleCatalog::styles()) {
+                addUnique(styles, info.style);
+            }
+        }
+        else if (StyleCatalog::styleFromKey(item, style)) {
+            addUnique(styles, style);
+        }
+        else if (StyleCatalog::categoryFromKey(item, category)) {
+            // A category stands for every style listed under it
+            bool found = false;
+            for (const StyleCatalog::StyleInfo& info : StyleCatalog::styles()) {
+                if (info.category == category) {
+                    addUnique(styles, info.style);
+                    found = true;
+                }
+            }
+            if (!found) {
+                error = "Category '" + item + "' has no styles of its own; pass it with --categories";
+                return false;
+            }
+        }
+        else {
+            error = "Unknown style '" + item + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SweepRunner::parseCategories(const std::string& list, std::vector<APIModel>& categories, std::string& error) {
+    for (const std::string& item : splitList(list)) {
+        APIModel category;
+        if (toLower(item) == "all") {
+            for (const StyleCatalog::CategoryInfo& info : StyleCatalog::categories()) {
+                addUnique(categories, info.category);
+            }
+        }
+        else if (StyleCatalog::categoryFromKey(item, category)) {
+            addUnique(categories, category);
+        }
+        else {
+            error = "Unknown category '" + item + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SweepRunner::parseOrientations(const std::string& list, std::vector<OrientationMode>& orientations, std::string& error) {
+    for (const std::string& item : splitList(list)) {
+        std::string mode = toLower(item);
+        if (mode == "portrait" || mode == "both") {
+            addUnique(orientations, OrientationMode::PORTRAIT);
+        }
+        if (mode == "landscape" || mode == "both") {
+            addUnique(orientations, OrientationMode::LANDSCAPE);
+        }
+        if (mode != "portrait" && mode != "landscape" && mode != "both") {
+            error = "Unknown orientation '" + item + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string SweepRunner::makeSweepId() {
+    return "sweep_" + Gallery::timestamp();
+}
+
+std::string SweepRunner::outputFile(const std::string& sweepId, size_t index, const Cell& cell) {
+    std::stringstream name;
+    name << Gallery::ROOT << "/" << orientationKey(cell.orientation) << "/" << sweepId << "_"
+        << std::setw(3) << std::setfill('0') << index + 1 << "_" << StyleCatalog::styleKey(cell.style)
+        << "_" << StyleCatalog::categoryKey(cell.category) << ".jpg";
+    return name.str();
+}
+
+SavedImage SweepRunner::galleryEntry(const std::string& sweepId, const std::string& prompt, const Cell& cell,
+    const std::string& file) {
+    SavedImage image(file, prompt, StyleCatalog::categoryName(cell.category), StyleCatalog::styleName(cell.style),
+        Gallery::timestamp(), cell.orientation == OrientationMode::LANDSCAPE);
+    image.sweepId = sweepId;
+    return image;
+}
+
+SweepRunner::Progress::Progress(const std::vector<BackendId>& cellBackends, size_t concurrency) :
+    total(cellBackends.size()),
+    finished(0),
+    failed(0),
+    concurrency(std::max<size_t>(1, concurrency)) {
+    for (BackendId backend : cellBackends) {
+        BackendProgress& entry = backends[backend];
+        entry.remaining++;
+        entry.priorMs = Backends::get(backend).typicalMs;
+    }
+}
+
+void SweepRunner::Progress::setPrior(BackendId backend, double ms) {
+    auto it = backends.find(backend);
+    if (it != backends.end() && ms > 0) {
+        it->second.priorMs = ms;
+    }
+}
+
+void SweepRunner::Progress::loadPriors(const PollScheduler& scheduler) {
+    // Learned completion times are keyed "<backend>@<width>x<height>"; average a backend's resolutions
+    std::map<BackendId, std::pair<double, size_t>> learned;
+    for (const PollScheduler::Stats& stats : scheduler.getStats()) {
+        BackendId backend;
+        if (stats.samples == 0 || !Backends::fromName(stats.key.substr(0, stats.key.find('@')), backend)) {
+            continue;
+        }
+        learned[backend].first += stats.expectedMs;
+        learned[backend].second++;
+    }
+
+    for (const auto& entry : learned) {
+        setPrior(entry.first, entry.second.first / entry.second.second);
+    }
+}
+
+void SweepRunner::Progress::recordFinished(BackendId backend, double totalMs, bool success) {
+    finished++;
+    if (!success) failed++;
+
+    BackendProgress& entry = backends[backend];
+    if (entry.remaining > 0) entry.remaining--;
+
+    // Failures often come back early and would make the rest look quicker than it is
+    if (success) {
+        entry.samples++;
+        entry.totalMs += totalMs;
+    }
+}
+
+double SweepRunner::Progress::etaMs() const {
+    size_t remaining = total - std::min(finished, total);
+    if (remaining == 0) {
+        return 0;
+    }
+
+    // Remaining work shared across the in-flight window. Cells already running
+    // are counted in full, so this errs long by at most one cell's latency.
+    double workMs = 0;
+    for (const auto& entry : backends) {
+        const BackendProgress& backend = entry.second;
+        double meanMs = backend.samples > 0 ? backend.totalMs / backend.samples : backend.priorMs;
+        workMs += backend.remaining * meanMs;
+    }
+    return workMs / std::min(concurrency, remaining);
+}
+
+std::string SweepRunner::Progress::etaText() const {
+    return formatDuration(etaMs());
+}
+
+std::string SweepRunner::Progress::describe() const {
+    std::stringstream text;
+    text << finished << "/" << total << " done";
+    if (failed > 0) {
+        text << ", " << failed << " failed";
+    }
+    if (!isDone()) {
+        text << ", about " << etaText() << " left";
+    }
+    return text.str();
+}
+
+int SweepRunner::run(const Options& options) {
+    if (options.prompt.empty()) {
+        std::cout << "Sweep: missing prompt" << std::endl;
+        return 1;
+    }
+
+    // Route every cell to one backend if asked to (flag first, then FAL_BACKEND)
+    bool hasPinnedBackend = false;
+    BackendId pinnedBackend = BackendId::FLUX_SCHNELL;
+    std::string backendName = options.backend;
+    if (!Backends::pinFromEnvironment(backendName, hasPinnedBackend, pinnedBackend)) {
+        std::cout << "Sweep: unknown backend " << backendName << std::endl;
+        return 1;
+    }
+
+    std::string sweepId = options.sweepId.empty() ? makeSweepId() : options.sweepId;
+    std::error_code ec;
+    std::filesystem::create_directories(std::string(Gallery::ROOT) + "/portrait", ec);
+    std::filesystem::create_directories(std::string(Gallery::ROOT) + "/landscape", ec);
+
+    size_t concurrency = static_cast<size_t>(std::max(1, options.concurrency));
+
+    HttpClient http;
+    GenerationEngine engine(http, concurrency);
+    engine.getPollScheduler().setStatsFile("poll_stats.json");
+
+    engine.getResultCache().openFromEnvironment();
+
+    // Routed once, up front: a contact sheet compares styles, so a category's
+    // cells stay on one backend for the whole sweep
+    std::vector<Cell> cells = expand(options);
+    std::vector<BackendId> cellBackends;
+    for (const Cell& cell : cells) {
+        cellBackends.push_back(hasPinnedBackend ? pinnedBackend : engine.routeCategory(cell.category));
+    }
+
+    Progress progress(cellBackends, concurrency);
+    progress.loadPriors(engine.getPollScheduler());
+
+    std::cout << "Sweep " << sweepId << ": " << cells.size() << " images ("
+        << std::max<size_t>(1, options.styles.size()) << " styles x "
+        << (options.categories.empty() ? std::string("own category") : std::to_string(options.categories.size()) + " categories")
+        << " x " << std::max<size_t>(1, options.orientations.size()) << " orientations), concurrency " << concurrency
+        << ", " << progress.describe() << std::endl;
+
+    // Guards progress, the gallery file and the in-flight window
+    std::mutex mutex;
+    std::condition_variable slotFreed;
+    size_t inFlight = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < cells.size(); i++) {
+        const Cell& cell = cells[i];
+
+        // Only `concurrency` jobs in the engine, so each one's latency is its own
+        // generation time and the ETA is built from honest samples
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFreed.wait(lock, [&]() { return inFlight < concurrency; });
+            inFlight++;
+        }
+
+        GenerationRequest request;
+        request.prompt = options.prompt;
+        request.styleModifier = StyleCatalog::promptModifier(cell.style);
+        request.backend = cellBackends[i];
+        request.orientation = cell.orientation;
+        request.client = "sweep";
+        request.priority = JobPriority::BATCH;
+
+        std::string file = outputFile(sweepId, i, cell);
+
+        engine.submit(request, file, [&, cell, i](const GenerationResult& result) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                progress.recordFinished(cellBackends[i], result.totalMs, result.success);
+
+                // Added as each lands, so an interrupted sweep still shows what it finished
+                if (result.success && !Gallery::append({ galleryEntry(sweepId, options.prompt, cell, result.filename) })) {
+                    std::cout << "Sweep: could not update " << Gallery::METADATA_PATH << std::endl;
+                }
+
+                std::cout << "[" << progress.describe() << "] " << (result.success ? "ok " : "FAILED ")
+                    << StyleCatalog::styleKey(cell.style) << " / " << StyleCatalog::categoryKey(cell.category) << " / "
+                    << orientationKey(cell.orientation) << " "
+                    << (result.success ? std::to_string(static_cast<int>(result.totalMs)) + " ms" : result.error) << std::endl;
+                inFlight--;
+            }
+            slotFreed.notify_one();
+        });
+    }
+
+    engine.waitUntilIdle();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(2)
+        << "Sweep " << sweepId << " finished: " << progress.getFinished() - progress.getFailed() << "/"
+        << progress.getTotal() << " images in " << wallSeconds << " s, " << progress.getFailed()
+        << " failed. Open the gallery's Sweeps tab for the contact sheet" << std::endl;
+    engine.getPollScheduler().printStats();
+    engine.getResultCache().printStats();
+    FalApi::credentials().printStats();
+    engine.getCircuitBreaker().printStats();
+    engine.getRouter().printStats();
+
+    return progress.getFailed() == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Gallery.h"
+#include "GenerationTypes.h"
+
+class PollScheduler;
+
+// One prompt across every combination of a chosen set of styles, categories and
+// orientations. Images go straight into the gallery tagged with the sweep id,
+// so the contact sheet shows them side by side. --sweep in main.cpp runs one
+// headless; the UI's Sweep button drives its own engine with the same pieces.
+namespace SweepRunner {
+    struct Cell {
+        StyleMode style = StyleMode::NONE;
+        APIModel category = APIModel::REALISM;
+        OrientationMode orientation = OrientationMode::PORTRAIT;
+    };
+
+    struct Options {
+        std::string prompt;
+        std::vector<StyleMode> styles;              // Empty = no style
+        std::vector<APIModel> categories;           // Empty = each style's own category
+        std::vector<OrientationMode> orientations;  // Empty = portrait
+        int concurrency = 4;
+        std::string backend;        // Overrides every cell's category routing (like FAL_BACKEND)
+        std::string sweepId;        // Generated if empty
+    };
+
+    // Styles x categories x orientations, styles outermost
+    std::vector<Cell> expand(const Options& options);
+
+    // Comma-separated command-line lists. Styles take style keys, category keys
+    // (every style of that category) or "all"; categories take category keys or
+    // "all"; orientations take portrait, landscape or both. False on an unknown entry.
+    bool parseStyles(const std::string& list, std::vector<StyleMode>& styles, std::string& error);
+    bool parseCategories(const std::string& list, std::vector<APIModel>& categories, std::string& error);
+    bool parseOrientations(const std::string& list, std::vector<OrientationMode>& orientations, std::string& error);
+
+    // "sweep_2025-08-03_16-23-05"
+    std::string makeSweepId();
+
+    // saved/<orientation>/<sweep id>_<nnn>_<style>_<category>.jpg
+    std::string outputFile(const std::string& sweepId, size_t index, const Cell& cell);
+
+    // Gallery entry for a finished cell
+    SavedImage galleryEntry(const std::string& sweepId, const std::string& prompt, const Cell& cell,
+        const std::string& file);
+
+    // Completed count and time left, estimated from the latency each backend has
+    // shown so far in this sweep. Until a backend's first cell finishes its prior
+    // is used (BackendOps::typicalMs, or what the poll scheduler has learned).
+    // Not thread-safe; callers serialize access.
+    class Progress {
+    public:
+        Progress(const std::vector<BackendId>& cellBackends, size_t concurrency);
+
+        void setPrior(BackendId backend, double ms);
+        void loadPriors(const PollScheduler& scheduler);
+        void recordFinished(BackendId backend, double totalMs, bool success);
+
+        size_t getTotal() const { return total; }
+        size_t getFinished() const { return finished; }
+        size_t getFailed() const { return failed; }
+        bool isDone() const { return finished >= total; }
+
+        // Expected time until the last cell finishes, and the same as "2m 10s"
+        double etaMs() const;
+        std::string etaText() const;
+
+        // "12/48 done, 1 failed, about 2m 10s left"
+        std::string describe() const;
+
+    private:
+        struct BackendProgress {
+            size_t remaining = 0;
+            size_t samples = 0;
+            double totalMs = 0;
+            double priorMs = 0;
+        };
+
+        std::map<BackendId, BackendProgress> backends;
+        size_t total;
+        size_t finished;
+        size_t failed;
+        size_t concurrency;
+    };
+
+    // Generates every cell with at most `concurrency` jobs in flight and adds each
+    // image to the gallery as it lands. Returns 0 if every cell produced an image.
+    int run(const Options& options);
+}
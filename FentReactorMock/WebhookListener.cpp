@@ -0,0 +1,127 @@
+#include "WebhookListener.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+
+namespace {
+    // 128 random bits as hex
+    std::string makeToken() {
+        std::random_device device;
+        std::ostringstream out;
+        for (int i = 0; i < 4; i++) {
+            out << std::hex << std::setw(8) << std::setfill('0') << static_cast<uint32_t>(device());
+        }
+        return out.str();
+    }
+
+    // Compares without stopping at the first difference
+    bool tokensMatch(const std::string& given, const std::string& expected) {
+        if (given.size() != expected.size()) {
+            return false;
+        }
+        unsigned char diff = 0;
+        for (size_t i = 0; i < given.size(); i++) {
+            diff |= static_cast<unsigned char>(given[i] ^ expected[i]);
+        }
+        return diff == 0;
+    }
+}
+
+WebhookListener::WebhookListener(GenerationEngine& generationEngine) :
+    engine(generationEngine),
+    server([this](const HttpServerRequest& request) { return handleRequest(request); }),
+    received(0),
+    rejected(0) {
+}
+
+WebhookListener::~WebhookListener() {
+    stop();
+}
+
+bool WebhookListener::start(unsigned short port, const std::string& url, double fallbackMs,
+    const std::string& bindAddress) {
+    std::optional<sf::IpAddress> address = sf::IpAddress::resolve(bindAddress);
+    if (!address) {
+        std::cout << "Webhook listener: cannot bind to " << bindAddress << std::endl;
+        return false;
+    }
+    if (!server.start(port, *address)) {
+        return false;
+    }
+
+    token = makeToken();
+    std::string base = url.empty() ? "http://127.0.0.1:" + std::to_string(server.getPort()) + PATH : url;
+    publicUrl = base + (base.find('?') == std::string::npos ? "?" : "&") + "token=" + token;
+    engine.setWebhookMode(publicUrl, fallbackMs);
+
+    std::cout << "Webhook mode: fal.ai will call " << base << " (listening on " << bindAddress << ":" << server.getPort()
+        << ", polling fallback after " << static_cast<int>(fallbackMs) << " ms)" << std::endl;
+    return true;
+}
+
+void WebhookListener::stop() {
+    if (!publicUrl.empty()) {
+        engine.setWebhookMode("", 0);
+        publicUrl.clear();
+    }
+    server.stop();
+}
+
+HttpServerResponse WebhookListener::handleRequest(const HttpServerRequest& request) {
+    if (request.path != PATH) {
+        return HttpServerResponse::text(404, "Not Found");
+    }
+    if (request.method != "POST") {
+        return HttpServerResponse::text(405, "Method Not Allowed");
+    }
+    if (!tokensMatch(request.queryParam("token"), token)) {
+        rejected++;
+        return HttpServerResponse::text(401, "Unauthorized");
+    }
+
+    FalApi::WebhookEvent event;
+    if (!FalApi::parseWebhook(request.body, event)) {
+        rejected++;
+        return HttpServerResponse::text(400, "Bad Request");
+    }
+
+    received++;
+    engine.deliverWebhook(event);
+    return HttpServerResponse::json(200, "{\"ok\":true}");
+}
+
+std::unique_ptr<WebhookListener> WebhookListener::startFromEnvironment(GenerationEngine& generationEngine) {
+    const char* portValue = std::getenv("FAL_WEBHOOK_PORT");
+    if (!portValue) {
+        return nullptr;
+    }
+
+    const char* urlValue = std::getenv("FAL_WEBHOOK_URL");
+    const char* bindValue = std::getenv("FAL_WEBHOOK_BIND");
+    const char* fallbackValue = std::getenv("FAL_WEBHOOK_FALLBACK_MS");
+
+    // A loopback URL would leave every job waiting out the fallback before its first poll
+    if (!urlValue && !FalApi::isLocalQueue()) {
+        std::cout << "FAL_WEBHOOK_PORT is set without FAL_WEBHOOK_URL; fal.ai cannot reach this machine's "
+            "loopback address, using polling" << std::endl;
+        return nullptr;
+    }
+
+    int port = std::atoi(portValue);
+    double fallbackMs = fallbackValue ? std::atof(fallbackValue) : DEFAULT_FALLBACK_MS;
+    if (port < 0 || port > 65535 || fallbackMs <= 0) {
+        std::cout << "Invalid webhook settings, using polling" << std::endl;
+        return nullptr;
+    }
+
+    auto listener = std::make_unique<WebhookListener>(generationEngine);
+    if (!listener->start(static_cast<unsigned short>(port), urlValue ? urlValue : "", fallbackMs,
+        bindValue ? bindValue : "127.0.0.1")) {
+        std::cout << "Webhook listener failed to start, using polling" << std::endl;
+        return nullptr;
+    }
+    return listener;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "GenerationEngine.h"
+#include "HttpServer.h"
+
+// Receives fal.ai webhook callbacks (POST /fal-webhook) and hands them to the
+// generation engine, which then skips status polling for those jobs.
+//
+// A callback completes a job with whatever image URL it names, so only fal may
+// send them: the URL handed to fal carries a random per-run token, and any call
+// without it is answered 401. The listener binds to loopback unless told otherwise.
+class WebhookListener {
+private:
+    GenerationEngine& engine;
+    HttpServer server;
+    std::string publicUrl;
+    std::string token;
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> rejected;
+
+    HttpServerResponse handleRequest(const HttpServerRequest& request);
+
+public:
+    static constexpr const char* PATH = "/fal-webhook";
+    static constexpr double DEFAULT_FALLBACK_MS = 30000.0;
+
+    explicit WebhookListener(GenerationEngine& generationEngine);
+    ~WebhookListener();
+
+    // Starts listening on bindAddress and switches the engine to webhook mode. url
+    // is the address fal.ai should call; empty means http://127.0.0.1:<port>/fal-webhook,
+    // which only a queue on this machine can reach. The token is appended either way.
+    bool start(unsigned short port, const std::string& url, double fallbackMs = DEFAULT_FALLBACK_MS,
+        const std::string& bindAddress = "127.0.0.1");
+    void stop();
+
+    const std::string& getPublicUrl() const { return publicUrl; }
+    unsigned short getPort() const { return server.getPort(); }
+    uint64_t getReceivedCount() const { return received; }
+    uint64_t getRejectedCount() const { return rejected; }
+
+    // Enabled by FAL_WEBHOOK_PORT together with FAL_WEBHOOK_URL, the address fal.ai
+    // can reach (a tunnel or proxy to this port); without it only a local queue can
+    // call back, so against fal.ai it stays off. FAL_WEBHOOK_BIND picks the interface
+    // (default 127.0.0.1) and FAL_WEBHOOK_FALLBACK_MS the polling fallback.
+    // Returns null when not configured.
+    static std::unique_ptr<WebhookListener> startFromEnvironment(GenerationEngine& generationEngine);
+};
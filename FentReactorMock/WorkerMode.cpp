@@ -0,0 +1,273 @@
+#include "WorkerMode.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include "BatchRunner.h"
+#include "GenerationEngine.h"
+#include "HttpClient.h"
+#include "StyleCatalog.h"
+
+using json = nlohmann::json;
+
+namespace {
+    const char* phaseName(JobPhase phase) {
+        switch (phase) {
+        case JobPhase::PENDING: return "queued";
+        case JobPhase::SUBMITTING: return "submitting";
+        case JobPhase::POLLING: return "running";
+        case JobPhase::DOWNLOADING: return "downloading";
+        case JobPhase::COMPLETED: return "completed";
+        default: return "failed";
+        }
+    }
+
+    // Client ids become file names when a request doesn't give an output path
+    std::string safeFileName(const std::string& text) {
+        std::string name;
+        for (unsigned char c : text) {
+            name += (std::isalnum(c) || c == '-' || c == '_') ? static_cast<char>(c) : '_';
+        }
+        return name.substr(0, 64);
+    }
+
+    class WorkerSession {
+    private:
+        struct ActiveRequest {
+            uint64_t jobId = 0;
+            JobPhase lastPhase = JobPhase::PENDING;
+        };
+
+        const WorkerMode::Options& options;
+        std::ostream& output;
+        GenerationEngine& engine;
+        bool hasPinnedBackend;
+        BackendId pinnedBackend;
+
+        // Guards output, active and stopping
+        std::mutex mutex;
+        std::condition_variable stopCondition;
+        std::unordered_map<std::string, ActiveRequest> active;     // Client id -> job
+        bool stopping;
+        uint64_t unnamedRequests;
+
+        void emitLocked(const json& event) {
+            output << event.dump() << "\n";
+            output.flush();
+        }
+
+    public:
+        WorkerSession(const WorkerMode::Options& workerOptions, std::ostream& out, GenerationEngine& generationEngine,
+            bool pinned, BackendId backend) :
+            options(workerOptions),
+            output(out),
+            engine(generationEngine),
+            hasPinnedBackend(pinned),
+            pinnedBackend(backend),
+            stopping(false),
+            unnamedRequests(0) {
+        }
+
+        void emit(const json& event) {
+            std::lock_guard<std::mutex> lock(mutex);
+            emitLocked(event);
+        }
+
+        void rejectRequest(const std::string& id, const std::string& error) {
+            emit({ {"event", "error"}, {"id", id}, {"error", error} });
+        }
+
+        // Returns false once the client asked to shut down
+        bool handleLine(const std::string& line) {
+            json request;
+            try {
+                request = json::parse(line);
+            }
+            catch (const json::exception& e) {
+                rejectRequest("", std::string("Invalid JSON: ") + e.what());
+                return true;
+            }
+
+            if (!request.is_object()) {
+                rejectRequest("", "Request must be a JSON object");
+                return true;
+            }
+
+            std::string id;
+            std::string command;
+            try {
+                id = request.value("id", "");
+                command = request.value("cmd", "generate");
+            }
+            catch (const json::exception&) {
+                rejectRequest("", "id and cmd must be strings");
+                return true;
+            }
+
+            if (command == "shutdown") {
+                return false;
+            }
+            if (command == "cancel") {
+                cancel(id);
+            }
+            else if (command == "generate") {
+                generate(id, line);
+            }
+            else {
+                rejectRequest(id, "Unknown cmd '" + command + "'");
+            }
+            return true;
+        }
+
+        void generate(std::string id, const std::string& line) {
+            BatchRunner::Row row;
+            row.priority = JobPriority::INTERACTIVE;
+            BatchRunner::parseJsonRow(line, row);
+            if (!row.error.empty()) {
+                rejectRequest(id, row.error);
+                return;
+            }
+
+            GenerationRequest request;
+            request.prompt = row.prompt;
+            request.styleModifier = StyleCatalog::promptModifier(row.style);
+            request.backend = hasPinnedBackend ? pinnedBackend : engine.routeCategory(row.category);
+            request.orientation = row.orientation;
+            request.client = row.client.empty() ? "worker" : row.client;
+            request.priority = row.priority;
+            request.deadlineMs = row.deadlineMs;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (id.empty()) {
+                id = "request-" + std::to_string(++unnamedRequests);
+            }
+            if (active.count(id)) {
+                emitLocked({ {"event", "error"}, {"id", id}, {"error", "A request with this id is still running"} });
+                return;
+            }
+
+            std::string outputFile = row.output.empty()
+                ? (std::filesystem::path(options.outputDir) / (safeFileName(id) + ".jpg")).string() : row.output;
+
+            // Holding the lock across submit keeps the result event behind the accepted one
+            uint64_t jobId = engine.submit(request, outputFile, [this, id](const GenerationResult& result) {
+                json event = {
+                    {"event", "result"},
+                    {"id", id},
+                    {"job", result.jobId},
+                    {"success", result.success},
+                    {"cancelled", result.cancelled},
+                    {"path", result.filename},
+                    {"error", result.error},
+                    {"request_id", result.requestId},
+                    {"image_url", result.imageUrl},
+                    {"polls", result.pollCount},
+                    {"submitted_ms", result.submittedMs},
+                    {"completed_ms", result.completedMs},
+                    {"total_ms", result.totalMs}
+                };
+
+                std::lock_guard<std::mutex> lock(mutex);
+                active.erase(id);
+                emitLocked(event);
+            });
+
+            active[id].jobId = jobId;
+            emitLocked({ {"event", "accepted"}, {"id", id}, {"job", jobId} });
+        }
+
+        void cancel(const std::string& id) {
+            uint64_t jobId = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = active.find(id);
+                if (it == active.end()) {
+                    emitLocked({ {"event", "error"}, {"id", id}, {"error", "No running request with this id"} });
+                    return;
+                }
+                jobId = it->second.jobId;
+            }
+
+            // The result event (cancelled: true) follows from the engine
+            engine.cancel(jobId);
+        }
+
+        // Reports phase changes of running requests until stop()
+        void watchPhases() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping) {
+                for (auto& entry : active) {
+                    JobPhase phase = engine.getJobPhase(entry.second.jobId);
+                    if (phase != entry.second.lastPhase && phase != JobPhase::COMPLETED && phase != JobPhase::FAILED) {
+                        entry.second.lastPhase = phase;
+                        emitLocked({ {"event", "phase"}, {"id", entry.first}, {"phase", phaseName(phase)} });
+                    }
+                }
+                stopCondition.wait_for(lock, std::chrono::milliseconds(50));
+            }
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            stopCondition.notify_all();
+        }
+    };
+}
+
+int WorkerMode::run(const Options& options, std::istream& input, std::ostream& output) {
+    // stdout carries the protocol only; everything the pipeline logs goes to stderr.
+    // Events are written through a stream on the original buffer.
+    std::streambuf* protocolBuffer = output.rdbuf();
+    std::ostream events(protocolBuffer);
+    std::streambuf* previousCout = std::cout.rdbuf(std::cerr.rdbuf());
+
+    bool hasPinnedBackend = false;
+    BackendId pinnedBackend = BackendId::FLUX_SCHNELL;
+    std::string backendName = options.backend;
+    if (!Backends::pinFromEnvironment(backendName, hasPinnedBackend, pinnedBackend)) {
+        events << json({ {"event", "error"}, {"id", ""}, {"error", "Unknown backend " + backendName} }).dump() << std::endl;
+        std::cout.rdbuf(previousCout);
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+
+    HttpClient http;
+    GenerationEngine engine(http, static_cast<size_t>(std::max(1, options.concurrency)));
+    engine.getPollScheduler().setStatsFile("poll_stats.json");
+
+    engine.getResultCache().openFromEnvironment();
+
+    WorkerSession session(options, events, engine, hasPinnedBackend, pinnedBackend);
+    std::thread phaseWatcher(&WorkerSession::watchPhases, &session);
+    session.emit({ {"event", "ready"} });
+
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        if (!session.handleLine(line)) {
+            break;
+        }
+    }
+
+    // Finish what was accepted before exiting, so every request gets its result
+    engine.waitUntilIdle();
+    session.stop();
+    phaseWatcher.join();
+    engine.shutdown();
+
+    session.emit({ {"event", "shutdown"} });
+    std::cout.rdbuf(previousCout);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Long-lived worker for the Python wrapper, selected with --worker in main.cpp.
+// Reads one JSON request per line on stdin and answers with one JSON event per
+// line on stdout, so a single warm process (pooled connections, result cache,
+// poll history) serves any number of generations. Log output goes to stderr.
+//
+// Requests:
+//   {"id": "a1", "prompt": "...", "category": "...", "style": "...", "orientation": "landscape", "output": "path.jpg"}
+//   {"cmd": "cancel", "id": "a1"}
+//   {"cmd": "shutdown"}     (also on end of input; running jobs are finished first)
+// Events:
+//   {"event": "ready"}
+//   {"event": "accepted", "id": "a1", "job": 7}
+//   {"event": "phase", "id": "a1", "phase": "submitting" | "running" | "downloading"}   (sampled; brief phases may be skipped)
+//   {"event": "result", "id": "a1", "success": true, "path": "...", "error": "", "cancelled": false, ...timings}
+//   {"event": "error", "id": "a1", "error": "..."}     (request rejected; no result follows)
+//   {"event": "shutdown"}
+namespace WorkerMode {
+    struct Options {
+        std::string outputDir = "worker_output";   // Where images go when a request names no output
+        int concurrency = 4;
+        std::string backend;                        // Overrides category routing (like FAL_BACKEND)
+    };
+
+    int run(const Options& options, std::istream& input = std::cin, std::ostream& output = std::cout);
+}
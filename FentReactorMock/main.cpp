@@ -2,11 +2,211 @@
 //
 
 #include "ImageGenerator.h"
+#include "Benchmark.h"
+#include "BatchRunner.h"
+#include "SweepRunner.h"
+#include "WorkerMode.h"
+#include "GenerationService.h"
+#include <atomic>
+#include <csignal>
+
+// Value following `flag` on the command line, or fallback
+static std::string flagValue(int argc, char* argv[], const std::string& flag, const std::string& fallback) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (flag == argv[i]) return argv[i + 1];
+    }
+    return fallback;
+}
+
+static bool hasFlag(int argc, char* argv[], const std::string& flag) {
+    for (int i = 1; i < argc; i++) {
+        if (flag == argv[i]) return true;
+    }
+    return false;
+}
+
+static MockFalServer::Options mockOptionsFromArgs(int argc, char* argv[]) {
+    MockFalServer::Options options;
+    options.queueDelayMs = std::atof(flagValue(argc, argv, "--queue-ms", "200").c_str());
+    options.processingMs = std::atof(flagValue(argc, argv, "--processing-ms", "1500").c_str());
+    options.jitter = std::atof(flagValue(argc, argv, "--jitter", "0.2").c_str());
+    options.failureRate = std::atof(flagValue(argc, argv, "--failure-rate", "0").c_str());
+    options.imageBytes = std::strtoull(flagValue(argc, argv, "--image-bytes", "524288").c_str(), nullptr, 10);
+    options.imageDir = flagValue(argc, argv, "--image-dir", "");
+    options.workerThreads = std::strtoull(flagValue(argc, argv, "--workers", "8").c_str(), nullptr, 10);
+    options.perKeyConcurrency = std::strtoull(flagValue(argc, argv, "--key-limit", "0").c_str(), nullptr, 10);
+    options.outageMs = std::atof(flagValue(argc, argv, "--outage-ms", "0").c_str());
+    options.msPerMegapixelStep = std::atof(flagValue(argc, argv, "--ms-per-mp-step", "0").c_str());
+    options.extraImageCost = std::atof(flagValue(argc, argv, "--extra-image-cost", "0.35").c_str());
+    return options;
+}
+
+static std::atomic<bool> stopRequested(false);
+
+static void requestStop(int) {
+    stopRequested = true;
+}
+
+// Shared generation service; runs until interrupted (Ctrl+C / SIGTERM)
+static int runService(int argc, char* argv[]) {
+    HttpClient http;
+    int concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "4").c_str()));
+    GenerationEngine engine(http, static_cast<size_t>(concurrency));
+    engine.getPollScheduler().setStatsFile("poll_stats.json");
+
+    engine.getResultCache().openFromEnvironment();
+
+    GenerationService::Options options;
+    options.maxQueuedJobs = std::strtoull(flagValue(argc, argv, "--queue", "64").c_str(), nullptr, 10);
+    options.maxFinishedJobs = std::strtoull(flagValue(argc, argv, "--keep", "128").c_str(), nullptr, 10);
+    options.backend = flagValue(argc, argv, "--backend", "");
+
+    // Declared after the engine so both stop before it does
+    std::unique_ptr<WebhookListener> webhookListener = WebhookListener::startFromEnvironment(engine);
+    GenerationService service(engine, options);
+    if (!service.start(static_cast<unsigned short>(std::atoi(flagValue(argc, argv, "--port", "8080").c_str())))) {
+        return 1;
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    std::cout << "Stopping generation service" << std::endl;
+    service.stop();
+    engine.shutdown();     // No completions may reach the service after this
+    service.printStats();
+    engine.getPollScheduler().printStats();
+    engine.getResultCache().printStats();
+    FalApi::credentials().printStats();
+    engine.getCircuitBreaker().printStats();
+    engine.getRouter().printStats();
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
+    // Headless benchmark modes - handled before the window is created
+    if (argc >= 3 && std::string(argv[1]) == "--bench-http") {
+        int requests = (argc >= 4) ? std::atoi(argv[3]) : 50;
+        bool insecure = (argc >= 5 && std::string(argv[4]) == "--insecure");
+        return Benchmark::runHttpBenchmark(argv[2], requests > 0 ? requests : 50, insecure);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--bench-status") {
+        int iterations = std::atoi(flagValue(argc, argv, "--iterations", "20000").c_str());
+        return Benchmark::runStatusParseBenchmark(iterations > 0 ? iterations : 20000);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--bench-payload") {
+        int prompts = std::atoi(flagValue(argc, argv, "--prompts", "10000").c_str());
+        return Benchmark::runPayloadBenchmark(prompts > 0 ? prompts : 10000);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--bench-scheduler") {
+        int jobs = std::atoi(flagValue(argc, argv, "--jobs", "5000").c_str());
+        return Benchmark::runSchedulerSimulation(jobs > 0 ? jobs : 5000);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--bench-draft") {
+        Benchmark::DraftBenchOptions options;
+        options.jobs = std::max(1, std::atoi(flagValue(argc, argv, "--jobs", "20").c_str()));
+        options.concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "8").c_str()));
+        options.rejectRate = std::clamp(std::atof(flagValue(argc, argv, "--reject", "0.3").c_str()), 0.0, 1.0);
+        std::string backend = flagValue(argc, argv, "--backend", "flux-lora");
+        if (!Backends::fromName(backend, options.backend)) {
+            std::cout << "Unknown backend: " << backend << std::endl;
+            return 1;
+        }
+        options.mock = mockOptionsFromArgs(argc, argv);
+        return Benchmark::runDraftBenchmark(options);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--bench-candidates") {
+        Benchmark::CandidateBenchOptions options;
+        options.prompts = std::max(1, std::atoi(flagValue(argc, argv, "--prompts", "10").c_str()));
+        options.candidates = std::max(1, std::atoi(flagValue(argc, argv, "--candidates", "4").c_str()));
+        options.concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "8").c_str()));
+        std::string backend = flagValue(argc, argv, "--backend", "flux-lora");
+        if (!Backends::fromName(backend, options.backend)) {
+            std::cout << "Unknown backend: " << backend << std::endl;
+            return 1;
+        }
+        options.mock = mockOptionsFromArgs(argc, argv);
+        return Benchmark::runCandidateBenchmark(options);
+    }
+
+    // Local fal queue stand-in (no network or API credit needed)
+    if (argc >= 2 && std::string(argv[1]) == "--mock-fal") {
+        int port = std::atoi(flagValue(argc, argv, "--port", "8787").c_str());
+        return Benchmark::runMockServer(static_cast<unsigned short>(port), mockOptionsFromArgs(argc, argv));
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--load-test") {
+        Benchmark::LoadTestOptions options;
+        options.jobs = std::max(1, std::atoi(flagValue(argc, argv, "--jobs", "100").c_str()));
+        options.concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "8").c_str()));
+        options.blockingClient = hasFlag(argc, argv, "--blocking");
+        options.pollIntervalMs = std::max(1, std::atoi(flagValue(argc, argv, "--poll-ms", "2000").c_str()));
+        options.webhooks = hasFlag(argc, argv, "--webhooks");
+        options.service = hasFlag(argc, argv, "--service");
+        options.serviceClients = std::max(1, std::atoi(flagValue(argc, argv, "--clients", "16").c_str()));
+        options.queueUrl = flagValue(argc, argv, "--url", "");
+        options.keys = flagValue(argc, argv, "--keys", "");
+        options.deadlineMs = std::max(0.0, std::atof(flagValue(argc, argv, "--deadline-ms", "0").c_str()));
+        options.mock = mockOptionsFromArgs(argc, argv);
+        return Benchmark::runLoadTest(options);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--serve") {
+        return runService(argc, argv);
+    }
+
+    // Headless generation from a manifest (overnight catalogs)
+    if (argc >= 3 && std::string(argv[1]) == "--batch") {
+        BatchRunner::Options options;
+        options.manifestPath = argv[2];
+        options.outputDir = flagValue(argc, argv, "--out", "batch");
+        options.resultsPath = flagValue(argc, argv, "--results", "");
+        options.concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "4").c_str()));
+        options.backend = flagValue(argc, argv, "--backend", "");
+        return BatchRunner::run(options);
+    }
+
+    // One prompt across every style x category x orientation combination, into the gallery
+    if (argc >= 3 && std::string(argv[1]) == "--sweep") {
+        SweepRunner::Options options;
+        options.prompt = argv[2];
+        options.concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "4").c_str()));
+        options.backend = flagValue(argc, argv, "--backend", "");
+        std::string error;
+        if (!SweepRunner::parseStyles(flagValue(argc, argv, "--styles", ""), options.styles, error) ||
+            !SweepRunner::parseCategories(flagValue(argc, argv, "--categories", ""), options.categories, error) ||
+            !SweepRunner::parseOrientations(flagValue(argc, argv, "--orientations", "portrait"), options.orientations, error)) {
+            std::cout << "Sweep: " << error << " (see --list-styles)" << std::endl;
+            return 1;
+        }
+        return SweepRunner::run(options);
+    }
+
+    // Long-lived NDJSON worker for the Python wrapper (see WorkerMode.h)
+    if (argc >= 2 && std::string(argv[1]) == "--worker") {
+        WorkerMode::Options options;
+        options.outputDir = flagValue(argc, argv, "--out", "worker_output");
+        options.concurrency = std::max(1, std::atoi(flagValue(argc, argv, "--concurrency", "4").c_str()));
+        options.backend = flagValue(argc, argv, "--backend", "");
+        return WorkerMode::run(options);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "--list-styles") {
+        BatchRunner::printStyles();
+        return 0;
+    }
+
     ImageGenerator app;
 
-    // Check for command line arguments (for Python wrapper)
+    // One-shot command-line generation (older Python wrapper; --worker serves many requests per process)
     if (argc >= 3) {
         std::string prompt = argv[1];
         std::string style = argv[2];
@@ -18,7 +218,29 @@ int main(int argc, char* argv[]) {
         // Run in GUI mode
         std::cout << "Running in GUI mode" << std::endl;
         std::cout << "Usage for command-line: ./image_generator \"<prompt>\" \"<style>\"" << std::endl;
-        std::cout << "Styles: photorealistic, artistic, cartoon, abstract, vintage" << std::endl;
+        std::cout << "Styles: ./image_generator --list-styles" << std::endl;
+        std::cout << "Worker (NDJSON on stdin/stdout): ./image_generator --worker [--out worker_output] [--concurrency 4]"
+            " [--backend name]" << std::endl;
+        std::cout << "Batch: ./image_generator --batch <manifest.jsonl|csv> [--out batch] [--results file]"
+            " [--concurrency 4] [--backend name]" << std::endl;
+        std::cout << "Sweep: ./image_generator --sweep \"<prompt>\" [--styles all|<category>|<style>,...]"
+            " [--categories <category>,...] [--orientations portrait,landscape|both] [--concurrency 4] [--backend name]" << std::endl;
+        std::cout << "Benchmark: ./image_generator --bench-http <url> [requests] [--insecure]" << std::endl;
+        std::cout << "Status decode benchmark: ./image_generator --bench-status [--iterations 20000]" << std::endl;
+        std::cout << "Payload build benchmark: ./image_generator --bench-payload [--prompts 10000]" << std::endl;
+        std::cout << "Scheduler simulation: ./image_generator --bench-scheduler [--jobs 5000]" << std::endl;
+        std::cout << "Draft benchmark: ./image_generator --bench-draft [--jobs 20] [--concurrency 8] [--backend flux-lora]"
+            " [--reject 0.3] [mock options]" << std::endl;
+        std::cout << "Candidate benchmark: ./image_generator --bench-candidates [--prompts 10] [--candidates 4]"
+            " [--concurrency 8] [--backend flux-lora] [mock options]" << std::endl;
+        std::cout << "Mock queue: ./image_generator --mock-fal [--port 8787] [--queue-ms 200] [--processing-ms 1500]"
+            " [--jitter 0.2] [--failure-rate 0] [--image-bytes 524288] [--image-dir dir] [--workers 8] [--key-limit 0]"
+            " [--outage-ms 0] [--ms-per-mp-step 0] [--extra-image-cost 0.35]" << std::endl;
+        std::cout << "Load test: ./image_generator --load-test [--jobs 100] [--concurrency 8] [--blocking [--poll-ms 2000]]"
+            " [--webhooks | --service [--clients 16]] [--url queue-url] [--keys k1@4,k2@4] [--deadline-ms 0]"
+            " [mock options]" << std::endl;
+        std::cout << "Service: ./image_generator --serve [--port 8080] [--concurrency 4] [--queue 64] [--keep 128]"
+            " [--backend name]" << std::endl;
         app.run();
     }
 